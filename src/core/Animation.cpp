@@ -0,0 +1,453 @@
+#include "Animation.h"
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANIMATION_SSE 1
+#include <emmintrin.h>
+#endif
+
+static const float kSampleRate = 30.0f;
+// Error maximo por componente de las rotaciones (cuaternion) y escalas
+static const float kRotationTolerance = 0.0005f;
+static const float kScaleTolerance = 0.0005f;
+
+// Vector de 4 floats: SSE si esta disponible, escalar si no
+#if ANIMATION_SSE
+typedef __m128 F4;
+static inline F4 Load4(const float* p) { return _mm_loadu_ps(p); }
+static inline void Store4(float* p, F4 v) { _mm_storeu_ps(p, v); }
+static inline F4 Splat(float x) { return _mm_set1_ps(x); }
+static inline F4 Add(F4 a, F4 b) { return _mm_add_ps(a, b); }
+static inline F4 Sub(F4 a, F4 b) { return _mm_sub_ps(a, b); }
+static inline F4 Mul(F4 a, F4 b) { return _mm_mul_ps(a, b); }
+static inline float Dot(F4 a, F4 b) {
+    F4 m = _mm_mul_ps(a, b);
+    F4 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    s = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(s);
+}
+// 4 valores de 16 bits sin signo -> floats, con el rango de la pista
+static inline F4 DecodeKey(const uint16_t* q, const ClipTrack& track) {
+    __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q));
+    F4 v = _mm_cvtepi32_ps(_mm_unpacklo_epi16(raw, _mm_setzero_si128()));
+    return _mm_add_ps(_mm_loadu_ps(track.rangeMin), _mm_mul_ps(v, _mm_loadu_ps(track.rangeScale)));
+}
+#else
+struct F4 { float v[4]; };
+static inline F4 Load4(const float* p) { F4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+static inline void Store4(float* p, F4 a) { std::memcpy(p, a.v, sizeof(a.v)); }
+static inline F4 Splat(float x) { F4 r = { { x, x, x, x } }; return r; }
+static inline F4 Add(F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline F4 Sub(F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+static inline F4 Mul(F4 a, F4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+static inline float Dot(F4 a, F4 b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]; }
+static inline F4 DecodeKey(const uint16_t* q, const ClipTrack& track) {
+    F4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = track.rangeMin[i] + q[i] * track.rangeScale[i];
+    return r;
+}
+#endif
+
+static inline F4 Lerp(F4 a, F4 b, float t) { return Add(a, Mul(Sub(b, a), Splat(t))); }
+
+// o = a * b, column-major (o puede ser a o b)
+static void MulMat4(float o[16], const float a[16], const float b[16]) {
+    F4 c0 = Load4(a), c1 = Load4(a + 4), c2 = Load4(a + 8), c3 = Load4(a + 12);
+    F4 r[4];
+    for (int j = 0; j < 4; ++j) {
+        r[j] = Add(Add(Mul(c0, Splat(b[j * 4 + 0])), Mul(c1, Splat(b[j * 4 + 1]))),
+            Add(Mul(c2, Splat(b[j * 4 + 2])), Mul(c3, Splat(b[j * 4 + 3]))));
+    }
+    for (int j = 0; j < 4; ++j) Store4(o + j * 4, r[j]);
+}
+
+// Traslacion, rotacion (x, y, z, w normalizado) y escala -> matriz column-major
+static void ComposeTRS(float o[16], const float t[4], const float q[4], const float s[4]) {
+    float x = q[0], y = q[1], z = q[2], w = q[3];
+    o[0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+    o[1] = 2.0f * (x * y + w * z) * s[0];
+    o[2] = 2.0f * (x * z - w * y) * s[0];
+    o[3] = 0.0f;
+    o[4] = 2.0f * (x * y - w * z) * s[1];
+    o[5] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+    o[6] = 2.0f * (y * z + w * x) * s[1];
+    o[7] = 0.0f;
+    o[8] = 2.0f * (x * z + w * y) * s[2];
+    o[9] = 2.0f * (y * z - w * x) * s[2];
+    o[10] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+    o[11] = 0.0f;
+    o[12] = t[0];
+    o[13] = t[1];
+    o[14] = t[2];
+    o[15] = 1.0f;
+}
+
+// aiMatrix4x4 es row-major (a1..a4 es la primera fila)
+static void ToColumnMajor(const aiMatrix4x4& m, float o[16]) {
+    const float rows[16] = { m.a1, m.a2, m.a3, m.a4, m.b1, m.b2, m.b3, m.b4,
+        m.c1, m.c2, m.c3, m.c4, m.d1, m.d2, m.d3, m.d4 };
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+            o[c * 4 + r] = rows[r * 4 + c];
+}
+
+size_t AnimationClip::GetSizeBytes() const {
+    return tracks.size() * sizeof(ClipTrack) + keyFrames.size() * sizeof(uint16_t)
+        + keyValues.size() * sizeof(uint16_t);
+}
+
+size_t AnimationClip::GetRawSizeBytes() const {
+    size_t frames = (size_t)std::ceil(duration * sampleRate) + 1;
+    return frames * (tracks.size() / 3) * 10 * sizeof(float);
+}
+
+bool Animation::BuildSkeleton(const aiScene* scene, const float center[3], Skeleton& out) {
+    out.joints.clear();
+    out.names.clear();
+
+    // Hueso por nombre; si varios meshes lo usan, vale el primero
+    std::unordered_map<std::string, const aiBone*> bones;
+    for (unsigned i = 0; i < scene->mNumMeshes; ++i) {
+        const aiMesh* mesh = scene->mMeshes[i];
+        for (unsigned b = 0; b < mesh->mNumBones; ++b) {
+            bones.emplace(mesh->mBones[b]->mName.C_Str(), mesh->mBones[b]);
+        }
+    }
+    if (bones.empty() || !scene->mRootNode) return false;
+
+    // Los nodos de hueso y todos sus ancestros
+    std::unordered_set<const aiNode*> needed;
+    for (const auto& bone : bones) {
+        for (const aiNode* node = scene->mRootNode->FindNode(bone.first.c_str());
+             node && needed.insert(node).second; node = node->mParent) {
+        }
+    }
+
+    // Centrado del modelo: los vertices llegan con el centro restado
+    float recenter[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, center[0], center[1], center[2], 1 };
+
+    // Preorden: cada padre antes que sus hijos
+    std::vector<std::pair<const aiNode*, int>> stack;
+    stack.push_back(std::make_pair((const aiNode*)scene->mRootNode, -1));
+    while (!stack.empty()) {
+        const aiNode* node = stack.back().first;
+        int parent = stack.back().second;
+        stack.pop_back();
+        if (!needed.count(node)) continue;
+
+        SkeletonJoint joint;
+        joint.parent = parent;
+        aiVector3D scaling, position;
+        aiQuaternion rotation;
+        node->mTransformation.Decompose(scaling, rotation, position);
+        joint.bindTranslation[0] = position.x;
+        joint.bindTranslation[1] = position.y;
+        joint.bindTranslation[2] = position.z;
+        joint.bindRotation[0] = rotation.x;
+        joint.bindRotation[1] = rotation.y;
+        joint.bindRotation[2] = rotation.z;
+        joint.bindRotation[3] = rotation.w;
+        joint.bindScale[0] = scaling.x;
+        joint.bindScale[1] = scaling.y;
+        joint.bindScale[2] = scaling.z;
+
+        auto bone = bones.find(node->mName.C_Str());
+        if (bone != bones.end()) {
+            float offset[16];
+            ToColumnMajor(bone->second->mOffsetMatrix, offset);
+            MulMat4(joint.inverseBind, offset, recenter);
+        } else {
+            std::memcpy(joint.inverseBind, recenter, sizeof(recenter));
+        }
+
+        int index = (int)out.joints.size();
+        out.joints.push_back(joint);
+        out.names.push_back(node->mName.C_Str());
+        for (unsigned c = node->mNumChildren; c-- > 0;) {
+            stack.push_back(std::make_pair((const aiNode*)node->mChildren[c], index));
+        }
+    }
+
+    if (out.joints.size() > kMaxJoints) {
+        std::cerr << "Skeleton has " << out.joints.size() << " joints (max " << kMaxJoints
+            << "), loading as static\n";
+        out.joints.clear();
+        out.names.clear();
+        return false;
+    }
+    return !out.joints.empty();
+}
+
+void Animation::BuildSkinData(const aiMesh* mesh, const Skeleton& skeleton, ArenaVector<unsigned char>& out) {
+    const size_t vertexCount = mesh->mNumVertices;
+    out.assign(vertexCount * kSkinStride, 0);
+
+    std::unordered_map<std::string, int> jointIndex;
+    for (size_t j = 0; j < skeleton.names.size(); ++j) {
+        jointIndex.emplace(skeleton.names[j], (int)j);
+    }
+
+    // Las 4 influencias mayores por vertice
+    ArenaVector<float> weights(vertexCount * 4, 0.0f, ArenaAllocator<float>(out.get_allocator()));
+    for (unsigned b = 0; b < mesh->mNumBones; ++b) {
+        const aiBone* bone = mesh->mBones[b];
+        auto it = jointIndex.find(bone->mName.C_Str());
+        if (it == jointIndex.end()) continue;
+        for (unsigned w = 0; w < bone->mNumWeights; ++w) {
+            unsigned v = bone->mWeights[w].mVertexId;
+            float weight = bone->mWeights[w].mWeight;
+            if (v >= vertexCount || weight <= 0.0f) continue;
+            float* slots = &weights[v * 4];
+            int smallest = (int)(std::min_element(slots, slots + 4) - slots);
+            if (weight > slots[smallest]) {
+                slots[smallest] = weight;
+                out[v * kSkinStride + smallest] = (unsigned char)it->second;
+            }
+        }
+    }
+
+    // Pesos a 8 bits que suman exactamente 255
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* slots = &weights[v * 4];
+        unsigned char* dst = &out[v * kSkinStride + 4];
+        float sum = slots[0] + slots[1] + slots[2] + slots[3];
+        if (sum <= 0.0f) {
+            // Sin pesos: sigue a la raiz
+            dst[0] = 255;
+            continue;
+        }
+        int total = 0, largest = 0;
+        for (int k = 0; k < 4; ++k) {
+            dst[k] = (unsigned char)std::lround(slots[k] / sum * 255.0f);
+            total += dst[k];
+            if (slots[k] > slots[largest]) largest = k;
+        }
+        dst[largest] = (unsigned char)(dst[largest] + (255 - total));
+    }
+}
+
+// Valor de un canal de Assimp en 'ticks' (4 floats; w = 0 en T y S)
+static void SampleVectorKeys(const aiVectorKey* keys, unsigned count, double ticks, float out[4]) {
+    unsigned k = 0;
+    while (k + 1 < count && keys[k + 1].mTime <= ticks) ++k;
+    aiVector3D a = keys[k].mValue, b = keys[std::min(k + 1, count - 1)].mValue;
+    double span = keys[std::min(k + 1, count - 1)].mTime - keys[k].mTime;
+    float t = span > 0.0 ? (float)std::min(1.0, std::max(0.0, (ticks - keys[k].mTime) / span)) : 0.0f;
+    out[0] = a.x + (b.x - a.x) * t;
+    out[1] = a.y + (b.y - a.y) * t;
+    out[2] = a.z + (b.z - a.z) * t;
+    out[3] = 0.0f;
+}
+
+static void SampleQuatKeys(const aiQuatKey* keys, unsigned count, double ticks, float out[4]) {
+    unsigned k = 0;
+    while (k + 1 < count && keys[k + 1].mTime <= ticks) ++k;
+    const aiQuaternion& a = keys[k].mValue;
+    const aiQuaternion& b = keys[std::min(k + 1, count - 1)].mValue;
+    double span = keys[std::min(k + 1, count - 1)].mTime - keys[k].mTime;
+    float t = span > 0.0 ? (float)std::min(1.0, std::max(0.0, (ticks - keys[k].mTime) / span)) : 0.0f;
+    // nlerp por el camino corto
+    float sign = (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w) < 0.0f ? -1.0f : 1.0f;
+    float q[4] = {
+        a.x + (sign * b.x - a.x) * t, a.y + (sign * b.y - a.y) * t,
+        a.z + (sign * b.z - a.z) * t, a.w + (sign * b.w - a.w) * t };
+    float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int i = 0; i < 4; ++i) out[i] = len > 0.0f ? q[i] / len : (i == 3 ? 1.0f : 0.0f);
+}
+
+static void Normalize4(float q[4]) {
+    float len = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (len > 0.0f) for (int i = 0; i < 4; ++i) q[i] /= len;
+}
+
+// Reduccion de curvas: claves minimas tales que interpolar entre ellas no se
+// aleja de ninguna muestra mas de 'tolerance' por componente
+static void ReduceCurve(const std::vector<float>& samples, size_t frameCount, bool rotation, float tolerance,
+    std::vector<uint32_t>& keys) {
+    keys.clear();
+    keys.push_back(0);
+    size_t start = 0;
+    for (size_t end = 2; end < frameCount; ++end) {
+        bool fits = true;
+        for (size_t i = start + 1; i < end && fits; ++i) {
+            float t = (float)(i - start) / (float)(end - start);
+            float v[4];
+            for (int k = 0; k < 4; ++k) {
+                v[k] = samples[start * 4 + k] + (samples[end * 4 + k] - samples[start * 4 + k]) * t;
+            }
+            if (rotation) Normalize4(v);
+            for (int k = 0; k < 4; ++k) {
+                if (std::fabs(v[k] - samples[i * 4 + k]) > tolerance) fits = false;
+            }
+        }
+        if (!fits) {
+            start = end - 1;
+            keys.push_back((uint32_t)start);
+        }
+    }
+    if (frameCount > 1) keys.push_back((uint32_t)(frameCount - 1));
+
+    // Pista constante: una sola clave
+    if (keys.size() == 2) {
+        bool constant = true;
+        for (size_t i = 1; i < frameCount && constant; ++i) {
+            for (int k = 0; k < 4; ++k) {
+                if (std::fabs(samples[i * 4 + k] - samples[k]) > tolerance) constant = false;
+            }
+        }
+        if (constant) keys.resize(1);
+    }
+}
+
+void Animation::CompressClips(const aiScene* scene, const Skeleton& skeleton, float translationTolerance,
+    std::vector<AnimationClip>& out) {
+    out.clear();
+    const size_t jointCount = skeleton.joints.size();
+    if (jointCount == 0) return;
+
+    std::vector<float> samples;
+    std::vector<uint32_t> keys;
+
+    for (unsigned a = 0; a < scene->mNumAnimations; ++a) {
+        const aiAnimation* anim = scene->mAnimations[a];
+        double ticksPerSecond = anim->mTicksPerSecond > 0.0 ? anim->mTicksPerSecond : 25.0;
+        if (anim->mDuration <= 0.0) continue;
+
+        AnimationClip clip;
+        clip.name = anim->mName.C_Str();
+        clip.duration = (float)(anim->mDuration / ticksPerSecond);
+        clip.sampleRate = kSampleRate;
+        size_t frameCount = std::min<size_t>(65535, (size_t)std::ceil(clip.duration * clip.sampleRate) + 1);
+        frameCount = std::max<size_t>(frameCount, 2);
+
+        std::unordered_map<std::string, const aiNodeAnim*> channels;
+        for (unsigned c = 0; c < anim->mNumChannels; ++c) {
+            channels.emplace(anim->mChannels[c]->mNodeName.C_Str(), anim->mChannels[c]);
+        }
+
+        clip.tracks.resize(jointCount * 3);
+        samples.resize(frameCount * 4);
+        for (size_t j = 0; j < jointCount; ++j) {
+            const SkeletonJoint& joint = skeleton.joints[j];
+            auto found = channels.find(skeleton.names[j]);
+            const aiNodeAnim* channel = found != channels.end() ? found->second : nullptr;
+
+            for (int kind = 0; kind < 3; ++kind) {
+                // Muestreo uniforme; sin canal, el valor de reposo
+                for (size_t f = 0; f < frameCount; ++f) {
+                    double ticks = std::min(anim->mDuration, f / (double)clip.sampleRate * ticksPerSecond);
+                    float* v = &samples[f * 4];
+                    if (kind == 0) {
+                        if (channel && channel->mNumPositionKeys > 0) {
+                            SampleVectorKeys(channel->mPositionKeys, channel->mNumPositionKeys, ticks, v);
+                        } else {
+                            v[0] = joint.bindTranslation[0]; v[1] = joint.bindTranslation[1];
+                            v[2] = joint.bindTranslation[2]; v[3] = 0.0f;
+                        }
+                    } else if (kind == 1) {
+                        if (channel && channel->mNumRotationKeys > 0) {
+                            SampleQuatKeys(channel->mRotationKeys, channel->mNumRotationKeys, ticks, v);
+                        } else {
+                            std::memcpy(v, joint.bindRotation, sizeof(joint.bindRotation));
+                        }
+                        // Mismo hemisferio que la muestra anterior: se interpola sin saltos
+                        if (f > 0 && v[0] * v[-4] + v[1] * v[-3] + v[2] * v[-2] + v[3] * v[-1] < 0.0f) {
+                            for (int k = 0; k < 4; ++k) v[k] = -v[k];
+                        }
+                    } else {
+                        if (channel && channel->mNumScalingKeys > 0) {
+                            SampleVectorKeys(channel->mScalingKeys, channel->mNumScalingKeys, ticks, v);
+                        } else {
+                            v[0] = joint.bindScale[0]; v[1] = joint.bindScale[1];
+                            v[2] = joint.bindScale[2]; v[3] = 0.0f;
+                        }
+                    }
+                }
+
+                float tolerance = kind == 0 ? translationTolerance : (kind == 1 ? kRotationTolerance : kScaleTolerance);
+                ReduceCurve(samples, frameCount, kind == 1, tolerance, keys);
+
+                // Rango de la pista y cuantizacion a 16 bits
+                ClipTrack& track = clip.tracks[j * 3 + kind];
+                track.firstKey = (uint32_t)clip.keyFrames.size();
+                track.keyCount = (uint32_t)keys.size();
+                for (int k = 0; k < 4; ++k) {
+                    float lo = samples[keys[0] * 4 + k], hi = lo;
+                    for (uint32_t key : keys) {
+                        lo = std::min(lo, samples[key * 4 + k]);
+                        hi = std::max(hi, samples[key * 4 + k]);
+                    }
+                    track.rangeMin[k] = lo;
+                    track.rangeScale[k] = (hi - lo) / 65535.0f;
+                }
+                for (uint32_t key : keys) {
+                    clip.keyFrames.push_back((uint16_t)key);
+                    for (int k = 0; k < 4; ++k) {
+                        float q = track.rangeScale[k] > 0.0f ? (samples[key * 4 + k] - track.rangeMin[k]) / track.rangeScale[k] : 0.0f;
+                        clip.keyValues.push_back((uint16_t)std::lround(std::min(65535.0f, std::max(0.0f, q))));
+                    }
+                }
+            }
+        }
+        out.push_back(std::move(clip));
+    }
+}
+
+// Valor de una pista en 'frame' (fraccionario)
+static F4 SampleTrack(const AnimationClip& clip, const ClipTrack& track, float frame) {
+    const uint16_t* frames = &clip.keyFrames[track.firstKey];
+    const uint16_t* values = &clip.keyValues[(size_t)track.firstKey * 4];
+    if (track.keyCount == 1) return DecodeKey(values, track);
+
+    // Ultima clave con frame <= 'frame'
+    const uint16_t* next = std::upper_bound(frames + 1, frames + track.keyCount - 1, frame,
+        [](float f, uint16_t key) { return f < (float)key; });
+    size_t k = (size_t)(next - frames) - 1;
+    float span = (float)(frames[k + 1] - frames[k]);
+    float t = span > 0.0f ? std::min(1.0f, std::max(0.0f, (frame - frames[k]) / span)) : 0.0f;
+    return Lerp(DecodeKey(values + k * 4, track), DecodeKey(values + (k + 1) * 4, track), t);
+}
+
+void Animation::SamplePalette(const Skeleton& skeleton, const AnimationClip& clip, float time,
+    const float world[16], float* outPalette, float* scratch) {
+    const size_t jointCount = skeleton.joints.size();
+    float lastFrame = std::max(0.0f, std::ceil(clip.duration * clip.sampleRate));
+    float local = clip.duration > 0.0f ? std::fmod(time, clip.duration) : 0.0f;
+    if (local < 0.0f) local += clip.duration;
+    float frame = std::min(lastFrame, local * clip.sampleRate);
+
+    // Transformacion global de cada articulacion (padres primero)
+    for (size_t j = 0; j < jointCount; ++j) {
+        float t[4], r[4], s[4];
+        Store4(t, SampleTrack(clip, clip.tracks[j * 3 + 0], frame));
+        F4 q = SampleTrack(clip, clip.tracks[j * 3 + 1], frame);
+        float len2 = Dot(q, q);
+        Store4(r, Mul(q, Splat(len2 > 0.0f ? 1.0f / std::sqrt(len2) : 0.0f)));
+        Store4(s, SampleTrack(clip, clip.tracks[j * 3 + 2], frame));
+
+        float* global = scratch + j * 16;
+        ComposeTRS(global, t, r, s);
+        int parent = skeleton.joints[j].parent;
+        MulMat4(global, parent >= 0 ? scratch + parent * 16 : world, global);
+    }
+
+    // Paleta = global * inversa del bind, por filas (3x4)
+    for (size_t j = 0; j < jointCount; ++j) {
+        float m[16];
+        MulMat4(m, scratch + j * 16, skeleton.joints[j].inverseBind);
+        float* dst = outPalette + j * kPaletteFloats;
+        for (int row = 0; row < 3; ++row) {
+            dst[row * 4 + 0] = m[row];
+            dst[row * 4 + 1] = m[4 + row];
+            dst[row * 4 + 2] = m[8 + row];
+            dst[row * 4 + 3] = m[12 + row];
+        }
+    }
+}
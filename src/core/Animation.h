@@ -0,0 +1,75 @@
+#pragma once
+#include "MemoryArena.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct aiScene;
+struct aiMesh;
+
+// Articulacion del esqueleto; el vector va en orden padres-primero
+struct SkeletonJoint {
+    int32_t parent = -1;
+    float bindTranslation[3] = { 0.0f, 0.0f, 0.0f };
+    float bindRotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };    // x, y, z, w
+    float bindScale[3] = { 1.0f, 1.0f, 1.0f };
+    // Column-major, ya con el centrado del modelo (identidad si no es hueso)
+    float inverseBind[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+};
+
+struct Skeleton {
+    std::vector<SkeletonJoint> joints;
+    std::vector<std::string> names;
+};
+
+// Una pista (T, R o S) de una articulacion: solo las claves que la reduccion
+// de curvas no puede interpolar. Valor = rangeMin + q * rangeScale, con q de
+// 16 bits por componente.
+struct ClipTrack {
+    uint32_t firstKey = 0;
+    uint32_t keyCount = 0;
+    float rangeMin[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float rangeScale[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+
+// Clip comprimido: tres pistas por articulacion (T, R, S), muestreado a
+// sampleRate; las claves guardan el indice de muestra en 16 bits.
+struct AnimationClip {
+    std::string name;
+    float duration = 0.0f;              // segundos
+    float sampleRate = 30.0f;
+    std::vector<ClipTrack> tracks;      // jointCount * 3
+    std::vector<uint16_t> keyFrames;
+    std::vector<uint16_t> keyValues;    // 4 por clave
+
+    size_t GetSizeBytes() const;
+    // Lo que ocuparia muestreado sin comprimir (10 floats por articulacion y muestra)
+    size_t GetRawSizeBytes() const;
+};
+
+// Esqueletos, pesos y clips desde Assimp; y muestreo de poses (SSE si hay).
+// Sin GL: lo usa tambien la herramienta de cocinado.
+class Animation {
+public:
+    // Indices de 8 bits en el vertice
+    static const size_t kMaxJoints = 256;
+    // Bytes de skin por vertice: 4 indices + 4 pesos normalizados
+    static const int kSkinStride = 8;
+    // Floats por articulacion en la paleta (matriz 3x4 por filas)
+    static const int kPaletteFloats = 12;
+
+    // Nodos que son hueso de algun mesh y sus ancestros. false si no hay huesos
+    // o hay demasiados
+    static bool BuildSkeleton(const aiScene* scene, const float center[3], Skeleton& out);
+    // Las 4 influencias mayores de cada vertice, con los pesos renormalizados
+    static void BuildSkinData(const aiMesh* mesh, const Skeleton& skeleton, ArenaVector<unsigned char>& out);
+    // Remuestrea, reduce (tolerancia de traslacion en unidades de la escena) y cuantiza
+    static void CompressClips(const aiScene* scene, const Skeleton& skeleton, float translationTolerance,
+        std::vector<AnimationClip>& out);
+
+    // Paleta en el instante 'time' (en bucle): kPaletteFloats por articulacion,
+    // premultiplicada por 'world'. 'scratch' necesita 16 floats por articulacion.
+    static void SamplePalette(const Skeleton& skeleton, const AnimationClip& clip, float time,
+        const float world[16], float* outPalette, float* scratch);
+};
@@ -1,7 +1,20 @@
 #include "Application.h"
 #include "Input.h"
 #include "Time.h"
+#include "JobSystem.h"
+#include "RayPicker.h"
+#include "MemoryTracker.h"
+#include "RenderThread.h"
 #include <iostream>
+#include <algorithm>
+#include <memory>
+
+// Lo que el hilo principal necesita saber de la escena cargada
+struct SceneInfo {
+    bool loaded = false;
+    float center[3] = { 0.0f, 0.0f, 0.0f };
+    float size = 0.0f;
+};
 
 Application::Application() {
     window = new Window("Motorcin Engine", 800, 600);
@@ -24,6 +37,7 @@ void Application::Run() {
         return;
     }
 
+    JobSystem::Init();
     Input::Init();
     Time::Init();
 
@@ -36,20 +50,60 @@ void Application::Run() {
     std::cout << "  - Mouse wheel to zoom\n";
     std::cout << "  - F to focus on model center\n";
     std::cout << "  - TAB to toggle wireframe/textured mode\n";  // NUEVO
+    std::cout << "  - B to benchmark import scaling (1..N workers)\n";
+    std::cout << "  - LEFT click to pick, MIDDLE click to focus on the point under the cursor\n";
+    std::cout << "  - M to print memory usage and budgets\n";
+    std::cout << "  - N to cycle animated instances (1/16/128/512)\n";
+    std::cout << "  - R to toggle dynamic resolution\n";
+    std::cout << "  - I to toggle GL call counters, T to start/stop a GL trace (gltrace.bin)\n";
+    std::cout << "  - V to print detailed renderer stats for the next frame\n";
+    std::cout << "  - J to toggle the render thread\n";
+    std::cout << "  - Z to toggle static batching (reloads the model)\n";
     std::cout << "  - ESC to exit\n\n";
 
+    // GL pasa al hilo de render; el principal graba las listas de comandos
+    RenderThread::Start(window);
+
     int frameCount = 0;
 
     while (!window->ShouldClose()) {
+        // Respuestas del hilo de render a frames anteriores
+        RenderThread::BeginFrame();
+
+        // Esperar a la GPU antes de leer la entrada: el frame no se encola
+        // detras de otro y la entrada llega mas fresca a pantalla. Con hilo
+        // de render la espera es suya y el principal sigue adelante.
+        Uint64 inputTimestamp = pendingInputTimestamp;
+        auto frameDone = std::make_shared<Uint64>(0);
+        RenderThread::Request([frameDone] {
+            Renderer::BeginFrame();
+            *frameDone = SDL_GetTicksNS();
+        }, [this, inputTimestamp, frameDone] {
+            RecordInputLatency(inputTimestamp, *frameDone);
+        });
+
         Time::Update();
         Input::Update();
 
         window->PollEvents();
 
-        if (!modelLoadedLastFrame && Renderer::HasLoadedModel()) {
-            float cx, cy, cz;
-            Renderer::GetModelCenter(cx, cy, cz);
-            float size = Renderer::GetModelSize();
+        // Estado de la escena despues de las cargas encoladas por PollEvents
+        auto scene = std::make_shared<SceneInfo>();
+        RenderThread::Request([scene] {
+            scene->loaded = Renderer::HasLoadedModel();
+            if (scene->loaded) {
+                Renderer::GetModelCenter(scene->center[0], scene->center[1], scene->center[2]);
+                scene->size = Renderer::GetModelSize();
+            }
+        }, [this, scene] {
+            modelLoaded = scene->loaded;
+            std::copy(scene->center, scene->center + 3, modelCenter);
+            modelSize = scene->size;
+        });
+
+        if (!modelLoadedLastFrame && modelLoaded) {
+            float cx = modelCenter[0], cy = modelCenter[1], cz = modelCenter[2];
+            float size = modelSize;
 
             // IMPORTANTE: Informar a la cmara del tamao de la escena
             camera->SetSceneSize(size);
@@ -79,13 +133,12 @@ void Application::Run() {
             std::cout << "Camera position: (" << camX << ", " << camY << ", " << camZ << ")" << std::endl;
             std::cout << "Press F to re-focus anytime\n" << std::endl;
         }
-        modelLoadedLastFrame = Renderer::HasLoadedModel();
+        modelLoadedLastFrame = modelLoaded;
 
         // Tecla F para re-enfocar manualmente
-        if (Input::IsKeyPressed(SDLK_F) && Renderer::HasLoadedModel()) {
-            float cx, cy, cz;
-            Renderer::GetModelCenter(cx, cy, cz);
-            float size = Renderer::GetModelSize();
+        if (Input::IsKeyPressed(SDLK_F) && modelLoaded) {
+            float cx = modelCenter[0], cy = modelCenter[1], cz = modelCenter[2];
+            float size = modelSize;
 
             camera->SetSceneSize(size);
 
@@ -105,17 +158,156 @@ void Application::Run() {
 
         // NUEVO: Tecla TAB para toggle wireframe
         if (Input::IsKeyPressed(SDLK_TAB)) {
-            Renderer::ToggleWireframe();
+            RenderThread::Enqueue([] { Renderer::ToggleWireframe(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_B)) {
+            RenderThread::Enqueue([] { Renderer::RunImportBenchmark(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_C)) {
+            RenderThread::Enqueue([] { Renderer::ToggleClusterCulling(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_O)) {
+            RenderThread::Enqueue([] { Renderer::ToggleOcclusionCulling(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_G)) {
+            RenderThread::Enqueue([] { Renderer::ToggleOcclusionQueries(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_P)) {
+            RenderThread::Enqueue([] { Renderer::ToggleDepthPrepass(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_H)) {
+            RenderThread::Enqueue([] { Renderer::ToggleOverdrawHeatmap(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_L)) {
+            RenderThread::Enqueue([] { Renderer::AddDebugLights(1024); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_K)) {
+            RenderThread::Enqueue([] { Renderer::ToggleShadows(); });
         }
 
-        camera->Update(Time::GetDeltaTime());
+        bool toggleRenderThread = Input::IsKeyPressed(SDLK_J);
 
-        Renderer::Clear(0.1f, 0.1f, 0.15f, 1.0f);
-        Renderer::DrawLoadedModel(camera);
+        if (Input::IsKeyPressed(SDLK_M)) {
+            // Consulta la memoria del driver: necesita el contexto
+            RenderThread::Enqueue([] { MemoryTracker::PrintStats(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_N)) {
+            RenderThread::Enqueue([] { Renderer::CycleAnimatedInstances(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_R)) {
+            RenderThread::Enqueue([] { Renderer::ToggleDynamicResolution(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_I)) {
+            RenderThread::Enqueue([] { Renderer::ToggleGLInstrumentation(); });
+        }
 
-        window->SwapBuffers();
+        if (Input::IsKeyPressed(SDLK_T)) {
+            RenderThread::Enqueue([] { Renderer::ToggleGLTrace(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_V)) {
+            RenderThread::Enqueue([] { Renderer::PrintFrameDetails(); });
+        }
+
+        if (Input::IsKeyPressed(SDLK_Z)) {
+            RenderThread::Enqueue([] { Renderer::ToggleStaticBatching(); });
+        }
+
+        // Picking: clic izquierdo informa, clic central enfoca el punto
+        bool pickClick = Input::IsMouseButtonPressed(SDL_BUTTON_LEFT);
+        bool focusClick = Input::IsMouseButtonPressed(SDL_BUTTON_MIDDLE);
+        if ((pickClick || focusClick) && modelLoaded) {
+            int mouseX, mouseY;
+            Input::GetMousePosition(mouseX, mouseY);
+            Camera view = *camera;
+            auto pick = std::make_shared<PickResult>();
+            RenderThread::Request([view, mouseX, mouseY, pick]() mutable {
+                pick->hit = Renderer::PickAt(&view, mouseX, mouseY, *pick);
+            }, [this, focusClick, pick] {
+                if (pick->hit && focusClick) {
+                    camera->FocusOnPoint(pick->position[0], pick->position[1], pick->position[2], pick->distance);
+                }
+            });
+        }
+
+        // Rotacion y zoom por frame; movimiento en ticks de simulacion fijos
+        camera->UpdateLook();
+        while (Time::StepFixed()) {
+            camera->Update(Time::GetFixedDeltaTime());
+        }
+        camera->SetInterpolationAlpha(Time::GetInterpolationAlpha());
+
+        // Poses de los personajes animados (paleta al texture buffer)
+        float dt = Time::GetDeltaTime();
+        RenderThread::Enqueue([dt] { Renderer::UpdateAnimation(dt); });
+
+        RenderThread::Enqueue([] { Renderer::Clear(0.1f, 0.1f, 0.15f, 1.0f); });
+
+        // Late latch: recoger el movimiento de raton mas reciente justo
+        // antes de calcular la vista que se envia a la GPU
+        window->PollMouseMotion();
+        camera->UpdateLook();
+
+        // La lista se queda con una copia de la vista: la camara sigue
+        // moviendose mientras el render dibuja este frame
+        Camera view = *camera;
+        Window* target = window;
+        RenderThread::Enqueue([view, target]() mutable {
+            Renderer::DrawLoadedModel(&view);
+            target->SwapBuffers();
+            Renderer::EndFrame();
+        });
+
+        RenderThread::EndFrame();
+
+        pendingInputTimestamp = Input::GetOldestEventTimestamp();
+
+        // Entre frames: no hay ninguna lista a medias
+        if (toggleRenderThread) {
+            if (RenderThread::IsRunning()) RenderThread::Stop();
+            else RenderThread::Start(window);
+        }
+
+        if (++frameCount % 300 == 0 && latencySamples > 0) {
+            std::cout << "Input latency (input -> GPU frame done): avg "
+                << (latencySumMs / latencySamples) << " ms, max " << latencyMaxMs
+                << " ms over " << latencySamples << " frames\n";
+            latencySumMs = 0.0;
+            latencyMaxMs = 0.0;
+            latencySamples = 0;
+        }
+        if (frameCount % 300 == 0) {
+            RenderThread::PrintStats();
+        }
     }
 
+    // El contexto vuelve a este hilo para liberar los recursos de GL
+    RenderThread::Stop();
     Renderer::Shutdown();
+    JobSystem::Shutdown();
+
     std::cout << "Engine closed cleanly\n";
-}
\ No newline at end of file
+}
+
+void Application::RecordInputLatency(Uint64 inputNs, Uint64 frameDoneNs) {
+    // Solo frames con entrada: el evento mas antiguo aplicado a ese frame
+    if (inputNs == 0 || frameDoneNs < inputNs) {
+        return;
+    }
+
+    double latencyMs = (frameDoneNs - inputNs) / 1.0e6;
+    latencySumMs += latencyMs;
+    latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+    latencySamples++;
+}
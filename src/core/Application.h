@@ -15,4 +15,16 @@ private:
     Camera* camera = nullptr;
 
     bool modelLoadedLastFrame = false; // NUEVO
+
+    // Escena segun el ultimo frame que ha ejecutado el render
+    bool modelLoaded = false;
+    float modelCenter[3] = { 0.0f, 0.0f, 0.0f };
+    float modelSize = 0.0f;
+
+    // Latencia entrada -> foton (aprox.: fin de la GPU del frame)
+    Uint64 pendingInputTimestamp = 0;
+    double latencySumMs = 0.0;
+    double latencyMaxMs = 0.0;
+    int latencySamples = 0;
+    void RecordInputLatency(Uint64 inputNs, Uint64 frameDoneNs);
 };
\ No newline at end of file
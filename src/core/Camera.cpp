@@ -60,21 +60,24 @@ Camera::Camera()
     , mSensitivity(0.1f)
     , mFOV(45.0f)
     , mSceneSize(10.0f)  // NUEVO: valor por defecto
+    , mPrevPosX(0), mPrevPosY(0), mPrevPosZ(5)
+    , mAlpha(1.0f)
 {
     UpdateVectors();
     std::cout << "Camera initialized" << std::endl;
 }
 
-void Camera::Update(float deltaTime) {
+void Camera::UpdateLook() {
     if (!Input::IsCameraControlActive()) {
         return;
     }
 
-    // Rotación con ratón
-    int dx, dy;
-    Input::GetMouseDelta(dx, dy);
+    // Rotación con ratón (consume lo acumulado: se puede llamar varias
+    // veces por frame para recoger el movimiento más reciente)
+    float dx, dy;
+    Input::ConsumeMouseDelta(dx, dy);
 
-    if (dx != 0 || dy != 0) {
+    if (dx != 0.0f || dy != 0.0f) {
         mYaw += dx * mSensitivity;
         mPitch -= dy * mSensitivity;
 
@@ -83,41 +86,61 @@ void Camera::Update(float deltaTime) {
         UpdateVectors();
     }
 
+    // Zoom con rueda del ratón
+    float wheel = Input::ConsumeMouseWheelDelta();
+    if (wheel != 0.0f) {
+        Zoom(wheel);
+    }
+}
+
+void Camera::Update(float deltaTime) {
+    mPrevPosX = mPosX;
+    mPrevPosY = mPosY;
+    mPrevPosZ = mPosZ;
+
+    if (!Input::IsCameraControlActive()) {
+        return;
+    }
+
     // Movimiento con WASD
     float velocity = mSpeed * deltaTime;
 
-    if (Input::IsKeyDown(SDLK_W)) {
+    if (Input::IsKeyDown(SDL_SCANCODE_W)) {
         mPosX += mForwardX * velocity;
         mPosY += mForwardY * velocity;
         mPosZ += mForwardZ * velocity;
     }
-    if (Input::IsKeyDown(SDLK_S)) {
+    if (Input::IsKeyDown(SDL_SCANCODE_S)) {
         mPosX -= mForwardX * velocity;
         mPosY -= mForwardY * velocity;
         mPosZ -= mForwardZ * velocity;
     }
-    if (Input::IsKeyDown(SDLK_A)) {
+    if (Input::IsKeyDown(SDL_SCANCODE_A)) {
         mPosX -= mRightX * velocity;
         mPosY -= mRightY * velocity;
         mPosZ -= mRightZ * velocity;
     }
-    if (Input::IsKeyDown(SDLK_D)) {
+    if (Input::IsKeyDown(SDL_SCANCODE_D)) {
         mPosX += mRightX * velocity;
         mPosY += mRightY * velocity;
         mPosZ += mRightZ * velocity;
     }
-    if (Input::IsKeyDown(SDLK_E)) {
+    if (Input::IsKeyDown(SDL_SCANCODE_E)) {
         mPosY += velocity;
     }
-    if (Input::IsKeyDown(SDLK_Q)) {
+    if (Input::IsKeyDown(SDL_SCANCODE_Q)) {
         mPosY -= velocity;
     }
+}
 
-    // Zoom con rueda del ratón
-    float wheel = Input::GetMouseWheelDelta();
-    if (wheel != 0.0f) {
-        Zoom(wheel);
-    }
+void Camera::SetInterpolationAlpha(float alpha) {
+    mAlpha = std::max(0.0f, std::min(1.0f, alpha));
+}
+
+void Camera::SnapInterpolation() {
+    mPrevPosX = mPosX;
+    mPrevPosY = mPosY;
+    mPrevPosZ = mPosZ;
 }
 
 void Camera::UpdateVectors() {
@@ -156,11 +179,16 @@ void Camera::UpdateVectors() {
 }
 
 void Camera::GetViewMatrix(float out[16]) const {
-    float centerX = mPosX + mForwardX;
-    float centerY = mPosY + mForwardY;
-    float centerZ = mPosZ + mForwardZ;
+    // Interpolar entre los dos ultimos ticks de simulacion
+    float posX = mPrevPosX + (mPosX - mPrevPosX) * mAlpha;
+    float posY = mPrevPosY + (mPosY - mPrevPosY) * mAlpha;
+    float posZ = mPrevPosZ + (mPosZ - mPrevPosZ) * mAlpha;
 
-    MatLookAt(out, mPosX, mPosY, mPosZ, centerX, centerY, centerZ, mUpX, mUpY, mUpZ);
+    float centerX = posX + mForwardX;
+    float centerY = posY + mForwardY;
+    float centerZ = posZ + mForwardZ;
+
+    MatLookAt(out, posX, posY, posZ, centerX, centerY, centerZ, mUpX, mUpY, mUpZ);
 }
 
 void Camera::GetProjectionMatrix(float out[16], float aspect) const {
@@ -178,6 +206,7 @@ void Camera::SetPosition(float x, float y, float z) {
     mPosX = x;
     mPosY = y;
     mPosZ = z;
+    SnapInterpolation();
 }
 
 void Camera::Rotate(float yaw, float pitch) {
@@ -196,6 +225,11 @@ void Camera::Zoom(float amount) {
     mPosY += mForwardY * movement;
     mPosZ += mForwardZ * movement;
 
+    // El zoom es un impulso por frame: desplazar tambien el estado previo
+    mPrevPosX += mForwardX * movement;
+    mPrevPosY += mForwardY * movement;
+    mPrevPosZ += mForwardZ * movement;
+
     static int lastPrint = 0;
     if (++lastPrint % 10 == 0) {
         std::cout << "Camera moved. Distance: " << movement << std::endl;
@@ -235,6 +269,7 @@ void Camera::FocusOnPoint(float targetX, float targetY, float targetZ, float dis
     mPosX = targetX + offsetX;
     mPosY = targetY + offsetY;
     mPosZ = targetZ + offsetZ;
+    SnapInterpolation();
 
     std::cout << "Camera positioned at: (" << mPosX << ", " << mPosY << ", " << mPosZ << ")" << std::endl;
 
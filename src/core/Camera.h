@@ -4,7 +4,9 @@ class Camera {
 public:
     Camera();
 
-    void Update(float deltaTime);
+    void Update(float deltaTime);   // tick fijo: movimiento WASD/QE
+    void UpdateLook();              // por frame: rotacion con raton y zoom
+    void SetInterpolationAlpha(float alpha);
     void GetViewMatrix(float out[16]) const;
     void GetProjectionMatrix(float out[16], float aspect) const;
 
@@ -16,6 +18,7 @@ public:
 
     // Getters
     void GetPosition(float& x, float& y, float& z) const;
+    float GetFOV() const { return mFOV; }
 
     // NUEVO: Focus en un punto
     void FocusOnPoint(float x, float y, float z, float distance);
@@ -35,4 +38,9 @@ private:
     float mRightX, mRightY, mRightZ;
     float mUpX, mUpY, mUpZ;
     float mSceneSize;
+
+    // Posicion del tick anterior, para interpolar al renderizar
+    float mPrevPosX, mPrevPosY, mPrevPosZ;
+    float mAlpha;
+    void SnapInterpolation();
 };
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "ClusteredLighting.h"
+#include "GLState.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static const char* kClusteredLightingGLSL = R"(
+uniform samplerBuffer uLightData;       // 2 texels por luz: (pos, radio), (color, intensidad)
+uniform usamplerBuffer uClusterGrid;    // (offset, count) por cluster
+uniform usamplerBuffer uLightIndices;
+uniform ivec3 uClusterDims;
+uniform vec2 uViewportSize;
+uniform vec2 uNearFar;
+uniform bool uUnlit;
+
+in vec3 vWorldPos;
+in vec3 vNormal;
+
+// Luz direccional con sombras (ShadowCascades)
+vec3 SunLight(vec3 albedo, vec3 n, float viewZ);
+
+vec3 ApplyLighting(vec3 albedo) {
+    if (uUnlit) return albedo;
+
+    // Se dibujan las dos caras: la normal mira siempre a la camara
+    vec3 n = normalize(vNormal);
+    if (!gl_FrontFacing) n = -n;
+
+    float zNdc = gl_FragCoord.z * 2.0 - 1.0;
+    float viewZ = 2.0 * uNearFar.x * uNearFar.y / (uNearFar.y + uNearFar.x - zNdc * (uNearFar.y - uNearFar.x));
+
+    // Ambiente hemisferico y el sol
+    vec3 color = albedo * (0.25 + 0.15 * n.y);
+    color += SunLight(albedo, n, viewZ);
+
+    int slice = int(log(viewZ / uNearFar.x) / log(uNearFar.y / uNearFar.x) * float(uClusterDims.z));
+    ivec3 c = ivec3(ivec2(gl_FragCoord.xy / uViewportSize * vec2(uClusterDims.xy)), slice);
+    c = clamp(c, ivec3(0), uClusterDims - ivec3(1));
+    int cluster = c.x + uClusterDims.x * (c.y + uClusterDims.y * c.z);
+
+    uvec2 range = texelFetch(uClusterGrid, cluster).xy;
+    for (uint i = 0u; i < range.y; ++i) {
+        int light = int(texelFetch(uLightIndices, int(range.x + i)).x);
+        vec4 posRadius = texelFetch(uLightData, light * 2);
+        vec4 colorIntensity = texelFetch(uLightData, light * 2 + 1);
+
+        vec3 toLight = posRadius.xyz - vWorldPos;
+        float d2 = dot(toLight, toLight);
+        float window = clamp(1.0 - d2 / (posRadius.w * posRadius.w), 0.0, 1.0);
+        if (window <= 0.0) continue;
+
+        float ndl = max(dot(n, toLight * inversesqrt(max(d2, 1e-8))), 0.0);
+        color += albedo * colorIntensity.rgb * colorIntensity.a * ndl * window * window;
+    }
+    return color;
+}
+)";
+
+const char* ClusteredLighting::GetShaderSource() {
+    return kClusteredLightingGLSL;
+}
+
+ClusteredLighting::ClusteredLighting()
+    : mLightBuffer(0), mGridBuffer(0), mIndexBuffer(0),
+      mLightTexture(0), mGridTexture(0), mIndexTexture(0),
+      mLightBytes(0), mGridBytes(0), mIndexBytes(0),
+      mLightsDirty(true), mNear(0.1f), mFar(1000.0f), mMaxPerCluster(0), mLastUpdateMs(0.0) {
+}
+
+bool ClusteredLighting::Init() {
+    if (mLightBuffer) return true;
+
+    glGenBuffers(1, &mLightBuffer);
+    glGenBuffers(1, &mGridBuffer);
+    glGenBuffers(1, &mIndexBuffer);
+    glGenTextures(1, &mLightTexture);
+    glGenTextures(1, &mGridTexture);
+    glGenTextures(1, &mIndexTexture);
+
+    // Un TBO sin almacenamiento no es valido: reservar un elemento minimo
+    const float zeros[8] = {};
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, mLightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(zeros), zeros, GL_DYNAMIC_DRAW);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, mGridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, kClusterCount * 2 * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, mIndexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(uint32_t), zeros, GL_STREAM_DRAW);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, 0);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mLightBytes, sizeof(zeros));
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mGridBytes, kClusterCount * 2 * sizeof(uint32_t));
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mIndexBytes, sizeof(uint32_t));
+
+    GLState::BindTexture(0, GL_TEXTURE_BUFFER, mLightTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mLightBuffer);
+    GLState::BindTexture(0, GL_TEXTURE_BUFFER, mGridTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, mGridBuffer);
+    GLState::BindTexture(0, GL_TEXTURE_BUFFER, mIndexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, mIndexBuffer);
+    GLState::BindTexture(0, GL_TEXTURE_BUFFER, 0);
+
+    mSliceIndices.resize(kClustersZ);
+    mSliceCounts.resize(kClustersZ);
+    return true;
+}
+
+void ClusteredLighting::Shutdown() {
+    if (mLightTexture) GLState::DeleteTextures(1, &mLightTexture);
+    if (mGridTexture) GLState::DeleteTextures(1, &mGridTexture);
+    if (mIndexTexture) GLState::DeleteTextures(1, &mIndexTexture);
+    if (mLightBuffer) GLState::DeleteBuffers(1, &mLightBuffer);
+    if (mGridBuffer) GLState::DeleteBuffers(1, &mGridBuffer);
+    if (mIndexBuffer) GLState::DeleteBuffers(1, &mIndexBuffer);
+    mLightTexture = mGridTexture = mIndexTexture = 0;
+    mLightBuffer = mGridBuffer = mIndexBuffer = 0;
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mLightBytes, 0);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mGridBytes, 0);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mIndexBytes, 0);
+}
+
+void ClusteredLighting::ClearLights() {
+    mLights.clear();
+    mLightsDirty = true;
+}
+
+void ClusteredLighting::AddLight(const PointLight& light) {
+    mLights.push_back(light);
+    mLightsDirty = true;
+}
+
+int ClusteredLighting::SliceForDepth(float depth) const {
+    float t = std::log(std::max(depth, mNear) / mNear) / std::log(mFar / mNear);
+    return std::max(0, std::min(kClustersZ - 1, (int)(t * kClustersZ)));
+}
+
+// Rango de clusters que toca la esfera de la luz (conservador)
+void ClusteredLighting::AssignLight(size_t index, const float view[16], const float proj[16]) {
+    const PointLight& light = mLights[index];
+    LightRange& range = mRanges[index];
+    range.valid = false;
+
+    const float* p = light.position;
+    float vx = view[0] * p[0] + view[4] * p[1] + view[8] * p[2] + view[12];
+    float vy = view[1] * p[0] + view[5] * p[1] + view[9] * p[2] + view[13];
+    float vz = view[2] * p[0] + view[6] * p[1] + view[10] * p[2] + view[14];
+    float depth = -vz;
+    float r = light.radius;
+
+    if (depth + r < mNear || depth - r > mFar) return;
+
+    float dMin = std::max(mNear, depth - r);
+    float dMax = std::min(mFar, depth + r);
+    range.z0 = SliceForDepth(dMin);
+    range.z1 = SliceForDepth(dMax);
+
+    if (depth - r <= mNear) {
+        // La esfera cruza el plano near: puede cubrir toda la pantalla
+        range.x0 = 0; range.x1 = kClustersX - 1;
+        range.y0 = 0; range.y1 = kClustersY - 1;
+        range.valid = true;
+        return;
+    }
+
+    // Extremos en NDC de la caja de la esfera a la profundidad mas cercana y lejana
+    float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+    for (float d : { dMin, dMax }) {
+        for (float sx : { vx - r, vx + r }) {
+            float ndc = proj[0] * sx / d;
+            minX = std::min(minX, ndc);
+            maxX = std::max(maxX, ndc);
+        }
+        for (float sy : { vy - r, vy + r }) {
+            float ndc = proj[5] * sy / d;
+            minY = std::min(minY, ndc);
+            maxY = std::max(maxY, ndc);
+        }
+    }
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) return;
+
+    auto tile = [](float ndc, int count) {
+        return std::max(0, std::min(count - 1, (int)std::floor((ndc * 0.5f + 0.5f) * count)));
+    };
+    range.x0 = tile(minX, kClustersX);
+    range.x1 = tile(maxX, kClustersX);
+    range.y0 = tile(minY, kClustersY);
+    range.y1 = tile(maxY, kClustersY);
+    range.valid = true;
+}
+
+// Un job por corte z: escribe solo en sus clusters
+void ClusteredLighting::FillSlice(int z) {
+    std::vector<uint32_t>& counts = mSliceCounts[z];
+    std::vector<uint32_t>& indices = mSliceIndices[z];
+    counts.assign(kClustersX * kClustersY, 0);
+    indices.clear();
+
+    for (const LightRange& range : mRanges) {
+        if (!range.valid || z < range.z0 || z > range.z1) continue;
+        for (int y = range.y0; y <= range.y1; ++y) {
+            for (int x = range.x0; x <= range.x1; ++x) {
+                counts[y * kClustersX + x]++;
+            }
+        }
+    }
+
+    // Offsets locales y relleno ordenado por cluster
+    std::vector<uint32_t> cursor(counts.size());
+    uint32_t total = 0;
+    for (size_t c = 0; c < counts.size(); ++c) {
+        cursor[c] = total;
+        total += counts[c];
+    }
+    indices.resize(total);
+
+    for (size_t l = 0; l < mRanges.size(); ++l) {
+        const LightRange& range = mRanges[l];
+        if (!range.valid || z < range.z0 || z > range.z1) continue;
+        for (int y = range.y0; y <= range.y1; ++y) {
+            for (int x = range.x0; x <= range.x1; ++x) {
+                indices[cursor[y * kClustersX + x]++] = (uint32_t)l;
+            }
+        }
+    }
+}
+
+void ClusteredLighting::Update(const float view[16], const float proj[16], float nearPlane, float farPlane) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    mNear = std::max(nearPlane, 1e-4f);
+    mFar = std::max(farPlane, mNear * 2.0f);
+
+    mRanges.resize(mLights.size());
+    JobSystem::ParallelFor(mLights.size(), 256, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) AssignLight(i, view, proj);
+    });
+    JobSystem::ParallelFor(kClustersZ, 1, [this](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) FillSlice((int)z);
+    });
+
+    // Concatenar los cortes en la rejilla global
+    mGrid.resize(kClusterCount * 2);
+    mIndices.clear();
+    mMaxPerCluster = 0;
+    for (int z = 0; z < kClustersZ; ++z) {
+        uint32_t sliceBase = (uint32_t)mIndices.size();
+        uint32_t local = 0;
+        for (int c = 0; c < kClustersX * kClustersY; ++c) {
+            uint32_t count = mSliceCounts[z][c];
+            int cluster = z * kClustersX * kClustersY + c;
+            mGrid[cluster * 2] = sliceBase + local;
+            mGrid[cluster * 2 + 1] = count;
+            local += count;
+            mMaxPerCluster = std::max(mMaxPerCluster, count);
+        }
+        mIndices.insert(mIndices.end(), mSliceIndices[z].begin(), mSliceIndices[z].end());
+    }
+
+    if (mLightsDirty && !mLights.empty()) {
+        GLState::BindBuffer(GL_TEXTURE_BUFFER, mLightBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, mLights.size() * sizeof(PointLight), mLights.data(), GL_DYNAMIC_DRAW);
+        MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mLightBytes, mLights.size() * sizeof(PointLight));
+        mLightsDirty = false;
+    }
+
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, mGridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, mGrid.size() * sizeof(uint32_t), mGrid.data(), GL_STREAM_DRAW);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mGridBytes, mGrid.size() * sizeof(uint32_t));
+    if (!mIndices.empty()) {
+        GLState::BindBuffer(GL_TEXTURE_BUFFER, mIndexBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, mIndices.size() * sizeof(uint32_t), mIndices.data(), GL_STREAM_DRAW);
+        MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mIndexBytes, mIndices.size() * sizeof(uint32_t));
+    }
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    mLastUpdateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void ClusteredLighting::Bind(unsigned int program, int viewportW, int viewportH) const {
+    GLState::BindTexture(kLightDataUnit, GL_TEXTURE_BUFFER, mLightTexture);
+    GLState::BindTexture(kClusterGridUnit, GL_TEXTURE_BUFFER, mGridTexture);
+    GLState::BindTexture(kLightIndexUnit, GL_TEXTURE_BUFFER, mIndexTexture);
+
+    int loc = glGetUniformLocation(program, "uLightData");
+    if (loc != -1) glUniform1i(loc, kLightDataUnit);
+    loc = glGetUniformLocation(program, "uClusterGrid");
+    if (loc != -1) glUniform1i(loc, kClusterGridUnit);
+    loc = glGetUniformLocation(program, "uLightIndices");
+    if (loc != -1) glUniform1i(loc, kLightIndexUnit);
+    loc = glGetUniformLocation(program, "uClusterDims");
+    if (loc != -1) glUniform3i(loc, kClustersX, kClustersY, kClustersZ);
+    loc = glGetUniformLocation(program, "uViewportSize");
+    if (loc != -1) glUniform2f(loc, (float)std::max(viewportW, 1), (float)std::max(viewportH, 1));
+    loc = glGetUniformLocation(program, "uNearFar");
+    if (loc != -1) glUniform2f(loc, mNear, mFar);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PointLight {
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    float radius = 1.0f;                       // alcance: la luz es 0 a esta distancia
+    float color[3] = { 1.0f, 1.0f, 1.0f };
+    float intensity = 1.0f;
+};
+
+// Clustered forward: el frustum se divide en kClustersX x kClustersY tiles de
+// pantalla y kClustersZ cortes exponenciales en profundidad. Cada frame se
+// asignan las luces a los clusters en el JobSystem y las listas se suben a
+// texture buffers que lee el fragment shader.
+class ClusteredLighting {
+public:
+    static const int kClustersX = 16;
+    static const int kClustersY = 9;
+    static const int kClustersZ = 24;
+    static const int kClusterCount = kClustersX * kClustersY * kClustersZ;
+
+    // Unidades de textura usadas por Bind()
+    static const int kLightDataUnit = 1;
+    static const int kClusterGridUnit = 2;
+    static const int kLightIndexUnit = 3;
+
+    // Codigo GLSL con ApplyLighting(albedo); se inserta tras la linea #version.
+    // Declara SunLight(), que define ShadowCascades::GetShaderSource()
+    static const char* GetShaderSource();
+
+    ClusteredLighting();
+
+    bool Init();
+    void Shutdown();
+
+    void ClearLights();
+    void AddLight(const PointLight& light);
+    size_t GetLightCount() const { return mLights.size(); }
+
+    // view/proj column-major; asigna las luces y sube las listas
+    void Update(const float view[16], const float proj[16], float nearPlane, float farPlane);
+    // Enlaza los texture buffers y fija los uniforms del programa activo
+    void Bind(unsigned int program, int viewportW, int viewportH) const;
+
+    size_t GetLastAssignmentCount() const { return mIndices.size(); }
+    uint32_t GetLastMaxLightsPerCluster() const { return mMaxPerCluster; }
+    double GetLastUpdateMs() const { return mLastUpdateMs; }
+
+private:
+    struct LightRange {
+        int x0, x1, y0, y1, z0, z1;
+        bool valid;
+    };
+
+    std::vector<PointLight> mLights;
+    std::vector<LightRange> mRanges;
+    std::vector<std::vector<uint32_t>> mSliceIndices;   // por corte z
+    std::vector<std::vector<uint32_t>> mSliceCounts;
+    std::vector<uint32_t> mGrid;                        // (offset, count) por cluster
+    std::vector<uint32_t> mIndices;
+
+    unsigned int mLightBuffer, mGridBuffer, mIndexBuffer;
+    unsigned int mLightTexture, mGridTexture, mIndexTexture;
+    size_t mLightBytes, mGridBytes, mIndexBytes;    // tamanos actuales de los TBO
+    bool mLightsDirty;
+    float mNear, mFar;
+    uint32_t mMaxPerCluster;
+    double mLastUpdateMs;
+
+    int SliceForDepth(float depth) const;
+    void AssignLight(size_t index, const float view[16], const float proj[16]);
+    void FillSlice(int z);
+};
@@ -0,0 +1,140 @@
+#include "DynamicResolution.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Se apunta a este porcentaje del objetivo para no ir siempre al limite
+static const float kHeadroom = 0.9f;
+// Subida maxima por frame; la bajada es inmediata
+static const float kMaxStepUp = 0.02f;
+// Cambios menores que esto se ignoran (evita oscilar por ruido)
+static const float kDeadband = 0.01f;
+static const double kSmoothing = 0.2;
+
+DynamicResolution::DynamicResolution()
+    : mFrame(0), mTiming(false), mScale(1.0f), mTargetScale(1.0f), mMinScale(0.5f), mMaxScale(1.0f),
+      mTargetMs(1000.0f / 60.0f), mGpuMs(0.0), mHasSample(false), mEnabled(true), mChanges(0) {
+    for (int i = 0; i < kQueryFrames; ++i) {
+        mQueries[i][0] = mQueries[i][1] = 0;
+        mPending[i] = false;
+        mSlotScale[i] = 1.0f;
+    }
+}
+
+bool DynamicResolution::Init() {
+    if (mQueries[0][0]) return true;
+    for (int i = 0; i < kQueryFrames; ++i) {
+        glGenQueries(2, mQueries[i]);
+    }
+    return true;
+}
+
+void DynamicResolution::Shutdown() {
+    for (int i = 0; i < kQueryFrames; ++i) {
+        if (mQueries[i][0]) glDeleteQueries(2, mQueries[i]);
+        mQueries[i][0] = mQueries[i][1] = 0;
+        mPending[i] = false;
+    }
+    mTiming = false;
+}
+
+void DynamicResolution::SetEnabled(bool enabled) {
+    mEnabled = enabled;
+    // Al volver a activarse empieza desde la escala maxima
+    mScale = mTargetScale = mMaxScale;
+    mHasSample = false;
+}
+
+void DynamicResolution::SetLimits(float minScale, float maxScale) {
+    mMaxScale = std::min(2.0f, std::max(0.1f, maxScale));
+    mMinScale = std::min(mMaxScale, std::max(0.1f, minScale));
+    mScale = std::min(mMaxScale, std::max(mMinScale, mScale));
+    mTargetScale = std::min(mMaxScale, std::max(mMinScale, mTargetScale));
+}
+
+void DynamicResolution::SetTargetMs(float targetMs) {
+    mTargetMs = std::max(0.5f, targetMs);
+}
+
+void DynamicResolution::Update() {
+    if (!mQueries[0][0]) return;
+
+    // Del mas antiguo al mas reciente; sin esperar a los que no estan
+    bool newSample = false;
+    for (int k = 1; k <= kQueryFrames; ++k) {
+        int slot = (mFrame + k) % kQueryFrames;
+        if (!mPending[slot]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(mQueries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(mQueries[slot][0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(mQueries[slot][1], GL_QUERY_RESULT, &end);
+        mPending[slot] = false;
+
+        // Coste proporcional a los pixeles: se lleva a la escala actual
+        double ms = end > begin ? (end - begin) / 1e6 : 0.0;
+        float ratio = GetScale() / std::max(0.01f, mSlotScale[slot]);
+        ms *= (double)ratio * ratio;
+        mGpuMs = mHasSample ? mGpuMs + (ms - mGpuMs) * kSmoothing : ms;
+        mHasSample = true;
+        newSample = true;
+    }
+
+    if (!mEnabled || !newSample || mGpuMs <= 0.0) return;
+
+    float ideal = mScale * (float)std::sqrt(mTargetMs * kHeadroom / mGpuMs);
+    mTargetScale = std::min(mMaxScale, std::max(mMinScale, ideal));
+
+    float previous = mScale;
+    if (mTargetScale < mScale - kDeadband) {
+        mScale = mTargetScale;
+    } else if (mTargetScale > mScale + kDeadband) {
+        mScale = std::min(mTargetScale, mScale + kMaxStepUp);
+    }
+    if (mScale != previous) {
+        // La media pasa a la nueva escala
+        float ratio = mScale / previous;
+        mGpuMs *= (double)ratio * ratio;
+        mChanges++;
+    }
+}
+
+void DynamicResolution::BeginTiming() {
+    // Si la GPU va tan atrasada que el slot sigue pendiente, este frame no se mide
+    mTiming = mQueries[0][0] && !mPending[mFrame];
+    if (!mTiming) return;
+    mSlotScale[mFrame] = GetScale();
+    glQueryCounter(mQueries[mFrame][0], GL_TIMESTAMP);
+}
+
+void DynamicResolution::EndTiming() {
+    if (!mTiming) return;
+    glQueryCounter(mQueries[mFrame][1], GL_TIMESTAMP);
+    mPending[mFrame] = true;
+    mFrame = (mFrame + 1) % kQueryFrames;
+    mTiming = false;
+}
+
+void DynamicResolution::GetTargetSize(int windowW, int windowH, int& w, int& h) const {
+    float scale = mEnabled ? mMaxScale : std::max(mMaxScale, 1.0f);
+    w = std::max(1, (int)std::ceil(windowW * scale));
+    h = std::max(1, (int)std::ceil(windowH * scale));
+}
+
+void DynamicResolution::GetRenderSize(int windowW, int windowH, int& w, int& h) const {
+    int maxW, maxH;
+    GetTargetSize(windowW, windowH, maxW, maxH);
+    float scale = GetScale();
+    w = std::min(maxW, std::max(1, (int)std::lround(windowW * scale)));
+    h = std::min(maxH, std::max(1, (int)std::lround(windowH * scale)));
+}
+
+void DynamicResolution::PrintStats() const {
+    std::cout << "Dynamic resolution: " << (mEnabled ? "ON" : "OFF") << ", scale " << GetScale()
+        << " (target " << GetTargetScale() << ", limits " << mMinScale << ".." << mMaxScale << "), GPU "
+        << mGpuMs << " ms (target " << mTargetMs << " ms), " << mChanges << " changes" << std::endl;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Escala de resolucion de la escena guiada por el tiempo de GPU del frame.
+// Se mide con pares de timestamps (no chocan con las GL_TIME_ELAPSED de las
+// sombras) en un anillo de frames, leidos sin bloquear. La escala baja de
+// golpe cuando el frame se pasa del objetivo y sube poco a poco cuando sobra
+// margen; los targets se reservan a la escala maxima y solo cambia el
+// rectangulo en el que se dibuja.
+class DynamicResolution {
+public:
+    static const int kQueryFrames = 4;
+
+    DynamicResolution();
+
+    bool Init();
+    void Shutdown();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return mEnabled; }
+    // Limites de la escala por eje (0..1] y tiempo objetivo de GPU
+    void SetLimits(float minScale, float maxScale);
+    void SetTargetMs(float targetMs);
+    float GetMinScale() const { return mMinScale; }
+    float GetMaxScale() const { return mMaxScale; }
+    float GetTargetMs() const { return mTargetMs; }
+
+    // Recoge los tiempos ya disponibles y ajusta la escala (antes de dibujar)
+    void Update();
+    // Alrededor del trabajo de GPU del frame
+    void BeginTiming();
+    void EndTiming();
+
+    // Tamano de los targets (escala maxima) y del area dibujada este frame
+    void GetTargetSize(int windowW, int windowH, int& w, int& h) const;
+    void GetRenderSize(int windowW, int windowH, int& w, int& h) const;
+
+    // Desactivada se dibuja a resolucion nativa
+    float GetScale() const { return mEnabled ? mScale : 1.0f; }
+    float GetTargetScale() const { return mEnabled ? mTargetScale : 1.0f; }
+    double GetGpuMs() const { return mGpuMs; }
+
+    void PrintStats() const;
+
+private:
+    unsigned int mQueries[kQueryFrames][2];
+    bool mPending[kQueryFrames];
+    float mSlotScale[kQueryFrames]; // escala con la que se dibujo cada slot
+    int mFrame;                     // slot del anillo del frame actual
+    bool mTiming;
+    float mScale, mTargetScale;
+    float mMinScale, mMaxScale;
+    float mTargetMs;
+    double mGpuMs;                  // media exponencial
+    bool mHasSample;
+    bool mEnabled;
+    unsigned long long mChanges;
+};
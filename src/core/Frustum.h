@@ -0,0 +1,46 @@
+#pragma once
+#include <cmath>
+
+// Planos del frustum extraidos de una matriz view-projection column-major
+// (la misma que uViewProj en FrameData). Normal hacia dentro: dentro si d >= 0.
+struct Frustum {
+    float planes[6][4];
+
+    void ExtractFromMatrix(const float m[16]) {
+        // Fila i de la matriz: (m[i], m[4 + i], m[8 + i], m[12 + i])
+        for (int p = 0; p < 6; ++p) {
+            int row = p / 2;
+            float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+            for (int k = 0; k < 4; ++k) {
+                planes[p][k] = m[k * 4 + 3] + sign * m[k * 4 + row];
+            }
+            float len = std::sqrt(planes[p][0] * planes[p][0] +
+                planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+            if (len > 0.0f) {
+                for (int k = 0; k < 4; ++k) planes[p][k] /= len;
+            }
+        }
+    }
+
+    bool IntersectsAABB(const float bmin[3], const float bmax[3]) const {
+        for (int p = 0; p < 6; ++p) {
+            // Vertice positivo: la esquina mas adentro segun la normal
+            float x = planes[p][0] >= 0.0f ? bmax[0] : bmin[0];
+            float y = planes[p][1] >= 0.0f ? bmax[1] : bmin[1];
+            float z = planes[p][2] >= 0.0f ? bmax[2] : bmin[2];
+            if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool IntersectsSphere(const float center[3], float radius) const {
+        for (int p = 0; p < 6; ++p) {
+            float d = planes[p][0] * center[0] + planes[p][1] * center[1] +
+                planes[p][2] * center[2] + planes[p][3];
+            if (d < -radius) return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,245 @@
+#include "GLState.h"
+#include <glad/glad.h>
+
+#include <iostream>
+
+// Valor de "no se sabe": nunca coincide con lo que se pide
+static const unsigned int kUnknown = 0xffffffffu;
+
+unsigned int GLState::sProgram = kUnknown;
+unsigned int GLState::sVertexArray = kUnknown;
+unsigned int GLState::sBuffers[3] = { kUnknown, kUnknown, kUnknown };
+int GLState::sActiveUnit = -1;
+unsigned int GLState::sTextures[kMaxTextureUnits][3];
+int GLState::sCapabilities[4] = { -1, -1, -1, -1 };
+unsigned int GLState::sDepthFunc = kUnknown;
+int GLState::sDepthMask = -1;
+int GLState::sColorMask = -1;
+unsigned int GLState::sBlendSrc = kUnknown;
+unsigned int GLState::sBlendDst = kUnknown;
+unsigned int GLState::sPolygonMode = kUnknown;
+float GLState::sLineWidth = -1.0f;
+int GLState::sViewport[4] = { -1, -1, -1, -1 };
+unsigned long long GLState::sFrameIssued = 0;
+unsigned long long GLState::sFrameFiltered = 0;
+unsigned long long GLState::sTotalIssued = 0;
+unsigned long long GLState::sTotalFiltered = 0;
+unsigned long long GLState::sErrors = 0;
+
+// Indices en las tablas; -1 = no se sigue (se emite siempre)
+static int BufferSlot(unsigned int target) {
+    switch (target) {
+    case GL_ARRAY_BUFFER: return 0;
+    case GL_UNIFORM_BUFFER: return 1;
+    case GL_TEXTURE_BUFFER: return 2;
+    default: return -1;
+    }
+}
+
+static int TextureSlot(unsigned int target) {
+    switch (target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_2D_ARRAY: return 1;
+    case GL_TEXTURE_BUFFER: return 2;
+    default: return -1;
+    }
+}
+
+static int CapabilitySlot(unsigned int capability) {
+    switch (capability) {
+    case GL_DEPTH_TEST: return 0;
+    case GL_BLEND: return 1;
+    case GL_CULL_FACE: return 2;
+    case GL_POLYGON_OFFSET_FILL: return 3;
+    default: return -1;
+    }
+}
+
+void GLState::Invalidate() {
+    sProgram = kUnknown;
+    sVertexArray = kUnknown;
+    for (unsigned int& buffer : sBuffers) buffer = kUnknown;
+    sActiveUnit = -1;
+    for (auto& unit : sTextures) {
+        for (unsigned int& texture : unit) texture = kUnknown;
+    }
+    for (int& capability : sCapabilities) capability = -1;
+    sDepthFunc = kUnknown;
+    sDepthMask = sColorMask = -1;
+    sBlendSrc = sBlendDst = kUnknown;
+    sPolygonMode = kUnknown;
+    sLineWidth = -1.0f;
+    for (int& v : sViewport) v = -1;
+}
+
+bool GLState::Changed(bool changed) {
+    if (changed) {
+        sFrameIssued++;
+        sTotalIssued++;
+    } else {
+        sFrameFiltered++;
+        sTotalFiltered++;
+    }
+    return changed;
+}
+
+void GLState::UseProgram(unsigned int program) {
+    if (!Changed(program != sProgram)) return;
+    glUseProgram(program);
+    sProgram = program;
+}
+
+void GLState::BindVertexArray(unsigned int vao) {
+    if (!Changed(vao != sVertexArray)) return;
+    glBindVertexArray(vao);
+    sVertexArray = vao;
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer) {
+    int slot = BufferSlot(target);
+    if (!Changed(slot < 0 || buffer != sBuffers[slot])) return;
+    glBindBuffer(target, buffer);
+    if (slot >= 0) sBuffers[slot] = buffer;
+}
+
+void GLState::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size) {
+    Changed(true);
+    glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)size);
+    int slot = BufferSlot(target);
+    if (slot >= 0) sBuffers[slot] = buffer;
+}
+
+void GLState::SetActiveUnit(int unit) {
+    if (!Changed(unit != sActiveUnit)) return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    sActiveUnit = unit;
+}
+
+void GLState::BindTexture(int unit, unsigned int target, unsigned int texture) {
+    int slot = TextureSlot(target);
+    bool tracked = slot >= 0 && unit >= 0 && unit < kMaxTextureUnits;
+    if (tracked && sTextures[unit][slot] == texture) {
+        Changed(false);
+        return;
+    }
+    SetActiveUnit(unit);
+    Changed(true);
+    glBindTexture(target, texture);
+    if (tracked) sTextures[unit][slot] = texture;
+}
+
+void GLState::SetEnabled(unsigned int capability, bool enabled) {
+    int slot = CapabilitySlot(capability);
+    if (!Changed(slot < 0 || sCapabilities[slot] != (int)enabled)) return;
+    if (enabled) glEnable(capability);
+    else glDisable(capability);
+    if (slot >= 0) sCapabilities[slot] = (int)enabled;
+}
+
+void GLState::DepthFunc(unsigned int func) {
+    if (!Changed(func != sDepthFunc)) return;
+    glDepthFunc(func);
+    sDepthFunc = func;
+}
+
+void GLState::DepthMask(bool write) {
+    if (!Changed((int)write != sDepthMask)) return;
+    glDepthMask(write ? GL_TRUE : GL_FALSE);
+    sDepthMask = (int)write;
+}
+
+void GLState::ColorMask(bool write) {
+    if (!Changed((int)write != sColorMask)) return;
+    GLboolean w = write ? GL_TRUE : GL_FALSE;
+    glColorMask(w, w, w, w);
+    sColorMask = (int)write;
+}
+
+void GLState::BlendFunc(unsigned int src, unsigned int dst) {
+    if (!Changed(src != sBlendSrc || dst != sBlendDst)) return;
+    glBlendFunc(src, dst);
+    sBlendSrc = src;
+    sBlendDst = dst;
+}
+
+void GLState::PolygonMode(unsigned int mode) {
+    if (!Changed(mode != sPolygonMode)) return;
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+    sPolygonMode = mode;
+}
+
+void GLState::LineWidth(float width) {
+    if (!Changed(width != sLineWidth)) return;
+    glLineWidth(width);
+    sLineWidth = width;
+}
+
+void GLState::Viewport(int x, int y, int width, int height) {
+    if (!Changed(x != sViewport[0] || y != sViewport[1] || width != sViewport[2] || height != sViewport[3])) return;
+    glViewport(x, y, width, height);
+    sViewport[0] = x;
+    sViewport[1] = y;
+    sViewport[2] = width;
+    sViewport[3] = height;
+}
+
+// Borrar un objeto enlazado lo desenlaza; el nombre puede volver a salir
+// en el siguiente glGen*
+void GLState::DeleteProgram(unsigned int program) {
+    if (program == sProgram) sProgram = kUnknown;
+    glDeleteProgram(program);
+}
+
+void GLState::DeleteVertexArrays(int count, const unsigned int* vaos) {
+    for (int i = 0; i < count; ++i) {
+        if (vaos[i] == sVertexArray) sVertexArray = 0;
+    }
+    glDeleteVertexArrays(count, vaos);
+}
+
+void GLState::DeleteBuffers(int count, const unsigned int* buffers) {
+    for (int i = 0; i < count; ++i) {
+        for (unsigned int& bound : sBuffers) {
+            if (bound == buffers[i]) bound = 0;
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void GLState::DeleteTextures(int count, const unsigned int* textures) {
+    for (int i = 0; i < count; ++i) {
+        for (auto& unit : sTextures) {
+            for (unsigned int& bound : unit) {
+                if (bound == textures[i]) bound = 0;
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+void GLState::CheckErrors(const char* label, const char* file, int line) {
+    GLenum err;
+    while ((err = glGetError()) != GL_NO_ERROR) {
+        sErrors++;
+        std::cerr << "OpenGL error 0x" << std::hex << err << std::dec << " after " << label
+            << " (" << file << ":" << line << ")" << std::endl;
+    }
+}
+
+void GLState::ResetFrameStats() {
+    sFrameIssued = 0;
+    sFrameFiltered = 0;
+}
+
+void GLState::PrintStats() {
+    unsigned long long frameTotal = sFrameIssued + sFrameFiltered;
+    std::cout << "GL state cache: " << sFrameIssued << " calls issued, " << sFrameFiltered << " filtered";
+    if (frameTotal > 0) {
+        std::cout << " (" << (100.0 * sFrameFiltered / frameTotal) << "%)";
+    }
+    std::cout << " this frame; " << sTotalIssued << "/" << sTotalFiltered << " in total";
+#ifndef NDEBUG
+    std::cout << ", " << sErrors << " GL errors";
+#endif
+    std::cout << std::endl;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+
+// Comprobacion de errores de GL: solo en builds de depuracion
+#ifdef NDEBUG
+#define GL_CHECK(label) ((void)0)
+#else
+#define GL_CHECK(label) GLState::CheckErrors(label, __FILE__, __LINE__)
+#endif
+
+// Copia en CPU del estado de GL que toca el motor: programa, VAO, buffers,
+// texturas por unidad, viewport y estado de raster. Las llamadas que no
+// cambian nada no llegan al driver. Todo el codigo que modifique este estado
+// tiene que pasar por aqui (o llamar a Invalidate), y los objetos se borran
+// con Delete* para que un nombre reciclado por GL no parezca ya enlazado.
+class GLState {
+public:
+    static const int kMaxTextureUnits = 8;
+
+    // Olvida lo conocido: la siguiente llamada de cada tipo se emite siempre
+    static void Invalidate();
+
+    static void UseProgram(unsigned int program);
+    static void BindVertexArray(unsigned int vao);
+    // GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER y GL_TEXTURE_BUFFER se filtran; el
+    // element array es estado del VAO y se emite siempre
+    static void BindBuffer(unsigned int target, unsigned int buffer);
+    // Rango en un binding point indexado; tambien cambia el enlace generico
+    static void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size);
+    // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY y GL_TEXTURE_BUFFER por unidad;
+    // la unidad activa tambien se sigue
+    static void BindTexture(int unit, unsigned int target, unsigned int texture);
+
+    // GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE y GL_POLYGON_OFFSET_FILL
+    static void SetEnabled(unsigned int capability, bool enabled);
+    static void DepthFunc(unsigned int func);
+    static void DepthMask(bool write);
+    static void ColorMask(bool write);
+    static void BlendFunc(unsigned int src, unsigned int dst);
+    static void PolygonMode(unsigned int mode);
+    static void LineWidth(float width);
+    static void Viewport(int x, int y, int width, int height);
+
+    static void DeleteProgram(unsigned int program);
+    static void DeleteVertexArrays(int count, const unsigned int* vaos);
+    static void DeleteBuffers(int count, const unsigned int* buffers);
+    static void DeleteTextures(int count, const unsigned int* textures);
+
+    // Vacia la cola de errores de GL y los imprime (usar con GL_CHECK)
+    static void CheckErrors(const char* label, const char* file, int line);
+
+    // Contadores del frame: llamadas emitidas y evitadas
+    static void ResetFrameStats();
+    static unsigned long long GetIssuedCalls() { return sFrameIssued; }
+    static unsigned long long GetFilteredCalls() { return sFrameFiltered; }
+    static void PrintStats();
+
+private:
+    static unsigned int sProgram;
+    static unsigned int sVertexArray;
+    static unsigned int sBuffers[3];
+    static int sActiveUnit;
+    static unsigned int sTextures[kMaxTextureUnits][3];
+    static int sCapabilities[4];
+    static unsigned int sDepthFunc;
+    static int sDepthMask, sColorMask;
+    static unsigned int sBlendSrc, sBlendDst;
+    static unsigned int sPolygonMode;
+    static float sLineWidth;
+    static int sViewport[4];
+    static unsigned long long sFrameIssued, sFrameFiltered;
+    static unsigned long long sTotalIssued, sTotalFiltered;
+    static unsigned long long sErrors;
+
+    // Cuenta la llamada; devuelve si hay que emitirla
+    static bool Changed(bool changed);
+    static void SetActiveUnit(int unit);
+};
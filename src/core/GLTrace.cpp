@@ -0,0 +1,456 @@
+#include "GLTrace.h"
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Llamadas envueltas: nombre sin "gl" y el del tipo PFNGL...PROC
+#define GLTRACE_FUNCTIONS(X) \
+    X(DrawElements, DRAWELEMENTS) \
+    X(DrawElementsInstanced, DRAWELEMENTSINSTANCED) \
+    X(MultiDrawElements, MULTIDRAWELEMENTS) \
+    X(DrawArrays, DRAWARRAYS) \
+    X(BlitFramebuffer, BLITFRAMEBUFFER) \
+    X(Clear, CLEAR) \
+    X(UseProgram, USEPROGRAM) \
+    X(BindVertexArray, BINDVERTEXARRAY) \
+    X(BindBuffer, BINDBUFFER) \
+    X(BindBufferRange, BINDBUFFERRANGE) \
+    X(ActiveTexture, ACTIVETEXTURE) \
+    X(BindTexture, BINDTEXTURE) \
+    X(BindFramebuffer, BINDFRAMEBUFFER) \
+    X(TexBuffer, TEXBUFFER) \
+    X(Enable, ENABLE) \
+    X(Disable, DISABLE) \
+    X(DepthFunc, DEPTHFUNC) \
+    X(DepthMask, DEPTHMASK) \
+    X(ColorMask, COLORMASK) \
+    X(BlendFunc, BLENDFUNC) \
+    X(PolygonMode, POLYGONMODE) \
+    X(LineWidth, LINEWIDTH) \
+    X(Viewport, VIEWPORT) \
+    X(CullFace, CULLFACE) \
+    X(Uniform1i, UNIFORM1I) \
+    X(Uniform2f, UNIFORM2F) \
+    X(Uniform3i, UNIFORM3I) \
+    X(Uniform3fv, UNIFORM3FV) \
+    X(Uniform4fv, UNIFORM4FV) \
+    X(UniformMatrix4fv, UNIFORMMATRIX4FV) \
+    X(BufferData, BUFFERDATA) \
+    X(BufferSubData, BUFFERSUBDATA) \
+    X(MapBufferRange, MAPBUFFERRANGE) \
+    X(TexImage2D, TEXIMAGE2D) \
+    X(TexImage3D, TEXIMAGE3D) \
+    X(TexSubImage3D, TEXSUBIMAGE3D)
+
+enum TraceCall : uint16_t {
+    kCallFrame = 0,
+#define GLTRACE_ENUM(name, upper) kCall##name,
+    GLTRACE_FUNCTIONS(GLTRACE_ENUM)
+#undef GLTRACE_ENUM
+    kCallCount
+};
+
+static const char* kCallNames[kCallCount] = {
+    "Frame",
+#define GLTRACE_NAME(name, upper) "gl" #name,
+    GLTRACE_FUNCTIONS(GLTRACE_NAME)
+#undef GLTRACE_NAME
+};
+
+// Punteros originales de glad mientras estan envueltos
+#define GLTRACE_REAL(name, upper) static PFNGL##upper##PROC sReal##name = nullptr;
+GLTRACE_FUNCTIONS(GLTRACE_REAL)
+#undef GLTRACE_REAL
+
+#pragma pack(push, 1)
+struct TraceRecord {
+    uint16_t call;
+    uint16_t e;     // enum principal (modo, target, formato...) truncado
+    uint32_t a;
+    uint32_t b;
+};
+#pragma pack(pop)
+static_assert(sizeof(TraceRecord) == 12, "TraceRecord must stay 12 bytes");
+
+static const uint32_t kTraceVersion = 1;
+
+static bool sInstalled = false;
+static GLCallCounters sFrame;
+static GLCallCounters sLastFrame;
+
+static bool sCapturing = false;
+static std::string sCapturePath;
+static std::vector<TraceRecord> sRecords;
+static size_t sMaxRecords = 0;
+static unsigned long long sDropped = 0;
+static uint32_t sCaptureFrames = 0;
+static std::chrono::steady_clock::time_point sCaptureStart;
+
+static void Record(TraceCall call, unsigned int e, unsigned long long a, unsigned long long b) {
+    if (call != kCallFrame) sFrame.calls++;
+    if (!sCapturing) return;
+    if (sRecords.size() >= sMaxRecords) {
+        sDropped++;
+        return;
+    }
+    TraceRecord record;
+    record.call = (uint16_t)call;
+    record.e = (uint16_t)e;
+    record.a = (uint32_t)a;
+    record.b = (uint32_t)b;
+    sRecords.push_back(record);
+}
+
+static void CountDraw(GLenum mode, unsigned long long indices, unsigned long long instances) {
+    sFrame.drawCalls++;
+    sFrame.instances += instances;
+    if (mode == GL_TRIANGLES) sFrame.triangles += indices / 3 * instances;
+}
+
+static void CountState(TraceCall call, unsigned int e, unsigned long long a, unsigned long long b) {
+    sFrame.stateChanges++;
+    Record(call, e, a, b);
+}
+
+static void CountUniform(TraceCall call, GLint location, GLsizei count) {
+    sFrame.uniformUpdates++;
+    Record(call, 0, (unsigned int)location, (unsigned long long)count);
+}
+
+// Tamano de lo que se sube con glTex*Image (sin contar el alineamiento de filas)
+static unsigned long long PixelBytes(GLenum format, GLenum type) {
+    unsigned long long components = 4;
+    switch (format) {
+    case GL_RED: case GL_DEPTH_COMPONENT: components = 1; break;
+    case GL_RG: case GL_DEPTH_STENCIL: components = 2; break;
+    case GL_RGB: case GL_BGR: components = 3; break;
+    default: break;
+    }
+    switch (type) {
+    case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+    case GL_UNSIGNED_INT_24_8: return 4;
+    default: return components * 4;
+    }
+}
+
+static void CountTexture(TraceCall call, GLenum format, GLenum type, GLsizei w, GLsizei h, GLsizei d, const void* pixels, GLint level) {
+    // Sin datos solo se reserva memoria
+    unsigned long long bytes = pixels ? (unsigned long long)w * h * d * PixelBytes(format, type) : 0;
+    if (pixels) {
+        sFrame.textureUploads++;
+        sFrame.textureBytes += bytes;
+    }
+    Record(call, format, bytes, (unsigned int)level);
+}
+
+// Draws
+static void APIENTRY TracedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    CountDraw(mode, count, 1);
+    Record(kCallDrawElements, mode, count, 1);
+    sRealDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY TracedDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances) {
+    CountDraw(mode, count, instances);
+    Record(kCallDrawElementsInstanced, mode, count, instances);
+    sRealDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+static void APIENTRY TracedMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawCount) {
+    // Un draw para el driver; los triangulos son los de todos los rangos
+    unsigned long long total = 0;
+    for (GLsizei i = 0; i < drawCount; ++i) total += count[i];
+    CountDraw(mode, total, 1);
+    Record(kCallMultiDrawElements, mode, total, drawCount);
+    sRealMultiDrawElements(mode, count, type, indices, drawCount);
+}
+
+static void APIENTRY TracedDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    CountDraw(mode, count, 1);
+    Record(kCallDrawArrays, mode, count, 1);
+    sRealDrawArrays(mode, first, count);
+}
+
+static void APIENTRY TracedBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+    GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) {
+    Record(kCallBlitFramebuffer, filter, (unsigned int)(dstX1 - dstX0), (unsigned int)(dstY1 - dstY0));
+    sRealBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+static void APIENTRY TracedClear(GLbitfield mask) {
+    Record(kCallClear, 0, mask, 0);
+    sRealClear(mask);
+}
+
+// Estado
+static void APIENTRY TracedUseProgram(GLuint program) {
+    CountState(kCallUseProgram, 0, program, 0);
+    sRealUseProgram(program);
+}
+
+static void APIENTRY TracedBindVertexArray(GLuint vao) {
+    CountState(kCallBindVertexArray, 0, vao, 0);
+    sRealBindVertexArray(vao);
+}
+
+static void APIENTRY TracedBindBuffer(GLenum target, GLuint buffer) {
+    CountState(kCallBindBuffer, target, buffer, 0);
+    sRealBindBuffer(target, buffer);
+}
+
+static void APIENTRY TracedBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    CountState(kCallBindBufferRange, target, ((unsigned long long)index << 24) | buffer, (unsigned long long)offset);
+    sRealBindBufferRange(target, index, buffer, offset, size);
+}
+
+static void APIENTRY TracedActiveTexture(GLenum unit) {
+    CountState(kCallActiveTexture, unit, unit - GL_TEXTURE0, 0);
+    sRealActiveTexture(unit);
+}
+
+static void APIENTRY TracedBindTexture(GLenum target, GLuint texture) {
+    CountState(kCallBindTexture, target, texture, 0);
+    sRealBindTexture(target, texture);
+}
+
+static void APIENTRY TracedBindFramebuffer(GLenum target, GLuint framebuffer) {
+    CountState(kCallBindFramebuffer, target, framebuffer, 0);
+    sRealBindFramebuffer(target, framebuffer);
+}
+
+static void APIENTRY TracedTexBuffer(GLenum target, GLenum internalFormat, GLuint buffer) {
+    CountState(kCallTexBuffer, internalFormat, buffer, 0);
+    sRealTexBuffer(target, internalFormat, buffer);
+}
+
+static void APIENTRY TracedEnable(GLenum capability) {
+    CountState(kCallEnable, capability, 0, 0);
+    sRealEnable(capability);
+}
+
+static void APIENTRY TracedDisable(GLenum capability) {
+    CountState(kCallDisable, capability, 0, 0);
+    sRealDisable(capability);
+}
+
+static void APIENTRY TracedDepthFunc(GLenum func) {
+    CountState(kCallDepthFunc, func, 0, 0);
+    sRealDepthFunc(func);
+}
+
+static void APIENTRY TracedDepthMask(GLboolean flag) {
+    CountState(kCallDepthMask, 0, flag, 0);
+    sRealDepthMask(flag);
+}
+
+static void APIENTRY TracedColorMask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+    CountState(kCallColorMask, 0, (r << 3) | (g << 2) | (b << 1) | a, 0);
+    sRealColorMask(r, g, b, a);
+}
+
+static void APIENTRY TracedBlendFunc(GLenum src, GLenum dst) {
+    CountState(kCallBlendFunc, src, dst, 0);
+    sRealBlendFunc(src, dst);
+}
+
+static void APIENTRY TracedPolygonMode(GLenum face, GLenum mode) {
+    CountState(kCallPolygonMode, mode, face, 0);
+    sRealPolygonMode(face, mode);
+}
+
+static void APIENTRY TracedLineWidth(GLfloat width) {
+    CountState(kCallLineWidth, 0, (unsigned long long)(width * 256.0f), 0);
+    sRealLineWidth(width);
+}
+
+static void APIENTRY TracedViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    CountState(kCallViewport, 0, (unsigned int)width, (unsigned int)height);
+    sRealViewport(x, y, width, height);
+}
+
+static void APIENTRY TracedCullFace(GLenum mode) {
+    CountState(kCallCullFace, mode, 0, 0);
+    sRealCullFace(mode);
+}
+
+// Uniforms (sueltos; los bloques van por BindBufferRange)
+static void APIENTRY TracedUniform1i(GLint location, GLint v0) {
+    CountUniform(kCallUniform1i, location, 1);
+    sRealUniform1i(location, v0);
+}
+
+static void APIENTRY TracedUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+    CountUniform(kCallUniform2f, location, 1);
+    sRealUniform2f(location, v0, v1);
+}
+
+static void APIENTRY TracedUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
+    CountUniform(kCallUniform3i, location, 1);
+    sRealUniform3i(location, v0, v1, v2);
+}
+
+static void APIENTRY TracedUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+    CountUniform(kCallUniform3fv, location, count);
+    sRealUniform3fv(location, count, value);
+}
+
+static void APIENTRY TracedUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+    CountUniform(kCallUniform4fv, location, count);
+    sRealUniform4fv(location, count, value);
+}
+
+static void APIENTRY TracedUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    CountUniform(kCallUniformMatrix4fv, location, count);
+    sRealUniformMatrix4fv(location, count, transpose, value);
+}
+
+// Subidas
+static void APIENTRY TracedBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    // Sin datos es reservar (u orfanar): no se transfiere nada
+    if (data) {
+        sFrame.bufferUploads++;
+        sFrame.bufferBytes += (unsigned long long)size;
+    }
+    Record(kCallBufferData, target, (unsigned long long)size, data ? 1 : 0);
+    sRealBufferData(target, size, data, usage);
+}
+
+static void APIENTRY TracedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    sFrame.bufferUploads++;
+    sFrame.bufferBytes += (unsigned long long)size;
+    Record(kCallBufferSubData, target, (unsigned long long)size, (unsigned long long)offset);
+    sRealBufferSubData(target, offset, size, data);
+}
+
+static void* APIENTRY TracedMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    // Un mapeo de escritura cuenta como subida del rango completo
+    if (access & GL_MAP_WRITE_BIT) {
+        sFrame.bufferUploads++;
+        sFrame.bufferBytes += (unsigned long long)length;
+    }
+    Record(kCallMapBufferRange, target, (unsigned long long)length, access);
+    return sRealMapBufferRange(target, offset, length, access);
+}
+
+static void APIENTRY TracedTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const void* pixels) {
+    CountTexture(kCallTexImage2D, format, type, width, height, 1, pixels, level);
+    sRealTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+static void APIENTRY TracedTexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+    GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels) {
+    CountTexture(kCallTexImage3D, format, type, width, height, depth, pixels, level);
+    sRealTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+}
+
+static void APIENTRY TracedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z,
+    GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels) {
+    CountTexture(kCallTexSubImage3D, format, type, width, height, depth, pixels, level);
+    sRealTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+}
+
+void GLTrace::Install() {
+    if (sInstalled) return;
+    // Las que el driver no exporte se quedan como estan
+#define GLTRACE_INSTALL(name, upper) \
+    if (glad_gl##name) { \
+        sReal##name = glad_gl##name; \
+        glad_gl##name = Traced##name; \
+    }
+    GLTRACE_FUNCTIONS(GLTRACE_INSTALL)
+#undef GLTRACE_INSTALL
+    sInstalled = true;
+    sFrame = GLCallCounters();
+    std::cout << "GL instrumentation: ON" << std::endl;
+}
+
+void GLTrace::Uninstall() {
+    if (!sInstalled) return;
+    StopCapture();
+#define GLTRACE_UNINSTALL(name, upper) \
+    if (sReal##name) { \
+        glad_gl##name = sReal##name; \
+        sReal##name = nullptr; \
+    }
+    GLTRACE_FUNCTIONS(GLTRACE_UNINSTALL)
+#undef GLTRACE_UNINSTALL
+    sInstalled = false;
+    sFrame = GLCallCounters();
+    sLastFrame = GLCallCounters();
+    std::cout << "GL instrumentation: OFF" << std::endl;
+}
+
+bool GLTrace::IsInstalled() {
+    return sInstalled;
+}
+
+void GLTrace::BeginFrame() {
+    if (!sInstalled) return;
+    if (sCapturing) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - sCaptureStart).count();
+        Record(kCallFrame, 0, sCaptureFrames++, (unsigned long long)us);
+    }
+    sLastFrame = sFrame;
+    sFrame = GLCallCounters();
+}
+
+const GLCallCounters& GLTrace::GetLastFrame() {
+    return sLastFrame;
+}
+
+bool GLTrace::StartCapture(const std::string& path, size_t maxBytes) {
+    if (sCapturing) return true;
+    Install();
+    sCapturePath = path;
+    sMaxRecords = maxBytes / sizeof(TraceRecord);
+    sRecords.clear();
+    sRecords.reserve(sMaxRecords);
+    sDropped = 0;
+    sCaptureFrames = 0;
+    sCaptureStart = std::chrono::steady_clock::now();
+    sCapturing = true;
+    std::cout << "GL trace: capturing to " << path << " (up to " << (maxBytes >> 20) << " MB)" << std::endl;
+    return true;
+}
+
+void GLTrace::StopCapture() {
+    if (!sCapturing) return;
+    sCapturing = false;
+
+    std::ofstream file(sCapturePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "GL trace: cannot write " << sCapturePath << std::endl;
+    }
+    else {
+        const uint32_t recordSize = sizeof(TraceRecord);
+        const uint32_t nameCount = kCallCount;
+        const uint64_t recordCount = sRecords.size();
+        file.write("MTRC", 4);
+        file.write((const char*)&kTraceVersion, sizeof(kTraceVersion));
+        file.write((const char*)&recordSize, sizeof(recordSize));
+        file.write((const char*)&nameCount, sizeof(nameCount));
+        for (const char* name : kCallNames) {
+            file.write(name, std::char_traits<char>::length(name) + 1);
+        }
+        file.write((const char*)&recordCount, sizeof(recordCount));
+        file.write((const char*)sRecords.data(), (std::streamsize)(sRecords.size() * sizeof(TraceRecord)));
+        std::cout << "GL trace: " << sRecords.size() << " calls over " << sCaptureFrames << " frames written to "
+            << sCapturePath;
+        if (sDropped > 0) std::cout << " (" << sDropped << " dropped, buffer full)";
+        std::cout << std::endl;
+    }
+
+    sRecords.clear();
+    sRecords.shrink_to_fit();
+}
+
+bool GLTrace::IsCapturing() {
+    return sCapturing;
+}
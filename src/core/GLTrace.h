@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Llamadas a GL de un frame, contadas por GLTrace
+struct GLCallCounters {
+    unsigned long long calls = 0;           // todas las envueltas
+    unsigned long long drawCalls = 0;
+    unsigned long long triangles = 0;
+    unsigned long long instances = 0;       // suma de instancias de los draws
+    unsigned long long stateChanges = 0;    // binds, enable/disable, raster, viewport, FBO
+    unsigned long long uniformUpdates = 0;
+    unsigned long long bufferUploads = 0;
+    unsigned long long bufferBytes = 0;
+    unsigned long long textureUploads = 0;
+    unsigned long long textureBytes = 0;
+};
+
+// Instrumentacion opcional de GL. Install cambia los punteros de glad de
+// las llamadas que interesan (draws, estado, uniforms y subidas) por
+// envoltorios que suman en los contadores del frame y, con una captura
+// abierta, guardan cada llamada en una traza binaria. Sin instalar no
+// cuesta nada: las llamadas van directas al driver. Las escrituras en
+// buffers mapeados de forma persistente (RingBuffer) no pasan por GL y no
+// se ven aqui.
+//
+// Traza: "MTRC", version, tamano de registro, numero de nombres y los
+// nombres de las llamadas (terminados en 0), numero de registros y los
+// registros de 12 bytes { uint16 llamada, uint16 enum, uint32 a, uint32 b }.
+// La llamada 0 es "Frame": a = numero de frame, b = microsegundos desde el
+// inicio de la captura.
+class GLTrace {
+public:
+    static void Install();
+    static void Uninstall();
+    static bool IsInstalled();
+
+    // Cierra el frame en curso (GetLastFrame) y empieza otro
+    static void BeginFrame();
+    static const GLCallCounters& GetLastFrame();
+
+    // Graba en memoria hasta maxBytes de registros; StopCapture los escribe
+    // en 'path'. Instala los envoltorios si no lo estaban.
+    static bool StartCapture(const std::string& path, size_t maxBytes);
+    static void StopCapture();
+    static bool IsCapturing();
+};
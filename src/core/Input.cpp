@@ -2,59 +2,76 @@
 #include <cstring>
 #include <iostream>
 
-bool Input::sKeysDown[MAX_KEYS];
-bool Input::sKeysPressed[MAX_KEYS];
-bool Input::sKeysPrevious[MAX_KEYS];
+std::bitset<SDL_SCANCODE_COUNT> Input::sKeysDown;
+std::bitset<SDL_SCANCODE_COUNT> Input::sKeysPressed;
 
-bool Input::sMouseButtons[5];
+bool Input::sMouseButtons[MAX_MOUSE_BUTTONS];
+bool Input::sMouseButtonsPressed[MAX_MOUSE_BUTTONS];
 int Input::sMouseX = 0;
 int Input::sMouseY = 0;
-int Input::sMouseDX = 0;
-int Input::sMouseDY = 0;
+float Input::sMouseDX = 0.0f;
+float Input::sMouseDY = 0.0f;
 float Input::sMouseWheel = 0.0f;
 bool Input::sRelativeMouseMode = false;
 
+std::vector<InputEvent> Input::sEvents;
+
 void Input::Init() {
-    std::memset(sKeysDown, 0, sizeof(sKeysDown));
-    std::memset(sKeysPressed, 0, sizeof(sKeysPressed));
-    std::memset(sKeysPrevious, 0, sizeof(sKeysPrevious));
+    sKeysDown.reset();
+    sKeysPressed.reset();
     std::memset(sMouseButtons, 0, sizeof(sMouseButtons));
+    std::memset(sMouseButtonsPressed, 0, sizeof(sMouseButtonsPressed));
+    sEvents.clear();
+    sEvents.reserve(256);
 }
 
 void Input::Update() {
-    // Actualizar estado de teclas para detectar "pressed"
-    for (int i = 0; i < MAX_KEYS; ++i) {
-        sKeysPressed[i] = sKeysDown[i] && !sKeysPrevious[i];
-        sKeysPrevious[i] = sKeysDown[i];
-    }
+    // Inicio de frame: limpiar lo que solo vale para un frame
+    sKeysPressed.reset();
+    std::memset(sMouseButtonsPressed, 0, sizeof(sMouseButtonsPressed));
+    sEvents.clear();
 
     // Reset deltas
-    sMouseDX = 0;
-    sMouseDY = 0;
+    sMouseDX = 0.0f;
+    sMouseDY = 0.0f;
     sMouseWheel = 0.0f;
 }
 
 void Input::ProcessEvent(const SDL_Event& e) {
+    InputEvent ev;
+    ev.timestampNs = e.common.timestamp;
+    ev.type = e.type;
+
     switch (e.type) {
     case SDL_EVENT_KEY_DOWN: {
-        int code = (int)e.key.key;
-        if (code >= 0 && code < MAX_KEYS) {
+        SDL_Scancode code = e.key.scancode;
+        if (code > SDL_SCANCODE_UNKNOWN && code < SDL_SCANCODE_COUNT) {
+            // "Pressed" se marca por evento: una pulsacin corta dentro
+            // del mismo frame no se pierde
+            if (!e.key.repeat && !sKeysDown[code]) {
+                sKeysPressed[code] = true;
+            }
             sKeysDown[code] = true;
         }
+        ev.scancode = code;
+        sEvents.push_back(ev);
         break;
     }
 
     case SDL_EVENT_KEY_UP: {
-        int code = (int)e.key.key;
-        if (code >= 0 && code < MAX_KEYS) {
+        SDL_Scancode code = e.key.scancode;
+        if (code > SDL_SCANCODE_UNKNOWN && code < SDL_SCANCODE_COUNT) {
             sKeysDown[code] = false;
         }
+        ev.scancode = code;
+        sEvents.push_back(ev);
         break;
     }
 
     case SDL_EVENT_MOUSE_BUTTON_DOWN: {
-        if (e.button.button < 5) {
+        if (e.button.button < MAX_MOUSE_BUTTONS) {
             sMouseButtons[e.button.button] = true;
+            sMouseButtonsPressed[e.button.button] = true;
 
             // Clic derecho activa modo cmara
             if (e.button.button == SDL_BUTTON_RIGHT) {
@@ -63,11 +80,14 @@ void Input::ProcessEvent(const SDL_Event& e) {
                 std::cout << "Camera control: ENABLED (Right mouse button)" << std::endl;
             }
         }
+        ev.x = e.button.x;
+        ev.y = e.button.y;
+        sEvents.push_back(ev);
         break;
     }
 
     case SDL_EVENT_MOUSE_BUTTON_UP: {
-        if (e.button.button < 5) {
+        if (e.button.button < MAX_MOUSE_BUTTONS) {
             sMouseButtons[e.button.button] = false;
 
             // Soltar clic derecho desactiva modo cmara
@@ -77,53 +97,75 @@ void Input::ProcessEvent(const SDL_Event& e) {
                 std::cout << "Camera control: DISABLED" << std::endl;
             }
         }
+        ev.x = e.button.x;
+        ev.y = e.button.y;
+        sEvents.push_back(ev);
         break;
     }
 
     case SDL_EVENT_MOUSE_MOTION: {
         sMouseX = (int)e.motion.x;
         sMouseY = (int)e.motion.y;
-        sMouseDX += (int)e.motion.xrel;
-        sMouseDY += (int)e.motion.yrel;
+        sMouseDX += e.motion.xrel;
+        sMouseDY += e.motion.yrel;
+        ev.x = e.motion.xrel;
+        ev.y = e.motion.yrel;
+        sEvents.push_back(ev);
         break;
     }
 
     case SDL_EVENT_MOUSE_WHEEL: {
-        sMouseWheel = e.wheel.y;
+        sMouseWheel += e.wheel.y;
+        ev.x = e.wheel.x;
+        ev.y = e.wheel.y;
+        sEvents.push_back(ev);
         break;
     }
     }
 }
 
-bool Input::IsKeyDown(SDL_Keycode key) {
-    int code = (int)key;
-    if (code >= 0 && code < MAX_KEYS) {
-        return sKeysDown[code];
+bool Input::IsKeyDown(SDL_Scancode key) {
+    if (key > SDL_SCANCODE_UNKNOWN && key < SDL_SCANCODE_COUNT) {
+        return sKeysDown[key];
     }
     return false;
 }
 
-bool Input::IsKeyPressed(SDL_Keycode key) {
-    int code = (int)key;
-    if (code >= 0 && code < MAX_KEYS) {
-        return sKeysPressed[code];
+bool Input::IsKeyPressed(SDL_Scancode key) {
+    if (key > SDL_SCANCODE_UNKNOWN && key < SDL_SCANCODE_COUNT) {
+        return sKeysPressed[key];
     }
     return false;
 }
 
+bool Input::IsKeyDown(SDL_Keycode key) {
+    return IsKeyDown(SDL_GetScancodeFromKey(key, nullptr));
+}
+
+bool Input::IsKeyPressed(SDL_Keycode key) {
+    return IsKeyPressed(SDL_GetScancodeFromKey(key, nullptr));
+}
+
 bool Input::IsMouseButtonDown(int button) {
-    if (button >= 0 && button < 5) {
+    if (button >= 0 && button < MAX_MOUSE_BUTTONS) {
         return sMouseButtons[button];
     }
     return false;
 }
 
+bool Input::IsMouseButtonPressed(int button) {
+    if (button >= 0 && button < MAX_MOUSE_BUTTONS) {
+        return sMouseButtonsPressed[button];
+    }
+    return false;
+}
+
 void Input::GetMousePosition(int& x, int& y) {
     x = sMouseX;
     y = sMouseY;
 }
 
-void Input::GetMouseDelta(int& dx, int& dy) {
+void Input::GetMouseDelta(float& dx, float& dy) {
     dx = sMouseDX;
     dy = sMouseDY;
 }
@@ -132,6 +174,29 @@ float Input::GetMouseWheelDelta() {
     return sMouseWheel;
 }
 
+void Input::ConsumeMouseDelta(float& dx, float& dy) {
+    dx = sMouseDX;
+    dy = sMouseDY;
+    sMouseDX = 0.0f;
+    sMouseDY = 0.0f;
+}
+
+float Input::ConsumeMouseWheelDelta() {
+    float wheel = sMouseWheel;
+    sMouseWheel = 0.0f;
+    return wheel;
+}
+
+Uint64 Input::GetOldestEventTimestamp() {
+    Uint64 oldest = 0;
+    for (const InputEvent& ev : sEvents) {
+        if (ev.timestampNs && (oldest == 0 || ev.timestampNs < oldest)) {
+            oldest = ev.timestampNs;
+        }
+    }
+    return oldest;
+}
+
 bool Input::IsCameraControlActive() {
     return sRelativeMouseMode;
 }
\ No newline at end of file
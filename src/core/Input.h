@@ -1,5 +1,15 @@
 #pragma once
 #include <SDL3/SDL.h>
+#include <bitset>
+#include <vector>
+
+// Evento de entrada con su marca de tiempo de SDL (ns, base SDL_GetTicksNS)
+struct InputEvent {
+    Uint64 timestampNs = 0;
+    Uint32 type = 0;
+    SDL_Scancode scancode = SDL_SCANCODE_UNKNOWN;
+    float x = 0.0f, y = 0.0f;
+};
 
 class Input {
 public:
@@ -7,29 +17,42 @@ public:
     static void Update();
     static void ProcessEvent(const SDL_Event& e);
 
-    // Teclado
+    // Teclado: por scancode (posicin fsica, independiente del layout)
+    static bool IsKeyDown(SDL_Scancode key);
+    static bool IsKeyPressed(SDL_Scancode key);
+    // Por keycode: se traduce al scancode del layout actual
     static bool IsKeyDown(SDL_Keycode key);
     static bool IsKeyPressed(SDL_Keycode key);
 
     // Ratn
     static bool IsMouseButtonDown(int button);
+    static bool IsMouseButtonPressed(int button);   // solo el frame del clic
     static void GetMousePosition(int& x, int& y);
-    static void GetMouseDelta(int& dx, int& dy);
+    static void GetMouseDelta(float& dx, float& dy);
     static float GetMouseWheelDelta();
+    // Devuelven lo acumulado desde la ltima consulta y lo ponen a cero
+    static void ConsumeMouseDelta(float& dx, float& dy);
+    static float ConsumeMouseWheelDelta();
+
+    // Eventos del frame actual, en orden de llegada
+    static const std::vector<InputEvent>& GetEvents() { return sEvents; }
+    static Uint64 GetOldestEventTimestamp();
 
     // Estado de la cmara
     static bool IsCameraControlActive();
 
 private:
-    static const int MAX_KEYS = 512;
-    static bool sKeysDown[MAX_KEYS];
-    static bool sKeysPressed[MAX_KEYS];
-    static bool sKeysPrevious[MAX_KEYS];
+    static std::bitset<SDL_SCANCODE_COUNT> sKeysDown;
+    static std::bitset<SDL_SCANCODE_COUNT> sKeysPressed;
 
-    static bool sMouseButtons[5];
+    static const int MAX_MOUSE_BUTTONS = 8;
+    static bool sMouseButtons[MAX_MOUSE_BUTTONS];
+    static bool sMouseButtonsPressed[MAX_MOUSE_BUTTONS];
     static int sMouseX, sMouseY;
-    static int sMouseDX, sMouseDY;
+    static float sMouseDX, sMouseDY;
     static float sMouseWheel;
     static bool sRelativeMouseMode;
+
+    static std::vector<InputEvent> sEvents;
 }; 
 
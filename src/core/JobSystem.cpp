@@ -0,0 +1,385 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+struct Job {
+    std::function<void()> function;
+    JobCounter* counter = nullptr;
+};
+
+// Deque Chase-Lev de capacidad fija: el propietario hace Push/Pop por abajo,
+// los ladrones hacen Steal por arriba con CAS.
+class WorkStealingQueue {
+public:
+    bool Push(Job* job) {
+        int64_t b = mBottom.load(std::memory_order_relaxed);
+        int64_t t = mTop.load(std::memory_order_acquire);
+        if (b - t >= kCapacity) return false;
+
+        mJobs[b & kMask].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* Pop() {
+        int64_t b = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = mTop.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            mBottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = mJobs[b & kMask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Ultimo elemento: competir con los ladrones
+            if (!mTop.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            mBottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* Steal() {
+        int64_t t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = mBottom.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Job* job = mJobs[t & kMask].load(std::memory_order_relaxed);
+        if (!mTop.compare_exchange_strong(t, t + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+private:
+    static const int64_t kCapacity = 4096;
+    static const int64_t kMask = kCapacity - 1;
+
+    std::atomic<int64_t> mTop{ 0 };
+    std::atomic<int64_t> mBottom{ 0 };
+    std::atomic<Job*> mJobs[kCapacity];
+};
+
+struct WorkerState {
+    WorkStealingQueue queue;
+    std::atomic<uint64_t> jobsExecuted{ 0 };
+    std::atomic<uint64_t> jobsStolen{ 0 };
+    std::atomic<uint64_t> busyNs{ 0 };
+};
+
+unsigned int JobSystem::sWorkerCount = 0;
+std::atomic<unsigned int> JobSystem::sActiveWorkers{ 0 };
+
+static std::vector<std::unique_ptr<WorkerState>> sWorkers;
+static std::vector<std::thread> sThreads;
+static thread_local int tWorkerIndex = -1;
+
+// Cola para jobs lanzados desde hilos que no son workers
+static std::mutex sGlobalMutex;
+static std::deque<Job*> sGlobalQueue;
+
+static std::mutex sSleepMutex;
+static std::condition_variable sWakeCondition;
+static std::atomic<int> sQueuedJobs{ 0 };
+static std::atomic<bool> sRunning{ false };
+
+static std::chrono::steady_clock::time_point sStatsStart;
+
+static uint64_t NowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void JobSystem::Init(unsigned int workerCount) {
+    if (!sWorkers.empty()) return;
+
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    sWorkerCount = workerCount;
+    sActiveWorkers = workerCount;
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        sWorkers.push_back(std::make_unique<WorkerState>());
+    }
+
+    sRunning = true;
+    tWorkerIndex = 0;
+    for (unsigned int i = 1; i < workerCount; ++i) {
+        sThreads.emplace_back(WorkerMain, i);
+    }
+
+    ResetStats();
+    std::cout << "JobSystem initialized with " << workerCount << " workers\n";
+}
+
+void JobSystem::Shutdown() {
+    if (sWorkers.empty()) return;
+
+    sRunning = false;
+    sWakeCondition.notify_all();
+    for (auto& thread : sThreads) {
+        thread.join();
+    }
+    sThreads.clear();
+
+    // Ejecutar lo que quede para no perder contadores
+    bool stolen = false;
+    while (Job* job = FindJob(0, stolen)) {
+        Execute(job, 0);
+    }
+
+    sWorkers.clear();
+    sWorkerCount = 0;
+    sActiveWorkers = 0;
+    tWorkerIndex = -1;
+}
+
+void JobSystem::AcquireWorker0() {
+    if (!sWorkers.empty()) tWorkerIndex = 0;
+}
+
+void JobSystem::ReleaseWorker0() {
+    if (tWorkerIndex == 0) tWorkerIndex = -1;
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter, JobCounter* dependency) {
+    Job* job = new Job();
+    job->function = std::move(function);
+    job->counter = counter;
+
+    if (counter) {
+        counter->mValue.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    if (dependency) {
+        std::lock_guard<std::mutex> lock(dependency->mMutex);
+        if (dependency->Get() > 0) {
+            dependency->mWaiting.push_back(job);
+            return;
+        }
+    }
+
+    Enqueue(job);
+}
+
+void JobSystem::Enqueue(Job* job) {
+    // Sin pool: ejecutar en el hilo actual
+    if (sWorkers.empty()) {
+        Execute(job, -1);
+        return;
+    }
+
+    int index = tWorkerIndex;
+    if (index < 0 || !sWorkers[index]->queue.Push(job)) {
+        std::lock_guard<std::mutex> lock(sGlobalMutex);
+        sGlobalQueue.push_back(job);
+    }
+
+    sQueuedJobs.fetch_add(1, std::memory_order_release);
+    sWakeCondition.notify_one();
+}
+
+Job* JobSystem::FindJob(int index, bool& stolen) {
+    stolen = false;
+    Job* job = nullptr;
+
+    if (index >= 0) {
+        job = sWorkers[index]->queue.Pop();
+    }
+
+    if (!job) {
+        std::lock_guard<std::mutex> lock(sGlobalMutex);
+        if (!sGlobalQueue.empty()) {
+            job = sGlobalQueue.front();
+            sGlobalQueue.pop_front();
+        }
+    }
+
+    if (!job) {
+        // Robar del resto de workers, empezando por el siguiente
+        unsigned int count = (unsigned int)sWorkers.size();
+        unsigned int start = index >= 0 ? (unsigned int)index : 0;
+        for (unsigned int k = 1; k <= count && !job; ++k) {
+            unsigned int victim = (start + k) % count;
+            if ((int)victim == index) continue;
+            job = sWorkers[victim]->queue.Steal();
+        }
+        stolen = job != nullptr;
+    }
+
+    if (job) {
+        sQueuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    return job;
+}
+
+void JobSystem::Execute(Job* job, int index) {
+    uint64_t start = NowNs();
+    job->function();
+    uint64_t elapsed = NowNs() - start;
+
+    if (index >= 0 && index < (int)sWorkers.size()) {
+        sWorkers[index]->jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+        sWorkers[index]->busyNs.fetch_add(elapsed, std::memory_order_relaxed);
+    }
+
+    Finish(job->counter);
+    delete job;
+}
+
+void JobSystem::Finish(JobCounter* counter) {
+    if (!counter) return;
+
+    int value = counter->mValue.load(std::memory_order_acquire);
+    while (value > 1) {
+        if (counter->mValue.compare_exchange_weak(value, value - 1,
+            std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return;
+        }
+    }
+
+    // El ultimo decremento se hace con el mutex tomado: Wait() lo adquiere
+    // antes de volver, asi el contador no se destruye mientras se usa aqui
+    std::vector<Job*> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mMutex);
+        if (counter->mValue.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        ready.swap(counter->mWaiting);
+    }
+    for (Job* job : ready) {
+        Enqueue(job);
+    }
+}
+
+void JobSystem::Wait(JobCounter* counter) {
+    if (!counter) return;
+
+    int index = tWorkerIndex;
+    while (counter->Get() > 0) {
+        bool stolen = false;
+        Job* job = sWorkers.empty() ? nullptr : FindJob(index, stolen);
+        if (job) {
+            if (stolen && index >= 0) {
+                sWorkers[index]->jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            Execute(job, index);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(counter->mMutex);
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain,
+    const std::function<void(size_t begin, size_t end)>& function) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    if (count <= grain || sWorkers.empty()) {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += grain) {
+        size_t end = std::min(count, begin + grain);
+        Run([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+    Wait(&counter);
+}
+
+void JobSystem::WorkerMain(unsigned int index) {
+    tWorkerIndex = (int)index;
+    int idleSpins = 0;
+
+    while (sRunning.load(std::memory_order_acquire)) {
+        bool active = index < sActiveWorkers.load(std::memory_order_relaxed);
+
+        bool stolen = false;
+        Job* job = active ? FindJob((int)index, stolen) : nullptr;
+        if (job) {
+            if (stolen) {
+                sWorkers[index]->jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            Execute(job, (int)index);
+            idleSpins = 0;
+            continue;
+        }
+
+        // Spin corto antes de dormir para no pagar el despertar en rafagas
+        if (active && ++idleSpins < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+        idleSpins = 0;
+
+        std::unique_lock<std::mutex> lock(sSleepMutex);
+        sWakeCondition.wait_for(lock, std::chrono::milliseconds(1), [index]() {
+            return !sRunning.load() ||
+                (sQueuedJobs.load() > 0 && index < sActiveWorkers.load());
+        });
+    }
+}
+
+void JobSystem::SetActiveWorkerCount(unsigned int count) {
+    if (sWorkerCount == 0) return;
+    count = std::max(1u, std::min(count, sWorkerCount));
+    sActiveWorkers = count;
+    sWakeCondition.notify_all();
+}
+
+void JobSystem::GetWorkerStats(std::vector<WorkerStats>& out) {
+    out.clear();
+    uint64_t wall = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - sStatsStart).count();
+
+    for (const auto& worker : sWorkers) {
+        WorkerStats stats;
+        stats.jobsExecuted = worker->jobsExecuted.load();
+        stats.jobsStolen = worker->jobsStolen.load();
+        stats.busyNs = worker->busyNs.load();
+        stats.wallNs = wall;
+        out.push_back(stats);
+    }
+}
+
+void JobSystem::ResetStats() {
+    for (auto& worker : sWorkers) {
+        worker->jobsExecuted = 0;
+        worker->jobsStolen = 0;
+        worker->busyNs = 0;
+    }
+    sStatsStart = std::chrono::steady_clock::now();
+}
+
+void JobSystem::PrintStats() {
+    std::vector<WorkerStats> stats;
+    GetWorkerStats(stats);
+
+    std::cout << "=== JobSystem stats (" << stats.size() << " workers, "
+        << sActiveWorkers.load() << " active) ===" << std::endl;
+    for (size_t i = 0; i < stats.size(); ++i) {
+        double busyMs = stats[i].busyNs / 1.0e6;
+        double utilisation = stats[i].wallNs ? 100.0 * stats[i].busyNs / stats[i].wallNs : 0.0;
+        std::cout << "  Worker " << i << ": jobs " << stats[i].jobsExecuted
+            << ", stolen " << stats[i].jobsStolen
+            << ", busy " << busyMs << " ms"
+            << ", utilisation " << utilisation << "%" << std::endl;
+    }
+}
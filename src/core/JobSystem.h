@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+struct Job;
+
+// Cuenta los jobs pendientes de un grupo. Los jobs que dependen de un
+// contador no se encolan hasta que llega a cero.
+class JobCounter {
+public:
+    int Get() const { return mValue.load(std::memory_order_acquire); }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> mValue{ 0 };
+    std::mutex mMutex;
+    std::vector<Job*> mWaiting;
+};
+
+struct WorkerStats {
+    uint64_t jobsExecuted = 0;
+    uint64_t jobsStolen = 0;
+    uint64_t busyNs = 0;
+    uint64_t wallNs = 0;
+};
+
+// Pool fijo de hilos con una deque lock-free (Chase-Lev) por worker.
+// El worker 0 no tiene hilo propio: es el hilo que lanza el trabajo (el que
+// llama a Init() o, con hilo de render, el de render) y ejecuta jobs
+// mientras espera en Wait().
+class JobSystem {
+public:
+    static void Init(unsigned int workerCount = 0);
+    static void Shutdown();
+
+    // Pasa el worker 0 a otro hilo: Release en el que lo tiene y Acquire en
+    // el nuevo, con una sincronizacion entre medias (crear o esperar al hilo)
+    static void AcquireWorker0();
+    static void ReleaseWorker0();
+
+    static void Run(std::function<void()> function, JobCounter* counter = nullptr,
+        JobCounter* dependency = nullptr);
+    static void Wait(JobCounter* counter);
+
+    // Divide [0, count) en rangos de 'grain' elementos y espera a que terminen
+    static void ParallelFor(size_t count, size_t grain,
+        const std::function<void(size_t begin, size_t end)>& function);
+
+    static unsigned int GetWorkerCount() { return sWorkerCount; }
+
+    // Limita los workers que aceptan trabajo (para medir escalado)
+    static void SetActiveWorkerCount(unsigned int count);
+    static unsigned int GetActiveWorkerCount() { return sActiveWorkers.load(); }
+
+    static void GetWorkerStats(std::vector<WorkerStats>& out);
+    static void ResetStats();
+    static void PrintStats();
+
+private:
+    static unsigned int sWorkerCount;
+    static std::atomic<unsigned int> sActiveWorkers;
+
+    static void WorkerMain(unsigned int index);
+    static Job* FindJob(int index, bool& stolen);
+    static void Execute(Job* job, int index);
+    static void Enqueue(Job* job);
+    static void Finish(JobCounter* counter);
+};
@@ -0,0 +1,135 @@
+#include "MemoryArena.h"
+
+#include <algorithm>
+#include <new>
+
+LinearArena::LinearArena(size_t chunkSize, size_t maxRetained, MemoryCategory category)
+    : mChunkSize(std::max<size_t>(chunkSize, 4096)), mMaxRetained(maxRetained), mCategory(category),
+      mUsedBytes(0), mReservedBytes(0), mPeakBytes(0), mAllocations(0), mChunkAllocations(0) {
+}
+
+LinearArena::~LinearArena() {
+    Release();
+}
+
+void LinearArena::AddChunk(size_t size) {
+    Chunk chunk;
+    chunk.data = static_cast<char*>(::operator new(size));
+    chunk.size = size;
+    chunk.used = 0;
+    mChunks.push_back(chunk);
+    mReservedBytes += size;
+    mChunkAllocations++;
+    MemoryTracker::Allocate(mCategory, size);
+}
+
+void LinearArena::FreeChunks() {
+    for (const Chunk& chunk : mChunks) {
+        ::operator delete(chunk.data);
+        MemoryTracker::Free(mCategory, chunk.size);
+    }
+    mChunks.clear();
+    mReservedBytes = 0;
+}
+
+void* LinearArena::Allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // El bloque activo o uno nuevo; las reservas grandes llevan su propio bloque
+    uintptr_t aligned = 0;
+    if (!mChunks.empty()) {
+        Chunk& chunk = mChunks.back();
+        uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+        aligned = (base + chunk.used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (aligned + bytes > base + chunk.size) aligned = 0;
+    }
+    if (!aligned) {
+        AddChunk(std::max(mChunkSize, bytes + alignment));
+        uintptr_t base = reinterpret_cast<uintptr_t>(mChunks.back().data);
+        aligned = (base + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    Chunk& chunk = mChunks.back();
+    size_t end = (size_t)(aligned - reinterpret_cast<uintptr_t>(chunk.data)) + bytes;
+    mUsedBytes += end - chunk.used;
+    chunk.used = end;
+    mPeakBytes = std::max(mPeakBytes, mUsedBytes);
+    mAllocations++;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void LinearArena::Reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mChunks.size() > 1) {
+        // Un solo bloque con lo que hizo falta, si cabe en lo que se conserva
+        size_t merged = mReservedBytes <= mMaxRetained ? mReservedBytes : mChunkSize;
+        FreeChunks();
+        AddChunk(merged);
+    } else if (!mChunks.empty() && mChunks[0].size > std::max(mChunkSize, mMaxRetained)) {
+        FreeChunks();
+    }
+    for (Chunk& chunk : mChunks) chunk.used = 0;
+    mUsedBytes = 0;
+    mAllocations = 0;
+}
+
+void LinearArena::Release() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    FreeChunks();
+    mUsedBytes = 0;
+    mAllocations = 0;
+}
+
+size_t LinearArena::GetUsedBytes() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mUsedBytes;
+}
+
+size_t LinearArena::GetReservedBytes() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mReservedBytes;
+}
+
+size_t LinearArena::GetPeakBytes() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mPeakBytes;
+}
+
+uint64_t LinearArena::GetAllocationCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAllocations;
+}
+
+uint64_t LinearArena::GetChunkAllocations() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mChunkAllocations;
+}
+
+FrameAllocator::FrameAllocator(size_t chunkSize, size_t maxRetained)
+    : mFrameA(chunkSize, maxRetained, MemoryCategory::Transient),
+      mFrameB(chunkSize, maxRetained, MemoryCategory::Transient),
+      mCurrent(0), mLastFrameAllocations(0), mLastFrameBytes(0), mPeakFrameBytes(0) {
+    mArenas[0] = &mFrameA;
+    mArenas[1] = &mFrameB;
+}
+
+void FrameAllocator::BeginFrame() {
+    LinearArena& finished = *mArenas[mCurrent];
+    mLastFrameAllocations = finished.GetAllocationCount();
+    mLastFrameBytes = finished.GetUsedBytes();
+    mPeakFrameBytes = std::max(mPeakFrameBytes, mLastFrameBytes);
+
+    // La otra arena tiene lo del frame anterior al que acaba de terminar
+    mCurrent ^= 1;
+    mArenas[mCurrent]->Reset();
+}
+
+void FrameAllocator::Release() {
+    mFrameA.Release();
+    mFrameB.Release();
+}
+
+uint64_t FrameAllocator::GetChunkAllocations() const {
+    return mFrameA.GetChunkAllocations() + mFrameB.GetChunkAllocations();
+}
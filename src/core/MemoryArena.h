@@ -0,0 +1,140 @@
+#pragma once
+#include "MemoryTracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+// Arena lineal: reservas por desplazamiento dentro de bloques grandes, sin
+// liberacion individual. Todo se descarta de golpe con Reset(). Allocate es
+// seguro entre hilos (un mutex; se pide poco y en bloques grandes).
+class LinearArena {
+public:
+    // chunkSize: tamano de cada bloque; maxRetained: lo que Reset conserva
+    LinearArena(size_t chunkSize, size_t maxRetained, MemoryCategory category);
+    ~LinearArena();
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Invalida todo lo reservado. Si hubo varios bloques se funden en uno
+    // (hasta maxRetained) para que la siguiente pasada no vuelva a crecer.
+    void Reset();
+    // Devuelve todos los bloques al sistema
+    void Release();
+
+    size_t GetUsedBytes() const;
+    size_t GetReservedBytes() const;
+    size_t GetPeakBytes() const;
+    // Desde el ultimo Reset
+    uint64_t GetAllocationCount() const;
+    // Bloques pedidos al sistema desde la creacion
+    uint64_t GetChunkAllocations() const;
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+        size_t used;
+    };
+
+    mutable std::mutex mMutex;
+    std::vector<Chunk> mChunks;         // el ultimo es el activo
+    size_t mChunkSize;
+    size_t mMaxRetained;
+    MemoryCategory mCategory;
+    size_t mUsedBytes;
+    size_t mReservedBytes;
+    size_t mPeakBytes;
+    uint64_t mAllocations;
+    uint64_t mChunkAllocations;
+
+    void AddChunk(size_t size);
+    void FreeChunks();
+};
+
+// Adaptador para contenedores estandar. Sin arena usa el heap normal;
+// deallocate no hace nada con arena (la memoria vuelve en el Reset).
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator() : mArena(nullptr) {}
+    explicit ArenaAllocator(LinearArena* arena) : mArena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : mArena(other.GetArena()) {}
+
+    T* allocate(size_t count) {
+        if (mArena) return mArena->AllocateArray<T>(count);
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) {
+        if (!mArena) ::operator delete(p);
+    }
+
+    LinearArena* GetArena() const { return mArena; }
+
+private:
+    LinearArena* mArena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() == b.GetArena(); }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() != b.GetArena(); }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Reset al salir del ambito: declarar antes que los contenedores de la arena
+class ArenaScope {
+public:
+    explicit ArenaScope(LinearArena& arena) : mArena(arena) {}
+    ~ArenaScope() { mArena.Reset(); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    LinearArena& mArena;
+};
+
+// Dos arenas alternadas por frame: lo reservado en el frame N sigue siendo
+// valido durante el N+1 y se descarta al empezar el N+2.
+class FrameAllocator {
+public:
+    FrameAllocator(size_t chunkSize, size_t maxRetained);
+
+    void BeginFrame();
+    void Release();
+
+    LinearArena& GetArena() { return *mArenas[mCurrent]; }
+    template <typename T>
+    ArenaAllocator<T> GetAllocator() { return ArenaAllocator<T>(mArenas[mCurrent]); }
+    template <typename T>
+    T* AllocateArray(size_t count) { return mArenas[mCurrent]->AllocateArray<T>(count); }
+
+    // Del ultimo frame completo
+    uint64_t GetLastFrameAllocations() const { return mLastFrameAllocations; }
+    size_t GetLastFrameBytes() const { return mLastFrameBytes; }
+    size_t GetPeakFrameBytes() const { return mPeakFrameBytes; }
+    uint64_t GetChunkAllocations() const;
+
+private:
+    LinearArena mFrameA, mFrameB;
+    LinearArena* mArenas[2];
+    int mCurrent;
+    uint64_t mLastFrameAllocations;
+    size_t mLastFrameBytes;
+    size_t mPeakFrameBytes;
+};
@@ -0,0 +1,309 @@
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// Las extensiones no vienen en el loader de core profile
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#define GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX 0x904B
+#endif
+#ifndef GL_VBO_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI 0x87FB
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#define GL_RENDERBUFFER_FREE_MEMORY_ATI 0x87FD
+#endif
+
+std::mutex MemoryTracker::sMutex;
+MemoryCategoryStats MemoryTracker::sCategories[kMemoryCategoryCount];
+bool MemoryTracker::sOverBudget[kMemoryCategoryCount] = {};
+size_t MemoryTracker::sGpuPeak = 0;
+size_t MemoryTracker::sCpuPeak = 0;
+size_t MemoryTracker::sGpuBudget = 0;
+bool MemoryTracker::sGpuOverBudget = false;
+std::vector<ModelMemoryStats> MemoryTracker::sModels;
+int MemoryTracker::sActiveModel = -1;
+bool MemoryTracker::sHasNVX = false;
+bool MemoryTracker::sHasATI = false;
+
+static double ToMB(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+static bool HasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && std::strcmp(ext, name) == 0) return true;
+    }
+    return false;
+}
+
+void MemoryTracker::InitGPU() {
+    sHasNVX = HasExtension("GL_NVX_gpu_memory_info");
+    sHasATI = HasExtension("GL_ATI_meminfo");
+
+    DriverMemoryInfo info;
+    if (!QueryDriverMemory(info)) {
+        std::cout << "GPU memory info: not exposed by the driver (tracking requested sizes only)\n";
+        return;
+    }
+
+    // Presupuesto por defecto: 80% de lo que el driver dice tener
+    size_t baseKB = info.nvx ? (size_t)info.dedicatedKB : (size_t)info.textureFreeKB;
+    if (sGpuBudget == 0 && baseKB > 0) SetGpuBudget(baseKB * 1024 / 10 * 8);
+
+    if (info.nvx) {
+        std::cout << "GPU memory (NVX): " << info.dedicatedKB / 1024 << " MB dedicated, "
+            << info.currentAvailableKB / 1024 << " MB available\n";
+    } else {
+        std::cout << "GPU memory (ATI): " << info.textureFreeKB / 1024 << " MB free for textures, "
+            << info.vboFreeKB / 1024 << " MB free for buffers\n";
+    }
+    std::cout << "GPU memory budget: " << ToMB(sGpuBudget) << " MB\n";
+}
+
+bool MemoryTracker::QueryDriverMemory(DriverMemoryInfo& out) {
+    out = DriverMemoryInfo();
+    if (sHasNVX) {
+        out.nvx = true;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &out.dedicatedKB);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &out.totalAvailableKB);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &out.currentAvailableKB);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &out.evictedKB);
+    }
+    if (sHasATI) {
+        // Cada consulta devuelve 4 enteros; el primero es el total libre
+        GLint values[4] = {};
+        out.ati = true;
+        glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, values);
+        out.vboFreeKB = values[0];
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, values);
+        out.textureFreeKB = values[0];
+        glGetIntegerv(GL_RENDERBUFFER_FREE_MEMORY_ATI, values);
+        out.renderbufferFreeKB = values[0];
+    }
+    return out.nvx || out.ati;
+}
+
+bool MemoryTracker::IsGpuCategory(MemoryCategory category) {
+    return category == MemoryCategory::Vertex || category == MemoryCategory::Index ||
+        category == MemoryCategory::Texture || category == MemoryCategory::RenderTarget ||
+        category == MemoryCategory::DynamicBuffer;
+}
+
+const char* MemoryTracker::GetCategoryName(MemoryCategory category) {
+    switch (category) {
+    case MemoryCategory::Vertex: return "Vertex";
+    case MemoryCategory::Index: return "Index";
+    case MemoryCategory::Texture: return "Texture";
+    case MemoryCategory::RenderTarget: return "RenderTarget";
+    case MemoryCategory::DynamicBuffer: return "DynamicBuffer";
+    case MemoryCategory::Staging: return "Staging";
+    case MemoryCategory::Import: return "Import";
+    case MemoryCategory::Acceleration: return "Acceleration";
+    case MemoryCategory::Transient: return "Transient";
+    default: return "?";
+    }
+}
+
+// Totales sin bloquear: se llaman con sMutex ya tomado
+static size_t SumCategories(const MemoryCategoryStats* categories, bool gpu) {
+    size_t total = 0;
+    for (int i = 0; i < kMemoryCategoryCount; ++i)
+        if (MemoryTracker::IsGpuCategory((MemoryCategory)i) == gpu) total += categories[i].current;
+    return total;
+}
+
+void MemoryTracker::Allocate(MemoryCategory category, size_t bytes) {
+    if (bytes == 0) return;
+    std::lock_guard<std::mutex> lock(sMutex);
+    int c = (int)category;
+    MemoryCategoryStats& stats = sCategories[c];
+    stats.current += bytes;
+    stats.allocations++;
+    if (stats.current > stats.peak) stats.peak = stats.current;
+
+    bool gpu = IsGpuCategory(category);
+    size_t total = SumCategories(sCategories, gpu);
+    size_t& peak = gpu ? sGpuPeak : sCpuPeak;
+    if (total > peak) peak = total;
+
+    if (sActiveModel >= 0) {
+        ModelMemoryStats& model = sModels[sActiveModel];
+        model.current[c] += bytes;
+        if (model.current[c] > model.peak[c]) model.peak[c] = model.current[c];
+    }
+
+    CheckBudgets(category);
+}
+
+void MemoryTracker::Free(MemoryCategory category, size_t bytes) {
+    if (bytes == 0) return;
+    std::lock_guard<std::mutex> lock(sMutex);
+    int c = (int)category;
+    MemoryCategoryStats& stats = sCategories[c];
+    stats.current -= std::min(bytes, stats.current);
+
+    // Se descuenta del modelo activo, o del primero que aun tenga esa categoria
+    int model = sActiveModel;
+    if (model < 0 || sModels[model].current[c] < bytes) {
+        model = -1;
+        for (size_t i = 0; i < sModels.size() && model < 0; ++i)
+            if (sModels[i].current[c] >= bytes) model = (int)i;
+    }
+    if (model >= 0) sModels[model].current[c] -= bytes;
+
+    CheckBudgets(category);
+}
+
+void MemoryTracker::Resize(MemoryCategory category, size_t& tracked, size_t bytes) {
+    if (bytes == tracked) return;
+    if (bytes > tracked) Allocate(category, bytes - tracked);
+    else Free(category, tracked - bytes);
+    tracked = bytes;
+}
+
+void MemoryTracker::SetBudget(MemoryCategory category, size_t bytes) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    sCategories[(int)category].budget = bytes;
+    sOverBudget[(int)category] = false;
+    CheckBudgets(category);
+}
+
+void MemoryTracker::SetGpuBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    sGpuBudget = bytes;
+    sGpuOverBudget = false;
+    CheckBudgets(MemoryCategory::Vertex);
+}
+
+// Avisa una vez al cruzar el presupuesto; se rearma al volver por debajo
+void MemoryTracker::CheckBudgets(MemoryCategory category) {
+    int c = (int)category;
+    const MemoryCategoryStats& stats = sCategories[c];
+    if (stats.budget > 0) {
+        bool over = stats.current > stats.budget;
+        if (over && !sOverBudget[c]) {
+            std::cerr << "Memory budget exceeded: " << GetCategoryName(category) << " uses "
+                << ToMB(stats.current) << " MB of " << ToMB(stats.budget) << " MB\n";
+        }
+        sOverBudget[c] = over;
+    }
+
+    if (sGpuBudget > 0 && IsGpuCategory(category)) {
+        size_t total = SumCategories(sCategories, true);
+        bool over = total > sGpuBudget;
+        if (over && !sGpuOverBudget) {
+            std::cerr << "GPU memory budget exceeded: " << ToMB(total) << " MB of "
+                << ToMB(sGpuBudget) << " MB\n";
+        }
+        sGpuOverBudget = over;
+    }
+}
+
+void MemoryTracker::SetActiveModel(const std::string& name) {
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    // Los modelos ya descargados del todo no se guardan
+    for (size_t i = 0; i < sModels.size();) {
+        size_t used = 0;
+        for (int c = 0; c < kMemoryCategoryCount; ++c) used += sModels[i].current[c];
+        if (used == 0 && sModels[i].name != name) sModels.erase(sModels.begin() + i);
+        else ++i;
+    }
+
+    sActiveModel = -1;
+    if (name.empty()) return;
+    for (size_t i = 0; i < sModels.size(); ++i) {
+        if (sModels[i].name == name) {
+            sActiveModel = (int)i;
+            return;
+        }
+    }
+    ModelMemoryStats model;
+    model.name = name;
+    sModels.push_back(model);
+    sActiveModel = (int)sModels.size() - 1;
+}
+
+MemoryCategoryStats MemoryTracker::GetCategoryStats(MemoryCategory category) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    return sCategories[(int)category];
+}
+
+size_t MemoryTracker::GetGpuBytes() {
+    std::lock_guard<std::mutex> lock(sMutex);
+    return SumCategories(sCategories, true);
+}
+
+size_t MemoryTracker::GetCpuBytes() {
+    std::lock_guard<std::mutex> lock(sMutex);
+    return SumCategories(sCategories, false);
+}
+
+void MemoryTracker::GetModelStats(std::vector<ModelMemoryStats>& out) {
+    std::lock_guard<std::mutex> lock(sMutex);
+    out = sModels;
+}
+
+void MemoryTracker::PrintStats() {
+    std::vector<ModelMemoryStats> models;
+    MemoryCategoryStats categories[kMemoryCategoryCount];
+    size_t gpuPeak, cpuPeak, gpuBudget;
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        for (int c = 0; c < kMemoryCategoryCount; ++c) categories[c] = sCategories[c];
+        models = sModels;
+        gpuPeak = sGpuPeak;
+        cpuPeak = sCpuPeak;
+        gpuBudget = sGpuBudget;
+    }
+
+    char line[160];
+    std::cout << "\n=== Memory ===\n";
+    for (int c = 0; c < kMemoryCategoryCount; ++c) {
+        const MemoryCategoryStats& s = categories[c];
+        std::snprintf(line, sizeof(line), "%-14s %s %9.2f MB  peak %9.2f MB  allocs %llu",
+            GetCategoryName((MemoryCategory)c), IsGpuCategory((MemoryCategory)c) ? "GPU" : "CPU",
+            ToMB(s.current), ToMB(s.peak), (unsigned long long)s.allocations);
+        std::cout << line;
+        if (s.budget > 0) std::cout << "  budget " << ToMB(s.budget) << " MB";
+        std::cout << "\n";
+    }
+    std::snprintf(line, sizeof(line), "GPU total %.2f MB (peak %.2f MB), CPU total %.2f MB (peak %.2f MB)",
+        ToMB(SumCategories(categories, true)), ToMB(gpuPeak), ToMB(SumCategories(categories, false)), ToMB(cpuPeak));
+    std::cout << line;
+    if (gpuBudget > 0) std::cout << ", GPU budget " << ToMB(gpuBudget) << " MB";
+    std::cout << "\n";
+
+    for (const ModelMemoryStats& m : models) {
+        size_t gpu = 0, cpu = 0, gpuPeakModel = 0;
+        for (int c = 0; c < kMemoryCategoryCount; ++c) {
+            bool isGpu = IsGpuCategory((MemoryCategory)c);
+            (isGpu ? gpu : cpu) += m.current[c];
+            if (isGpu) gpuPeakModel += m.peak[c];
+        }
+        std::snprintf(line, sizeof(line), "  %s: GPU %.2f MB (peak %.2f MB), CPU %.2f MB",
+            m.name.c_str(), ToMB(gpu), ToMB(gpuPeakModel), ToMB(cpu));
+        std::cout << line << "\n";
+    }
+
+    DriverMemoryInfo info;
+    if (QueryDriverMemory(info)) {
+        if (info.nvx) {
+            std::cout << "Driver (NVX): " << info.currentAvailableKB / 1024 << " / " << info.dedicatedKB / 1024
+                << " MB available, " << info.evictedKB / 1024 << " MB evicted\n";
+        }
+        if (info.ati) {
+            std::cout << "Driver (ATI): free " << info.vboFreeKB / 1024 << " MB buffers, "
+                << info.textureFreeKB / 1024 << " MB textures, " << info.renderbufferFreeKB / 1024 << " MB renderbuffers\n";
+        }
+    }
+}
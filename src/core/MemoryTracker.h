@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class MemoryCategory {
+    Vertex,             // GPU: vertex buffers
+    Index,              // GPU: index buffers
+    Texture,            // GPU: texturas de materiales
+    RenderTarget,       // GPU: shadow maps y otros destinos de render
+    DynamicBuffer,      // GPU: buffers que se reescriben cada frame
+    Staging,            // CPU: datos a la espera de subida (paginas, imagenes)
+    Import,             // CPU: escena de Assimp y temporales de carga
+    Acceleration,       // CPU: estructuras de consulta (BVH de picking)
+    Transient,          // CPU: arenas de frame (listas de dibujo, claves de orden)
+    Count
+};
+
+static const int kMemoryCategoryCount = (int)MemoryCategory::Count;
+
+struct MemoryCategoryStats {
+    size_t current = 0;
+    size_t peak = 0;
+    size_t budget = 0;          // 0 = sin limite
+    uint64_t allocations = 0;
+};
+
+// Memoria que informa el driver (KB), si expone alguna extension
+struct DriverMemoryInfo {
+    bool nvx = false;           // GL_NVX_gpu_memory_info
+    bool ati = false;           // GL_ATI_meminfo
+    int dedicatedKB = 0;
+    int totalAvailableKB = 0;
+    int currentAvailableKB = 0;
+    int evictedKB = 0;
+    int vboFreeKB = 0;
+    int textureFreeKB = 0;
+    int renderbufferFreeKB = 0;
+};
+
+struct ModelMemoryStats {
+    std::string name;
+    size_t current[kMemoryCategoryCount] = {};
+    size_t peak[kMemoryCategoryCount] = {};
+};
+
+// Contabilidad de memoria por categoria, con picos, presupuestos y reparto
+// por modelo. Los tamanos de GPU son los pedidos a GL (el driver puede
+// rellenar o alinear).
+class MemoryTracker {
+public:
+    // Consulta las extensiones de memoria; necesita el contexto GL actual
+    static void InitGPU();
+
+    static void Allocate(MemoryCategory category, size_t bytes);
+    static void Free(MemoryCategory category, size_t bytes);
+    // Ajusta un tamano registrado (buffers que se realocan)
+    static void Resize(MemoryCategory category, size_t& tracked, size_t bytes);
+
+    static void SetBudget(MemoryCategory category, size_t bytes);
+    static void SetGpuBudget(size_t bytes);
+
+    // Lo que se reserve a partir de ahora se atribuye a este modelo ("" = ninguno)
+    static void SetActiveModel(const std::string& name);
+
+    static MemoryCategoryStats GetCategoryStats(MemoryCategory category);
+    static size_t GetGpuBytes();
+    static size_t GetCpuBytes();
+    static size_t GetGpuPeak() { return sGpuPeak; }
+    static size_t GetCpuPeak() { return sCpuPeak; }
+    static void GetModelStats(std::vector<ModelMemoryStats>& out);
+    static bool QueryDriverMemory(DriverMemoryInfo& out);
+
+    static const char* GetCategoryName(MemoryCategory category);
+    static bool IsGpuCategory(MemoryCategory category);
+
+    static void PrintStats();
+
+private:
+    static std::mutex sMutex;
+    static MemoryCategoryStats sCategories[kMemoryCategoryCount];
+    static bool sOverBudget[kMemoryCategoryCount];
+    static size_t sGpuPeak, sCpuPeak;
+    static size_t sGpuBudget;
+    static bool sGpuOverBudget;
+    static std::vector<ModelMemoryStats> sModels;
+    static int sActiveModel;
+    static bool sHasNVX, sHasATI;
+
+    static void CheckBudgets(MemoryCategory category);
+};
+
+// Reserva contabilizada durante un ambito (temporales de carga)
+class ScopedMemory {
+public:
+    ScopedMemory(MemoryCategory category, size_t bytes) : mCategory(category), mBytes(bytes) {
+        MemoryTracker::Allocate(mCategory, mBytes);
+    }
+    ~ScopedMemory() { MemoryTracker::Free(mCategory, mBytes); }
+
+    ScopedMemory(const ScopedMemory&) = delete;
+    ScopedMemory& operator=(const ScopedMemory&) = delete;
+
+private:
+    MemoryCategory mCategory;
+    size_t mBytes;
+};
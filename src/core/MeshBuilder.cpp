@@ -0,0 +1,517 @@
+#include "MeshBuilder.h"
+#include "JobSystem.h"
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+
+const unsigned MeshBuilder::kImportFlags = aiProcess_Triangulate
+    | aiProcess_JoinIdenticalVertices
+    | aiProcess_GenNormals
+    | aiProcess_LimitBoneWeights
+    | aiProcess_FlipUVs;
+
+// Intercala 10 bits con dos ceros entre cada uno (codigo Morton 3D)
+static uint32_t MortonPart1By2(uint32_t x) {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000FF;
+    x = (x | (x << 8)) & 0x0300F00F;
+    x = (x | (x << 4)) & 0x030C30C3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+
+// normals: espacio de trabajo reutilizado entre meshlets
+static void ComputeMeshletBounds(const ArenaVector<float>& vertexData, int stride,
+    const ArenaVector<unsigned>& indices, ArenaVector<float>& normals, Meshlet& meshlet) {
+    auto pos = [&](unsigned v) { return &vertexData[(size_t)v * stride]; };
+    const unsigned end = meshlet.firstIndex + meshlet.indexCount;
+
+    float bmin[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float bmax[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (unsigned i = meshlet.firstIndex; i < end; ++i) {
+        const float* p = pos(indices[i]);
+        for (int k = 0; k < 3; ++k) {
+            bmin[k] = std::min(bmin[k], p[k]);
+            bmax[k] = std::max(bmax[k], p[k]);
+        }
+    }
+
+    float r2 = 0.0f;
+    for (int k = 0; k < 3; ++k) meshlet.center[k] = (bmin[k] + bmax[k]) * 0.5f;
+    for (unsigned i = meshlet.firstIndex; i < end; ++i) {
+        const float* p = pos(indices[i]);
+        float dx = p[0] - meshlet.center[0], dy = p[1] - meshlet.center[1], dz = p[2] - meshlet.center[2];
+        r2 = std::max(r2, dx * dx + dy * dy + dz * dz);
+    }
+    meshlet.radius = std::sqrt(r2);
+
+    // Eje del cono: media de las normales de cara (CCW)
+    normals.clear();
+    float axis[3] = { 0.0f, 0.0f, 0.0f };
+    for (unsigned i = meshlet.firstIndex; i < end; i += 3) {
+        const float* a = pos(indices[i]);
+        const float* b = pos(indices[i + 1]);
+        const float* c = pos(indices[i + 2]);
+        float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len <= 0.0f) continue;
+        for (int k = 0; k < 3; ++k) {
+            normals.push_back(n[k] / len);
+            axis[k] += n[k] / len;
+        }
+    }
+
+    float axisLen = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    meshlet.coneCutoff = 2.0f;
+    if (axisLen <= 1e-6f || normals.empty()) return;
+
+    float minDot = 1.0f;
+    for (int k = 0; k < 3; ++k) meshlet.coneAxis[k] = axis[k] / axisLen;
+    for (size_t n = 0; n < normals.size(); n += 3) {
+        float d = normals[n] * meshlet.coneAxis[0] + normals[n + 1] * meshlet.coneAxis[1] + normals[n + 2] * meshlet.coneAxis[2];
+        minDot = std::min(minDot, d);
+    }
+
+    // Cono de mas de ~84 grados: no merece la pena probarlo
+    if (minDot > 0.1f) {
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+// Reordena los triangulos por codigo Morton del centroide y los agrupa en
+// meshlets contiguos de hasta kMeshletMaxTriangles / kMeshletMaxVertices
+static void BuildMeshlets(const ArenaVector<float>& vertexData, int stride,
+    ArenaVector<unsigned>& indices, ArenaVector<Meshlet>& out) {
+    const size_t triCount = indices.size() / 3;
+    if (triCount == 0) return;
+
+    auto pos = [&](unsigned v) { return &vertexData[(size_t)v * stride]; };
+    // Los temporales salen de la misma arena que los datos del mesh
+    ArenaAllocator<unsigned> alloc = indices.get_allocator();
+
+    ArenaVector<float> centroids(triCount * 3, 0.0f, alloc);
+    float cmin[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float cmax[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (size_t t = 0; t < triCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            float c = (pos(indices[t * 3])[k] + pos(indices[t * 3 + 1])[k] + pos(indices[t * 3 + 2])[k]) / 3.0f;
+            centroids[t * 3 + k] = c;
+            cmin[k] = std::min(cmin[k], c);
+            cmax[k] = std::max(cmax[k], c);
+        }
+    }
+
+    ArenaVector<std::pair<uint32_t, uint32_t>> order(triCount, std::pair<uint32_t, uint32_t>(), alloc);
+    for (size_t t = 0; t < triCount; ++t) {
+        uint32_t code = 0;
+        for (int k = 0; k < 3; ++k) {
+            float extent = cmax[k] - cmin[k];
+            float n = extent > 0.0f ? (centroids[t * 3 + k] - cmin[k]) / extent : 0.0f;
+            code |= MortonPart1By2((uint32_t)(n * 1023.0f)) << k;
+        }
+        order[t] = std::make_pair(code, (uint32_t)t);
+    }
+    std::sort(order.begin(), order.end());
+
+    ArenaVector<unsigned> sorted(alloc);
+    sorted.reserve(indices.size());
+    ArenaVector<unsigned> unique(alloc);
+    unique.reserve(MeshBuilder::kMeshletMaxVertices);
+    ArenaVector<float> normals(alloc);
+    normals.reserve(MeshBuilder::kMeshletMaxTriangles * 3);
+    // Estimacion: el limite de vertices suele cerrar el meshlet antes
+    out.reserve(triCount / (MeshBuilder::kMeshletMaxVertices / 2) + 1);
+
+    Meshlet current;
+    auto flush = [&]() {
+        current.indexCount = (unsigned)sorted.size() - current.firstIndex;
+        if (current.indexCount > 0) {
+            ComputeMeshletBounds(vertexData, stride, sorted, normals, current);
+            out.push_back(current);
+        }
+        current = Meshlet();
+        current.firstIndex = (unsigned)sorted.size();
+        unique.clear();
+    };
+
+    for (const auto& entry : order) {
+        const unsigned* tri = &indices[(size_t)entry.second * 3];
+        size_t newVertices = 0;
+        for (int c = 0; c < 3; ++c) {
+            if (std::find(unique.begin(), unique.end(), tri[c]) == unique.end()) newVertices++;
+        }
+
+        unsigned triangles = ((unsigned)sorted.size() - current.firstIndex) / 3;
+        if (triangles >= MeshBuilder::kMeshletMaxTriangles || unique.size() + newVertices > MeshBuilder::kMeshletMaxVertices) {
+            flush();
+        }
+
+        for (int c = 0; c < 3; ++c) {
+            if (std::find(unique.begin(), unique.end(), tri[c]) == unique.end()) unique.push_back(tri[c]);
+            sorted.push_back(tri[c]);
+        }
+    }
+    flush();
+
+    indices.swap(sorted);
+}
+
+// Error de traslacion admitido en los clips, relativo al tamano de la escena
+static const float kClipTranslationTolerance = 0.0001f;
+
+static size_t MeshGrain(size_t meshCount) {
+    // ~16 rangos por worker: equilibra meshes de tamano muy desigual
+    size_t workers = std::max(1u, JobSystem::GetActiveWorkerCount());
+    return std::max<size_t>(1, meshCount / (workers * 16));
+}
+
+void MeshBuilder::ComputeSceneBounds(const aiScene* scene, float outMin[3], float outMax[3]) {
+    const size_t meshCount = scene->mNumMeshes;
+    std::vector<float> meshBounds(meshCount * 6);
+
+    JobSystem::ParallelFor(meshCount, MeshGrain(meshCount), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const aiMesh* mesh = scene->mMeshes[i];
+            float* b = &meshBounds[i * 6];
+            b[0] = b[1] = b[2] = std::numeric_limits<float>::max();
+            b[3] = b[4] = b[5] = std::numeric_limits<float>::lowest();
+
+            for (unsigned v = 0; v < mesh->mNumVertices; ++v) {
+                float x = mesh->mVertices[v].x;
+                float y = mesh->mVertices[v].y;
+                float z = mesh->mVertices[v].z;
+
+                if (x < b[0]) b[0] = x;
+                if (x > b[3]) b[3] = x;
+                if (y < b[1]) b[1] = y;
+                if (y > b[4]) b[4] = y;
+                if (z < b[2]) b[2] = z;
+                if (z > b[5]) b[5] = z;
+            }
+        }
+    });
+
+    for (int k = 0; k < 3; ++k) {
+        outMin[k] = std::numeric_limits<float>::max();
+        outMax[k] = std::numeric_limits<float>::lowest();
+    }
+    for (size_t i = 0; i < meshCount; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            outMin[k] = std::min(outMin[k], meshBounds[i * 6 + k]);
+            outMax[k] = std::max(outMax[k], meshBounds[i * 6 + 3 + k]);
+        }
+    }
+}
+
+void MeshBuilder::BuildMeshData(const aiScene* scene, const float center[3], LinearArena& arena,
+    std::vector<MeshBuildData>& out) {
+    const size_t meshCount = scene->mNumMeshes;
+    out.clear();
+    out.reserve(meshCount);
+    for (size_t i = 0; i < meshCount; ++i) {
+        out.emplace_back(&arena);
+    }
+
+    JobSystem::ParallelFor(meshCount, MeshGrain(meshCount), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const aiMesh* aiMesh = scene->mMeshes[i];
+            MeshBuildData& data = out[i];
+
+            if (!(aiMesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)) {
+                continue;
+            }
+
+            data.hasUVs = aiMesh->HasTextureCoords(0);
+            int stride = MeshBuilder::VertexStride(data.hasUVs);
+
+            data.vertexData.reserve(aiMesh->mNumVertices * stride);
+
+            for (int k = 0; k < 3; ++k) {
+                data.boundsMin[k] = std::numeric_limits<float>::max();
+                data.boundsMax[k] = std::numeric_limits<float>::lowest();
+            }
+
+            for (unsigned v = 0; v < aiMesh->mNumVertices; ++v) {
+                const float p[3] = {
+                    aiMesh->mVertices[v].x - center[0],
+                    aiMesh->mVertices[v].y - center[1],
+                    aiMesh->mVertices[v].z - center[2] };
+                for (int k = 0; k < 3; ++k) {
+                    data.boundsMin[k] = std::min(data.boundsMin[k], p[k]);
+                    data.boundsMax[k] = std::max(data.boundsMax[k], p[k]);
+                }
+
+                // Posicion (centrada)
+                data.vertexData.push_back(p[0]);
+                data.vertexData.push_back(p[1]);
+                data.vertexData.push_back(p[2]);
+
+                // Normal (aiProcess_GenNormals la garantiza salvo en nubes de puntos)
+                if (aiMesh->HasNormals()) {
+                    data.vertexData.push_back(aiMesh->mNormals[v].x);
+                    data.vertexData.push_back(aiMesh->mNormals[v].y);
+                    data.vertexData.push_back(aiMesh->mNormals[v].z);
+                } else {
+                    data.vertexData.push_back(0.0f);
+                    data.vertexData.push_back(1.0f);
+                    data.vertexData.push_back(0.0f);
+                }
+
+                if (data.hasUVs) {
+                    data.vertexData.push_back(aiMesh->mTextureCoords[0][v].x);
+                    data.vertexData.push_back(aiMesh->mTextureCoords[0][v].y);
+                }
+            }
+
+            data.indices.reserve(aiMesh->mNumFaces * 3);
+            for (unsigned f = 0; f < aiMesh->mNumFaces; ++f) {
+                const aiFace& face = aiMesh->mFaces[f];
+                if (face.mNumIndices == 3) {
+                    data.indices.push_back(face.mIndices[0]);
+                    data.indices.push_back(face.mIndices[1]);
+                    data.indices.push_back(face.mIndices[2]);
+                }
+            }
+
+            BuildMeshlets(data.vertexData, stride, data.indices, data.meshlets);
+
+            data.materialIndex = aiMesh->mMaterialIndex;
+            data.valid = true;
+        }
+    });
+}
+
+void MeshBuilder::ReadMaterials(const aiScene* scene, std::vector<MaterialSource>& out) {
+    out.clear();
+    out.resize(scene->mNumMaterials);
+    for (unsigned int m = 0; m < scene->mNumMaterials; ++m) {
+        const aiMaterial* aiMat = scene->mMaterials[m];
+        MaterialSource& mat = out[m];
+
+        aiColor3D color(0.8f, 0.8f, 0.8f);
+        aiMat->Get(AI_MATKEY_COLOR_DIFFUSE, color);
+        mat.color[0] = color.r;
+        mat.color[1] = color.g;
+        mat.color[2] = color.b;
+
+        if (aiMat->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
+            aiString texPath;
+            if (aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) == AI_SUCCESS) {
+                mat.texture = texPath.C_Str();
+            }
+        }
+    }
+}
+
+void MeshBuilder::ReadLights(const aiScene* scene, const float center[3], float sceneSize,
+    std::vector<PointLight>& out) {
+    out.clear();
+    for (unsigned i = 0; i < scene->mNumLights; ++i) {
+        const aiLight* src = scene->mLights[i];
+        if (src->mType != aiLightSource_POINT && src->mType != aiLightSource_SPOT) continue;
+
+        // Posicion en el espacio del nodo con el mismo nombre
+        aiVector3D p = src->mPosition;
+        for (const aiNode* node = scene->mRootNode->FindNode(src->mName); node; node = node->mParent) {
+            p = node->mTransformation * p;
+        }
+
+        PointLight light;
+        light.position[0] = p.x - center[0];
+        light.position[1] = p.y - center[1];
+        light.position[2] = p.z - center[2];
+
+        // Color normalizado; la magnitud va a la intensidad
+        float peak = std::max(src->mColorDiffuse.r, std::max(src->mColorDiffuse.g, src->mColorDiffuse.b));
+        if (peak <= 0.0f) continue;
+        light.color[0] = src->mColorDiffuse.r / peak;
+        light.color[1] = src->mColorDiffuse.g / peak;
+        light.color[2] = src->mColorDiffuse.b / peak;
+        light.intensity = 1.0f;
+
+        // Radio: distancia a la que la atenuacion baja de 1/256 del pico
+        float c = src->mAttenuationConstant, l = src->mAttenuationLinear, q = src->mAttenuationQuadratic;
+        float target = 256.0f * peak;
+        float radius = sceneSize * 0.25f;
+        if (q > 0.0f) {
+            radius = (-l + std::sqrt(std::max(0.0f, l * l - 4.0f * q * (c - target)))) / (2.0f * q);
+        } else if (l > 0.0f) {
+            radius = (target - c) / l;
+        }
+        light.radius = std::max(sceneSize * 0.01f, std::min(sceneSize, radius));
+
+        out.push_back(light);
+    }
+}
+
+void MeshBuilder::BuildModel(const aiScene* scene, LinearArena& arena, ModelBuildData& out) {
+    ComputeSceneBounds(scene, out.boundsMin, out.boundsMax);
+    float center[3], sceneSize = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        center[k] = (out.boundsMin[k] + out.boundsMax[k]) * 0.5f;
+        sceneSize = std::max(sceneSize, out.boundsMax[k] - out.boundsMin[k]);
+    }
+
+    BuildMeshData(scene, center, arena, out.meshes);
+    ReadMaterials(scene, out.materials);
+    ReadLights(scene, center, sceneSize, out.lights);
+
+    // Esqueleto y clips; sin animaciones el modelo se queda estatico
+    out.clips.clear();
+    if (Animation::BuildSkeleton(scene, center, out.skeleton)) {
+        Animation::CompressClips(scene, out.skeleton, sceneSize * kClipTranslationTolerance, out.clips);
+    }
+    if (out.clips.empty()) {
+        out.skeleton = Skeleton();
+        return;
+    }
+
+    const size_t meshCount = out.meshes.size();
+    JobSystem::ParallelFor(meshCount, MeshGrain(meshCount), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const aiMesh* aiMesh = scene->mMeshes[i];
+            if (out.meshes[i].valid && aiMesh->HasBones()) {
+                Animation::BuildSkinData(aiMesh, out.skeleton, out.meshes[i].skin);
+            }
+        }
+    });
+}
+
+size_t MeshBuilder::BuildStaticBatches(std::vector<MeshBuildData>& meshes, bool animated, float sceneSize,
+    const StaticBatchSettings& settings, LinearArena& arena, std::vector<StaticBatchPart>& parts) {
+    // Candidatos: estaticos, pequenos y con meshlets (una parte oculta se
+    // descarta apagando sus meshlets)
+    std::vector<size_t> candidates;
+    float cmin[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float cmax[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const MeshBuildData& d = meshes[i];
+        bool skinned = animated && !d.skin.empty();
+        if (!d.valid || d.batched || d.partCount > 0 || skinned || d.meshlets.empty()) continue;
+        if (d.indices.size() > settings.maxPartIndices) continue;
+        candidates.push_back(i);
+        for (int k = 0; k < 3; ++k) {
+            float c = (d.boundsMin[k] + d.boundsMax[k]) * 0.5f;
+            cmin[k] = std::min(cmin[k], c);
+            cmax[k] = std::max(cmax[k], c);
+        }
+    }
+    if (candidates.size() < 2) return 0;
+
+    // Por material y formato de vertice; dentro, por cercania
+    std::vector<std::tuple<int, bool, uint32_t, size_t>> order;
+    order.reserve(candidates.size());
+    for (size_t i : candidates) {
+        const MeshBuildData& d = meshes[i];
+        uint32_t code = 0;
+        for (int k = 0; k < 3; ++k) {
+            float extent = cmax[k] - cmin[k];
+            float c = (d.boundsMin[k] + d.boundsMax[k]) * 0.5f;
+            float n = extent > 0.0f ? (c - cmin[k]) / extent : 0.0f;
+            code |= MortonPart1By2((uint32_t)(n * 1023.0f)) << k;
+        }
+        order.emplace_back(d.materialIndex, d.hasUVs, code, i);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<MeshBuildData> batches;
+    auto emit = [&](size_t begin, size_t end) {
+        if (end - begin < 2) return;
+        const MeshBuildData& first = meshes[std::get<3>(order[begin])];
+        const int stride = VertexStride(first.hasUVs);
+
+        // Reserva exacta: la arena no devuelve lo que deja un vector al crecer
+        size_t vertexFloats = 0, indexCount = 0, meshletCount = 0;
+        for (size_t o = begin; o < end; ++o) {
+            const MeshBuildData& d = meshes[std::get<3>(order[o])];
+            vertexFloats += d.vertexData.size();
+            indexCount += d.indices.size();
+            meshletCount += d.meshlets.size();
+        }
+
+        MeshBuildData batch(&arena);
+        batch.vertexData.reserve(vertexFloats);
+        batch.indices.reserve(indexCount);
+        batch.meshlets.reserve(meshletCount);
+        batch.hasUVs = first.hasUVs;
+        batch.materialIndex = first.materialIndex;
+        batch.valid = true;
+        batch.firstPart = (unsigned)parts.size();
+        batch.partCount = (unsigned)(end - begin);
+        for (int k = 0; k < 3; ++k) {
+            batch.boundsMin[k] = std::numeric_limits<float>::max();
+            batch.boundsMax[k] = std::numeric_limits<float>::lowest();
+        }
+
+        for (size_t o = begin; o < end; ++o) {
+            const size_t index = std::get<3>(order[o]);
+            MeshBuildData& source = meshes[index];
+
+            StaticBatchPart part;
+            part.sourceIndex = (int)index;
+            part.firstIndex = (unsigned)batch.indices.size();
+            part.indexCount = (unsigned)source.indices.size();
+            part.firstMeshlet = (unsigned)batch.meshlets.size();
+            part.meshletCount = (unsigned)source.meshlets.size();
+            for (int k = 0; k < 3; ++k) {
+                part.boundsMin[k] = source.boundsMin[k];
+                part.boundsMax[k] = source.boundsMax[k];
+                batch.boundsMin[k] = std::min(batch.boundsMin[k], source.boundsMin[k]);
+                batch.boundsMax[k] = std::max(batch.boundsMax[k], source.boundsMax[k]);
+            }
+
+            const unsigned baseVertex = (unsigned)(batch.vertexData.size() / stride);
+            batch.vertexData.insert(batch.vertexData.end(), source.vertexData.begin(), source.vertexData.end());
+            for (unsigned v : source.indices) batch.indices.push_back(baseVertex + v);
+            for (Meshlet meshlet : source.meshlets) {
+                meshlet.firstIndex += part.firstIndex;
+                batch.meshlets.push_back(meshlet);
+            }
+
+            parts.push_back(part);
+            source.batched = true;
+        }
+        batches.push_back(std::move(batch));
+    };
+
+    // Se llena cada lote hasta el limite de indices o de tamano
+    const float maxExtent = settings.maxBatchExtent * sceneSize;
+    size_t begin = 0, indexCount = 0;
+    float bmin[3] = { 0.0f, 0.0f, 0.0f }, bmax[3] = { 0.0f, 0.0f, 0.0f };
+    for (size_t o = 0; o < order.size(); ++o) {
+        const MeshBuildData& d = meshes[std::get<3>(order[o])];
+        if (o > begin) {
+            bool sameGroup = std::get<0>(order[o]) == std::get<0>(order[begin])
+                && std::get<1>(order[o]) == std::get<1>(order[begin]);
+            float extent2 = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                float e = std::max(bmax[k], d.boundsMax[k]) - std::min(bmin[k], d.boundsMin[k]);
+                extent2 += e * e;
+            }
+            if (!sameGroup || indexCount + d.indices.size() > settings.maxBatchIndices
+                || extent2 > maxExtent * maxExtent) {
+                emit(begin, o);
+                begin = o;
+                indexCount = 0;
+            }
+        }
+        for (int k = 0; k < 3; ++k) {
+            bmin[k] = o == begin ? d.boundsMin[k] : std::min(bmin[k], d.boundsMin[k]);
+            bmax[k] = o == begin ? d.boundsMax[k] : std::max(bmax[k], d.boundsMax[k]);
+        }
+        indexCount += d.indices.size();
+    }
+    emit(begin, order.size());
+
+    for (MeshBuildData& batch : batches) {
+        meshes.push_back(std::move(batch));
+    }
+    return batches.size();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Renderer.h"
+#include "ClusteredLighting.h"
+#include "MemoryArena.h"
+#include "Animation.h"
+#include <string>
+#include <vector>
+
+struct aiScene;
+
+// Datos de CPU de un mesh, preparados en paralelo antes de subirlos a GL
+struct MeshBuildData {
+    explicit MeshBuildData(LinearArena* arena = nullptr)
+        : vertexData(ArenaAllocator<float>(arena)), indices(ArenaAllocator<unsigned>(arena)),
+          meshlets(ArenaAllocator<Meshlet>(arena)), skin(ArenaAllocator<unsigned char>(arena)) {}
+
+    ArenaVector<float> vertexData;      // posicion, normal y UV opcional
+    ArenaVector<unsigned> indices;
+    ArenaVector<Meshlet> meshlets;
+    ArenaVector<unsigned char> skin;    // Animation::kSkinStride por vertice (vacio = estatico)
+    float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+    bool hasUVs = false;
+    bool valid = false;
+    int materialIndex = -1;
+    bool batched = false;               // copiado en un lote estatico: no se sube
+    unsigned firstPart = 0;             // lote: rango en las partes de BuildStaticBatches
+    unsigned partCount = 0;
+};
+
+// Limites de los lotes estaticos: mas grandes ahorran draws, pero el lote
+// entero pasa o no el culling por mesh (las partes solo por meshlet y
+// occlusion culling)
+struct StaticBatchSettings {
+    size_t maxPartIndices = 3072;       // meshes mas grandes ya llenan su draw
+    size_t maxBatchIndices = 196608;    // 64K triangulos
+    float maxBatchExtent = 0.25f;       // diagonal del lote / tamano de la escena
+};
+
+// Material tal como viene del fichero de origen
+struct MaterialSource {
+    float color[3] = { 0.8f, 0.8f, 0.8f };
+    std::string texture;                // difusa, relativa al modelo ("" = sin textura)
+};
+
+// Todo lo que la carga necesita de una escena; sale de Assimp o de un .mmodel
+struct ModelBuildData {
+    float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<MaterialSource> materials;
+    std::vector<PointLight> lights;     // relativas al centro de los limites
+    std::vector<MeshBuildData> meshes;  // uno por aiMesh, aunque no sea valido
+    Skeleton skeleton;                  // vacio si no hay clips
+    std::vector<AnimationClip> clips;
+};
+
+// Preparacion en CPU de una escena de Assimp: la comparten el import del
+// Renderer y la herramienta de cocinado offline.
+class MeshBuilder {
+public:
+    static const unsigned kMeshletMaxTriangles = 124;
+    static const unsigned kMeshletMaxVertices = 64;
+    // Post-proceso de Assimp; igual en el import y en el cocinado
+    static const unsigned kImportFlags;
+
+    // Floats por vertice: posicion (3) + normal (3) + UV (2) si la hay
+    static int VertexStride(bool hasUVs) { return hasUVs ? 8 : 6; }
+
+    static void ComputeSceneBounds(const aiScene* scene, float outMin[3], float outMax[3]);
+    // Un MeshBuildData por aiMesh, centrado en 'center', en paralelo en el
+    // JobSystem. Los vectores de cada mesh y sus temporales salen de 'arena'.
+    static void BuildMeshData(const aiScene* scene, const float center[3], LinearArena& arena,
+        std::vector<MeshBuildData>& out);
+    static void ReadMaterials(const aiScene* scene, std::vector<MaterialSource>& out);
+    // Luces puntuales y focos (los focos se tratan como puntuales)
+    static void ReadLights(const aiScene* scene, const float center[3], float sceneSize,
+        std::vector<PointLight>& out);
+    // Limites, meshes, materiales, luces, esqueleto y clips de la escena
+    static void BuildModel(const aiScene* scene, LinearArena& arena, ModelBuildData& out);
+    // Junta los meshes estaticos pequenos que comparten material y formato
+    // en lotes, por cercania (orden Morton del centro). Los lotes se anaden
+    // al final de 'meshes' y sus meshes de origen quedan con 'batched'; las
+    // partes van a 'parts'. Devuelve el numero de lotes.
+    static size_t BuildStaticBatches(std::vector<MeshBuildData>& meshes, bool animated, float sceneSize,
+        const StaticBatchSettings& settings, LinearArena& arena, std::vector<StaticBatchPart>& parts);
+};
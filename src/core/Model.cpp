@@ -1,26 +1,35 @@
 #include "Model.h"
+#include "GLState.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <vector>
+#include <memory>
+#include <cstring>
 #include <iostream>
 
 Model::~Model() {
-    if (m_vbo) glDeleteBuffers(1, &m_vbo);
-    if (m_vao) glDeleteVertexArrays(1, &m_vao);
-    m_vbo = m_vao = 0;
+    if (m_ebo) GLState::DeleteBuffers(1, &m_ebo);
+    if (m_vbo) GLState::DeleteBuffers(1, &m_vbo);
+    if (m_vao) GLState::DeleteVertexArrays(1, &m_vao);
+    m_ebo = m_vbo = m_vao = 0;
     m_vertexCount = 0;
+    m_indexCount = 0;
 }
 
-static void AppendMeshPositions(const aiMesh* mesh, std::vector<float>& out) {
+// Copia los triangulos de un mesh desplazando sus indices a 'baseVertex'.
+// Devuelve cuantos indices escribio (caras no triangulares se ignoran).
+template <typename IndexT>
+static size_t AppendMeshIndices(const aiMesh* mesh, unsigned int baseVertex, IndexT* out) {
+    size_t written = 0;
     for (unsigned int f = 0; f < mesh->mNumFaces; ++f) {
         const aiFace& face = mesh->mFaces[f];
-        for (unsigned int i = 0; i < face.mNumIndices; ++i) {
-            unsigned int idx = face.mIndices[i];
-            const aiVector3D& v = mesh->mVertices[idx];
-            out.push_back(v.x); out.push_back(v.y); out.push_back(v.z);
-        }
+        if (face.mNumIndices != 3) continue;
+        out[written++] = (IndexT)(baseVertex + face.mIndices[0]);
+        out[written++] = (IndexT)(baseVertex + face.mIndices[1]);
+        out[written++] = (IndexT)(baseVertex + face.mIndices[2]);
     }
+    return written;
 }
 
 bool Model::LoadFromFile(const char* path) {
@@ -38,38 +47,87 @@ bool Model::LoadFromFile(const char* path) {
         return false;
     }
 
-    std::vector<float> positions;
-    positions.reserve(100000);
+    // Tamano exacto antes de copiar nada: vertices compartidos + 3 indices por cara
+    size_t vertexCount = 0;
+    size_t maxIndexCount = 0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
+        const aiMesh* mesh = scene->mMeshes[m];
+        if (!mesh->HasPositions() || !mesh->HasFaces()) continue;
+        vertexCount += mesh->mNumVertices;
+        maxIndexCount += (size_t)mesh->mNumFaces * 3;
+    }
+
+    if (vertexCount == 0 || maxIndexCount == 0) {
+        std::cerr << "Model has no triangles.\n";
+        return false;
+    }
+
+    // Indices de 16 bits si caben todos los vertices
+    const bool shortIndices = vertexCount <= 0xFFFF;
+    const size_t indexSize = shortIndices ? sizeof(unsigned short) : sizeof(unsigned int);
+    const size_t vertexBytes = vertexCount * 3 * sizeof(float);
 
+    // Una sola reserva: posiciones seguidas de indices
+    std::unique_ptr<unsigned char[]> storage(new unsigned char[vertexBytes + maxIndexCount * indexSize]);
+    float* positions = reinterpret_cast<float*>(storage.get());
+    unsigned char* indices = storage.get() + vertexBytes;
+
+    size_t baseVertex = 0;
+    size_t indexCount = 0;
     for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
         const aiMesh* mesh = scene->mMeshes[m];
         if (!mesh->HasPositions() || !mesh->HasFaces()) continue;
-        AppendMeshPositions(mesh, positions);
+
+        // aiVector3D es float x,y,z contiguo: copia directa
+        static_assert(sizeof(aiVector3D) == 3 * sizeof(float), "ai_real must be float");
+        std::memcpy(positions + baseVertex * 3, mesh->mVertices, mesh->mNumVertices * 3 * sizeof(float));
+
+        if (shortIndices) {
+            indexCount += AppendMeshIndices(mesh, (unsigned int)baseVertex,
+                reinterpret_cast<unsigned short*>(indices) + indexCount);
+        }
+        else {
+            indexCount += AppendMeshIndices(mesh, (unsigned int)baseVertex,
+                reinterpret_cast<unsigned int*>(indices) + indexCount);
+        }
+        baseVertex += mesh->mNumVertices;
     }
 
-    if (positions.empty()) {
+    if (indexCount == 0) {
         std::cerr << "Model has no triangles.\n";
         return false;
     }
 
     if (!m_vao) glGenVertexArrays(1, &m_vao);
     if (!m_vbo) glGenBuffers(1, &m_vbo);
+    if (!m_ebo) glGenBuffers(1, &m_ebo);
 
-    glBindVertexArray(m_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+    GLState::BindVertexArray(m_vao);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, positions, GL_STATIC_DRAW);
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
+
+    m_vertexCount = (GLsizei)vertexCount;
+    m_indexCount = (GLsizei)indexCount;
+    m_indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
-    m_vertexCount = (GLsizei)(positions.size() / 3);
-    std::cout << "Model loaded: " << m_vertexCount << " vertices\n";
+    // Comparacion con la sopa de triangulos expandida (3 floats por indice)
+    const size_t indexedBytes = vertexBytes + indexCount * indexSize;
+    const size_t soupBytes = indexCount * 3 * sizeof(float);
+    std::cout << "Model loaded: " << m_vertexCount << " vertices, " << m_indexCount << " indices ("
+        << (shortIndices ? 16 : 32) << "-bit)\n";
+    std::cout << "  Indexed: " << indexedBytes / 1024 << " KB, triangle soup: " << soupBytes / 1024
+        << " KB (" << (indexedBytes ? (double)soupBytes / indexedBytes : 0.0) << "x)\n";
     return true;
 }
 
 void Model::Draw() const {
     if (!IsValid()) return;
-    glBindVertexArray(m_vao);
-    glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
-    glBindVertexArray(0);
+    GLState::BindVertexArray(m_vao);
+    glDrawElements(GL_TRIANGLES, m_indexCount, m_indexType, (void*)0);
+    GLState::BindVertexArray(0);
 }
@@ -9,10 +9,13 @@ public:
     bool LoadFromFile(const char* path); // usa Assimp
     void Draw() const;
 
-    bool IsValid() const { return m_vao != 0 && m_vertexCount > 0; }
+    bool IsValid() const { return m_vao != 0 && m_indexCount > 0; }
 
 private:
     GLuint  m_vao = 0;
     GLuint  m_vbo = 0;
+    GLuint  m_ebo = 0;
     GLsizei m_vertexCount = 0;
+    GLsizei m_indexCount = 0;
+    GLenum  m_indexType = GL_UNSIGNED_INT;
 };
@@ -0,0 +1,211 @@
+#include "ModelCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+static_assert(sizeof(ModelFileHeader) == 56, "ModelFileHeader layout changed");
+static_assert(sizeof(ModelFileClip) == 24, "ModelFileClip layout changed");
+static_assert(sizeof(SkeletonJoint) == 108, "SkeletonJoint layout changed");
+static_assert(sizeof(ClipTrack) == 40, "ClipTrack layout changed");
+static_assert(sizeof(ModelFileMesh) == 48, "ModelFileMesh layout changed");
+static_assert(sizeof(Meshlet) == 40, "Meshlet layout changed");
+static_assert(sizeof(PointLight) == 32, "PointLight layout changed");
+
+bool ModelCache::IsUpToDate(const std::string& sourcePath) {
+    std::error_code ec;
+    std::string cooked = GetCookedPath(sourcePath);
+    if (!std::filesystem::exists(cooked, ec)) return false;
+    auto cookedTime = std::filesystem::last_write_time(cooked, ec);
+    if (ec) return false;
+    auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+    // Sin origen (se distribuye solo el cocinado) vale lo que haya
+    return ec || cookedTime >= sourceTime;
+}
+
+template <typename T, typename A>
+static void WriteArray(std::ofstream& out, const std::vector<T, A>& v) {
+    if (!v.empty()) out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+static void WriteString(std::ofstream& out, const std::string& text) {
+    uint32_t length = (uint32_t)text.size();
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(text.data(), length);
+}
+
+static bool ReadString(std::ifstream& in, std::string& text) {
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!in || length > 4096) return false;
+    text.resize(length);
+    if (length > 0) in.read(&text[0], length);
+    return (bool)in;
+}
+
+template <typename T, typename A>
+static bool ReadArray(std::ifstream& in, std::vector<T, A>& v, size_t count) {
+    v.resize(count);
+    if (count > 0) in.read(reinterpret_cast<char*>(v.data()), count * sizeof(T));
+    return (bool)in;
+}
+
+bool ModelCache::Write(const std::string& path, const ModelBuildData& model) {
+    // Se escribe aparte y se renombra: un corte no deja un .mmodel a medias
+    std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "ModelCache: cannot write " << tempPath << "\n";
+        return false;
+    }
+
+    ModelFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "MMDL", 4);
+    header.version = kVersion;
+    header.meshCount = (uint32_t)model.meshes.size();
+    header.materialCount = (uint32_t)model.materials.size();
+    header.lightCount = (uint32_t)model.lights.size();
+    header.jointCount = (uint32_t)model.skeleton.joints.size();
+    header.clipCount = (uint32_t)model.clips.size();
+    for (int k = 0; k < 3; ++k) {
+        header.boundsMin[k] = model.boundsMin[k];
+        header.boundsMax[k] = model.boundsMax[k];
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const MaterialSource& mat : model.materials) {
+        out.write(reinterpret_cast<const char*>(mat.color), sizeof(mat.color));
+        WriteString(out, mat.texture);
+    }
+    WriteArray(out, model.lights);
+
+    WriteArray(out, model.skeleton.joints);
+    for (const std::string& name : model.skeleton.names) {
+        WriteString(out, name);
+    }
+    for (const AnimationClip& clip : model.clips) {
+        ModelFileClip clipHeader;
+        std::memset(&clipHeader, 0, sizeof(clipHeader));
+        clipHeader.nameLength = (uint32_t)clip.name.size();
+        clipHeader.trackCount = (uint32_t)clip.tracks.size();
+        clipHeader.keyCount = (uint32_t)clip.keyFrames.size();
+        clipHeader.duration = clip.duration;
+        clipHeader.sampleRate = clip.sampleRate;
+        out.write(reinterpret_cast<const char*>(&clipHeader), sizeof(clipHeader));
+        out.write(clip.name.data(), clip.name.size());
+        WriteArray(out, clip.tracks);
+        WriteArray(out, clip.keyFrames);
+        WriteArray(out, clip.keyValues);
+    }
+
+    for (const MeshBuildData& data : model.meshes) {
+        ModelFileMesh mesh;
+        std::memset(&mesh, 0, sizeof(mesh));
+        mesh.flags = (data.valid ? kMeshValid : 0) | (data.hasUVs ? kMeshHasUVs : 0);
+        mesh.materialIndex = data.materialIndex;
+        mesh.vertexFloats = (uint32_t)data.vertexData.size();
+        mesh.indexCount = (uint32_t)data.indices.size();
+        mesh.meshletCount = (uint32_t)data.meshlets.size();
+        mesh.skinBytes = (uint32_t)data.skin.size();
+        for (int k = 0; k < 3; ++k) {
+            mesh.boundsMin[k] = data.boundsMin[k];
+            mesh.boundsMax[k] = data.boundsMax[k];
+        }
+        out.write(reinterpret_cast<const char*>(&mesh), sizeof(mesh));
+        WriteArray(out, data.vertexData);
+        WriteArray(out, data.indices);
+        WriteArray(out, data.meshlets);
+        WriteArray(out, data.skin);
+    }
+
+    out.close();
+    if (!out) {
+        std::cerr << "ModelCache: write failed for " << tempPath << "\n";
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "ModelCache: cannot replace " << path << ": " << ec.message() << "\n";
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool ModelCache::Read(const std::string& path, LinearArena& arena, ModelBuildData& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    ModelFileHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, "MMDL", 4) != 0 || header.version != kVersion) {
+        std::cerr << "ModelCache: " << path << " is not a version " << kVersion << " model file\n";
+        return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+        out.boundsMin[k] = header.boundsMin[k];
+        out.boundsMax[k] = header.boundsMax[k];
+    }
+
+    out.materials.assign(header.materialCount, MaterialSource());
+    for (MaterialSource& mat : out.materials) {
+        in.read(reinterpret_cast<char*>(mat.color), sizeof(mat.color));
+        if (!ReadString(in, mat.texture)) return false;
+    }
+    if (!ReadArray(in, out.lights, header.lightCount)) return false;
+
+    if (header.jointCount > Animation::kMaxJoints) return false;
+    if (!ReadArray(in, out.skeleton.joints, header.jointCount)) return false;
+    out.skeleton.names.assign(header.jointCount, std::string());
+    for (std::string& name : out.skeleton.names) {
+        if (!ReadString(in, name)) return false;
+    }
+    out.clips.assign(header.clipCount, AnimationClip());
+    for (AnimationClip& clip : out.clips) {
+        ModelFileClip clipHeader;
+        in.read(reinterpret_cast<char*>(&clipHeader), sizeof(clipHeader));
+        if (!in || clipHeader.nameLength > 4096 || clipHeader.trackCount != header.jointCount * 3) return false;
+        clip.name.resize(clipHeader.nameLength);
+        if (clipHeader.nameLength > 0) in.read(&clip.name[0], clipHeader.nameLength);
+        clip.duration = clipHeader.duration;
+        clip.sampleRate = clipHeader.sampleRate;
+        if (!ReadArray(in, clip.tracks, clipHeader.trackCount) ||
+            !ReadArray(in, clip.keyFrames, clipHeader.keyCount) ||
+            !ReadArray(in, clip.keyValues, (size_t)clipHeader.keyCount * 4)) {
+            return false;
+        }
+        for (const ClipTrack& track : clip.tracks) {
+            if (track.keyCount == 0 || (size_t)track.firstKey + track.keyCount > clipHeader.keyCount) return false;
+        }
+    }
+
+    out.meshes.clear();
+    out.meshes.reserve(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; ++i) {
+        ModelFileMesh mesh;
+        in.read(reinterpret_cast<char*>(&mesh), sizeof(mesh));
+        if (!in) return false;
+
+        out.meshes.emplace_back(&arena);
+        MeshBuildData& data = out.meshes.back();
+        data.valid = (mesh.flags & kMeshValid) != 0;
+        data.hasUVs = (mesh.flags & kMeshHasUVs) != 0;
+        data.materialIndex = mesh.materialIndex;
+        for (int k = 0; k < 3; ++k) {
+            data.boundsMin[k] = mesh.boundsMin[k];
+            data.boundsMax[k] = mesh.boundsMax[k];
+        }
+        if (!ReadArray(in, data.vertexData, mesh.vertexFloats) ||
+            !ReadArray(in, data.indices, mesh.indexCount) ||
+            !ReadArray(in, data.meshlets, mesh.meshletCount) ||
+            !ReadArray(in, data.skin, mesh.skinBytes)) {
+            std::cerr << "ModelCache: truncated file " << path << "\n";
+            return false;
+        }
+    }
+    return true;
+}
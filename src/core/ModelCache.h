@@ -0,0 +1,62 @@
+#pragma once
+#include "MeshBuilder.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Formato .mmodel: el resultado de MeshBuilder::BuildModel tal cual, para
+// cargar sin Assimp ni construccion de meshlets. Cabecera, materiales, luces,
+// esqueleto, clips y despues cada mesh con sus arrays (vertices, indices,
+// meshlets, skin).
+struct ModelFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t meshCount;
+    uint32_t materialCount;
+    uint32_t lightCount;
+    uint32_t jointCount;
+    uint32_t clipCount;
+    uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// Cabecera de cada clip; le siguen el nombre, las pistas y las claves
+struct ModelFileClip {
+    uint32_t nameLength;
+    uint32_t trackCount;
+    uint32_t keyCount;
+    float duration;
+    float sampleRate;
+    uint32_t reserved;
+};
+
+struct ModelFileMesh {
+    uint32_t flags;             // kMeshValid | kMeshHasUVs
+    int32_t materialIndex;
+    uint32_t vertexFloats;
+    uint32_t indexCount;
+    uint32_t meshletCount;
+    uint32_t skinBytes;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+class ModelCache {
+public:
+    static const uint32_t kVersion = 2;
+    static const uint32_t kMeshValid = 1;
+    static const uint32_t kMeshHasUVs = 2;
+
+    // Por encima de esto el modelo va a .mpages y se dibuja por streaming
+    static const size_t kStreamingTriangleThreshold = 4000000;
+
+    // Junto al fichero de origen, como el .mpages
+    static std::string GetCookedPath(const std::string& sourcePath) { return sourcePath + ".mmodel"; }
+    // Existe y no es mas antiguo que el origen
+    static bool IsUpToDate(const std::string& sourcePath);
+
+    static bool Write(const std::string& path, const ModelBuildData& model);
+    // Los arrays de los meshes salen de 'arena'
+    static bool Read(const std::string& path, LinearArena& arena, ModelBuildData& out);
+};
@@ -0,0 +1,283 @@
+#include "OcclusionCuller.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_SSE 1
+#include <emmintrin.h>
+#endif
+
+static const float kMinClipW = 1e-4f;
+static const int kBandRows = 8;
+
+OcclusionCuller::OcclusionCuller()
+    : mLastRenderMs(0.0) {
+    for (int i = 0; i < 16; ++i) mViewProj[i] = 0.0f;
+
+    int w = kWidth, h = kHeight;
+    while (true) {
+        mLevels.push_back(std::vector<float>((size_t)w * h, 1.0f));
+        mLevelWidth.push_back(w);
+        mLevelHeight.push_back(h);
+        if (w == 1 && h == 1) break;
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+}
+
+void OcclusionCuller::ClearOccluders() {
+    mPositions.clear();
+    mIndices.clear();
+    mClip.clear();
+    mTriangles.clear();
+}
+
+void OcclusionCuller::AddOccluder(const float* vertexData, int stride, size_t vertexCount,
+    const unsigned* indices, size_t indexCount) {
+    unsigned base = (unsigned)(mPositions.size() / 3);
+    mPositions.reserve(mPositions.size() + vertexCount * 3);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* p = vertexData + v * stride;
+        mPositions.insert(mPositions.end(), p, p + 3);
+    }
+    mIndices.reserve(mIndices.size() + indexCount);
+    for (size_t i = 0; i < indexCount; ++i) {
+        mIndices.push_back(base + indices[i]);
+    }
+}
+
+void OcclusionCuller::TransformVertices(size_t begin, size_t end) {
+    const float* m = mViewProj;
+#ifdef OCCLUSION_SSE
+    const __m128 c0 = _mm_loadu_ps(m + 0);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+    for (size_t v = begin; v < end; ++v) {
+        const float* p = &mPositions[v * 3];
+        __m128 r = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), _mm_mul_ps(c1, _mm_set1_ps(p[1]))),
+            _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p[2])), c3));
+        _mm_storeu_ps(&mClip[v * 4], r);
+    }
+#else
+    for (size_t v = begin; v < end; ++v) {
+        const float* p = &mPositions[v * 3];
+        float* out = &mClip[v * 4];
+        for (int k = 0; k < 4; ++k) {
+            out[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::SetupTriangles(size_t begin, size_t end) {
+    for (size_t t = begin; t < end; ++t) {
+        ScreenTriangle& tri = mTriangles[t];
+        tri.valid = false;
+
+        float sx[3], sy[3], sz[3];
+        bool clipped = false;
+        for (int c = 0; c < 3; ++c) {
+            const float* clip = &mClip[(size_t)mIndices[t * 3 + c] * 4];
+            // Sin recorte contra el plano near: basta con no usar el triangulo
+            if (clip[3] <= kMinClipW) {
+                clipped = true;
+                break;
+            }
+            float invW = 1.0f / clip[3];
+            sx[c] = (clip[0] * invW * 0.5f + 0.5f) * kWidth;
+            sy[c] = (clip[1] * invW * 0.5f + 0.5f) * kHeight;
+            sz[c] = clip[2] * invW * 0.5f + 0.5f;
+        }
+        if (clipped) continue;
+        if (sz[0] > 1.0f && sz[1] > 1.0f && sz[2] > 1.0f) continue;
+
+        // Los occluders se rasterizan por las dos caras
+        float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+        if (std::fabs(area) < 1e-6f) continue;
+        if (area < 0.0f) {
+            std::swap(sx[1], sx[2]);
+            std::swap(sy[1], sy[2]);
+            std::swap(sz[1], sz[2]);
+            area = -area;
+        }
+
+        tri.minX = std::max(0, (int)std::floor(std::min({ sx[0], sx[1], sx[2] })));
+        tri.maxX = std::min(kWidth - 1, (int)std::ceil(std::max({ sx[0], sx[1], sx[2] })));
+        tri.minY = std::max(0, (int)std::floor(std::min({ sy[0], sy[1], sy[2] })));
+        tri.maxY = std::min(kHeight - 1, (int)std::ceil(std::max({ sy[0], sy[1], sy[2] })));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) continue;
+
+        for (int e = 0; e < 3; ++e) {
+            int a = e, b = (e + 1) % 3;
+            tri.edgeA[e] = sy[a] - sy[b];
+            tri.edgeB[e] = sx[b] - sx[a];
+            tri.edgeC[e] = -(tri.edgeA[e] * sx[a] + tri.edgeB[e] * sy[a]);
+        }
+
+        float invArea = 1.0f / area;
+        tri.zA = ((sz[1] - sz[0]) * (sy[2] - sy[0]) - (sz[2] - sz[0]) * (sy[1] - sy[0])) * invArea;
+        tri.zB = ((sz[2] - sz[0]) * (sx[1] - sx[0]) - (sz[1] - sz[0]) * (sx[2] - sx[0])) * invArea;
+        tri.zC = sz[0] - tri.zA * sx[0] - tri.zB * sy[0];
+        tri.valid = true;
+    }
+}
+
+// Cada banda de filas es de un solo job: no hay escrituras compartidas
+void OcclusionCuller::RasterizeBand(int rowBegin, int rowEnd) {
+    std::vector<float>& depth = mLevels[0];
+    std::fill(depth.begin() + (size_t)rowBegin * kWidth, depth.begin() + (size_t)rowEnd * kWidth, 1.0f);
+
+    for (const ScreenTriangle& tri : mTriangles) {
+        if (!tri.valid || tri.maxY < rowBegin || tri.minY >= rowEnd) continue;
+
+        int y0 = std::max(tri.minY, rowBegin);
+        int y1 = std::min(tri.maxY, rowEnd - 1);
+        int x0 = tri.minX & ~3;
+
+        for (int y = y0; y <= y1; ++y) {
+            float py = y + 0.5f;
+            float* row = &depth[(size_t)y * kWidth];
+
+#ifdef OCCLUSION_SSE
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 lane = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            __m128 rowE[3], stepA[3];
+            for (int e = 0; e < 3; ++e) {
+                rowE[e] = _mm_set1_ps(tri.edgeB[e] * py + tri.edgeC[e]);
+                stepA[e] = _mm_set1_ps(tri.edgeA[e]);
+            }
+            const __m128 rowZ = _mm_set1_ps(tri.zB * py + tri.zC);
+            const __m128 zA = _mm_set1_ps(tri.zA);
+
+            for (int x = x0; x <= tri.maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lane);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(stepA[0], px), rowE[0]), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(stepA[1], px), rowE[1]), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(stepA[2], px), rowE[2]), zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(zA, px), rowZ);
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for (int x = tri.minX; x <= tri.maxX; ++x) {
+                float px = x + 0.5f;
+                bool inside = true;
+                for (int e = 0; e < 3 && inside; ++e) {
+                    inside = tri.edgeA[e] * px + tri.edgeB[e] * py + tri.edgeC[e] >= 0.0f;
+                }
+                if (!inside) continue;
+                float z = tri.zA * px + tri.zB * py + tri.zC;
+                row[x] = std::min(row[x], z);
+            }
+#endif
+        }
+    }
+}
+
+// Cada texel guarda la profundidad mas lejana de los 2x2 del nivel anterior
+void OcclusionCuller::BuildPyramid() {
+    for (size_t level = 1; level < mLevels.size(); ++level) {
+        const std::vector<float>& src = mLevels[level - 1];
+        std::vector<float>& dst = mLevels[level];
+        int sw = mLevelWidth[level - 1], sh = mLevelHeight[level - 1];
+        int dw = mLevelWidth[level], dh = mLevelHeight[level];
+
+        for (int y = 0; y < dh; ++y) {
+            int sy0 = std::min(y * 2, sh - 1), sy1 = std::min(y * 2 + 1, sh - 1);
+            for (int x = 0; x < dw; ++x) {
+                int sx0 = std::min(x * 2, sw - 1), sx1 = std::min(x * 2 + 1, sw - 1);
+                dst[(size_t)y * dw + x] = std::max(
+                    std::max(src[(size_t)sy0 * sw + sx0], src[(size_t)sy0 * sw + sx1]),
+                    std::max(src[(size_t)sy1 * sw + sx0], src[(size_t)sy1 * sw + sx1]));
+            }
+        }
+    }
+}
+
+void OcclusionCuller::Render(const float viewProj[16]) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < 16; ++i) mViewProj[i] = viewProj[i];
+
+    const size_t vertexCount = mPositions.size() / 3;
+    const size_t triangleCount = mIndices.size() / 3;
+    mClip.resize(vertexCount * 4);
+    mTriangles.resize(triangleCount);
+
+    JobSystem::ParallelFor(vertexCount, 8192, [this](size_t begin, size_t end) {
+        TransformVertices(begin, end);
+    });
+    JobSystem::ParallelFor(triangleCount, 4096, [this](size_t begin, size_t end) {
+        SetupTriangles(begin, end);
+    });
+    JobSystem::ParallelFor(kHeight, kBandRows, [this](size_t begin, size_t end) {
+        RasterizeBand((int)begin, (int)end);
+    });
+
+    BuildPyramid();
+
+    mLastRenderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool OcclusionCuller::IsVisible(const float boundsMin[3], const float boundsMax[3]) const {
+    if (mIndices.empty()) return true;
+
+    const float* m = mViewProj;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, minZ = 1e30f;
+
+    for (int corner = 0; corner < 8; ++corner) {
+        float p[3] = {
+            (corner & 1) ? boundsMax[0] : boundsMin[0],
+            (corner & 2) ? boundsMax[1] : boundsMin[1],
+            (corner & 4) ? boundsMax[2] : boundsMin[2] };
+        float clip[4];
+        for (int k = 0; k < 4; ++k) {
+            clip[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+        }
+        // Cruza el plano near: no se puede descartar
+        if (clip[3] <= kMinClipW) return true;
+
+        float invW = 1.0f / clip[3];
+        float sx = (clip[0] * invW * 0.5f + 0.5f) * kWidth;
+        float sy = (clip[1] * invW * 0.5f + 0.5f) * kHeight;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        minZ = std::min(minZ, clip[2] * invW * 0.5f + 0.5f);
+    }
+
+    // Fuera de pantalla lo decide el frustum culling
+    if (maxX < 0.0f || maxY < 0.0f || minX >= kWidth || minY >= kHeight) return true;
+
+    int x0 = std::max(0, (int)std::floor(minX));
+    int y0 = std::max(0, (int)std::floor(minY));
+    int x1 = std::min(kWidth - 1, (int)std::floor(maxX));
+    int y1 = std::min(kHeight - 1, (int)std::floor(maxY));
+
+    // Nivel en el que el rectangulo cubre como mucho 2x2 texels
+    size_t level = 0;
+    while (level + 1 < mLevels.size() && std::max(x1 - x0, y1 - y0) > 1) {
+        x0 >>= 1; y0 >>= 1; x1 >>= 1; y1 >>= 1;
+        level++;
+    }
+
+    const std::vector<float>& depth = mLevels[level];
+    int w = mLevelWidth[level];
+    float farthest = 0.0f;
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            farthest = std::max(farthest, depth[(size_t)y * w + x]);
+        }
+    }
+
+    return minZ <= farthest;
+}
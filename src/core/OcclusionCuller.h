@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Occlusion culling por software: rasteriza los occluders en un depth buffer
+// pequeno en CPU (SSE, por bandas en el JobSystem), construye una piramide
+// Hi-Z de maximos y prueba AABBs contra ella.
+class OcclusionCuller {
+public:
+    static const int kWidth = 256;
+    static const int kHeight = 128;
+
+    OcclusionCuller();
+
+    void ClearOccluders();
+    // vertexData con 'stride' floats por vertice y la posicion al principio
+    void AddOccluder(const float* vertexData, int stride, size_t vertexCount,
+        const unsigned* indices, size_t indexCount);
+    bool HasOccluders() const { return !mIndices.empty(); }
+    size_t GetOccluderTriangleCount() const { return mIndices.size() / 3; }
+
+    // Rasteriza los occluders con esta view-projection (column-major)
+    void Render(const float viewProj[16]);
+    bool IsVisible(const float boundsMin[3], const float boundsMax[3]) const;
+
+    double GetLastRenderMs() const { return mLastRenderMs; }
+
+private:
+    // Funciones de arista (>= 0 dentro) y plano de profundidad en pantalla
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float zA, zB, zC;               // z = zA * x + zB * y + zC
+        int minX, maxX, minY, maxY;
+        bool valid;
+    };
+
+    std::vector<float> mPositions;      // xyz de todos los occluders
+    std::vector<unsigned> mIndices;
+    std::vector<float> mClip;           // xyzw por vertice, por frame
+    std::vector<ScreenTriangle> mTriangles;
+
+    std::vector<std::vector<float>> mLevels;  // nivel 0 = kWidth x kHeight
+    std::vector<int> mLevelWidth;
+    std::vector<int> mLevelHeight;
+
+    float mViewProj[16];
+    double mLastRenderMs;
+
+    void TransformVertices(size_t begin, size_t end);
+    void SetupTriangles(size_t begin, size_t end);
+    void RasterizeBand(int rowBegin, int rowEnd);
+    void BuildPyramid();
+};
@@ -0,0 +1,316 @@
+#include "PageFile.h"
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+static_assert(sizeof(PageFileHeader) == 72, "PageFileHeader layout changed");
+static_assert(sizeof(PageNode) == 88, "PageNode layout changed");
+
+static const uint32_t kMaxDepth = 12;
+static const int kClusterGrid = 64;
+
+struct PageBuildContext {
+    std::vector<float> positions;      // centradas, 3 floats por vertice
+    std::vector<uint32_t> triangles;   // 3 indices globales por triangulo
+    std::vector<PageNode> nodes;
+    std::ofstream out;
+    uint64_t offset = 0;
+    uint32_t maxTriangles = 65536;
+};
+
+static void TriangleBounds(const PageBuildContext& ctx, const std::vector<uint32_t>& tris,
+    float bmin[3], float bmax[3]) {
+    for (int k = 0; k < 3; ++k) {
+        bmin[k] = std::numeric_limits<float>::max();
+        bmax[k] = std::numeric_limits<float>::lowest();
+    }
+    for (uint32_t t : tris) {
+        for (int c = 0; c < 3; ++c) {
+            const float* p = &ctx.positions[ctx.triangles[t * 3 + c] * 3];
+            for (int k = 0; k < 3; ++k) {
+                bmin[k] = std::min(bmin[k], p[k]);
+                bmax[k] = std::max(bmax[k], p[k]);
+            }
+        }
+    }
+}
+
+// Geometria completa: vertices reindexados localmente a la pagina
+static void ExtractLeaf(const PageBuildContext& ctx, const std::vector<uint32_t>& tris,
+    std::vector<float>& verts, std::vector<uint32_t>& indices) {
+    std::unordered_map<uint32_t, uint32_t> remap;
+    remap.reserve(tris.size() * 2);
+    indices.reserve(tris.size() * 3);
+
+    for (uint32_t t : tris) {
+        for (int c = 0; c < 3; ++c) {
+            uint32_t global = ctx.triangles[t * 3 + c];
+            auto it = remap.find(global);
+            if (it == remap.end()) {
+                uint32_t local = (uint32_t)(verts.size() / 3);
+                it = remap.emplace(global, local).first;
+                const float* p = &ctx.positions[global * 3];
+                verts.insert(verts.end(), p, p + 3);
+            }
+            indices.push_back(it->second);
+        }
+    }
+}
+
+// Vertex clustering sobre una rejilla: colapsa los vertices de cada celda a su
+// media y descarta triangulos degenerados o repetidos. Devuelve el error (tamano
+// de celda) de la aproximacion.
+static float Simplify(const PageBuildContext& ctx, const std::vector<uint32_t>& tris,
+    const float bmin[3], const float bmax[3], uint32_t maxTriangles,
+    std::vector<float>& verts, std::vector<uint32_t>& indices) {
+    float extent = std::max({ bmax[0] - bmin[0], bmax[1] - bmin[1], bmax[2] - bmin[2], 1e-6f });
+
+    for (int grid = kClusterGrid; ; grid /= 2) {
+        float cell = extent / grid;
+        std::unordered_map<uint32_t, uint32_t> cellToVertex;
+        std::unordered_set<uint64_t> seen;
+        std::vector<double> sums;
+        std::vector<uint32_t> counts;
+        verts.clear();
+        indices.clear();
+
+        auto clusterOf = [&](uint32_t global) {
+            const float* p = &ctx.positions[global * 3];
+            uint32_t key = 0;
+            for (int k = 0; k < 3; ++k) {
+                int c = (int)((p[k] - bmin[k]) / cell);
+                c = std::max(0, std::min(grid - 1, c));
+                key = key * (uint32_t)grid + (uint32_t)c;
+            }
+            auto it = cellToVertex.find(key);
+            if (it == cellToVertex.end()) {
+                it = cellToVertex.emplace(key, (uint32_t)counts.size()).first;
+                sums.push_back(0.0); sums.push_back(0.0); sums.push_back(0.0);
+                counts.push_back(0);
+            }
+            uint32_t v = it->second;
+            sums[v * 3 + 0] += p[0];
+            sums[v * 3 + 1] += p[1];
+            sums[v * 3 + 2] += p[2];
+            counts[v]++;
+            return v;
+        };
+
+        for (uint32_t t : tris) {
+            uint32_t a = clusterOf(ctx.triangles[t * 3 + 0]);
+            uint32_t b = clusterOf(ctx.triangles[t * 3 + 1]);
+            uint32_t c = clusterOf(ctx.triangles[t * 3 + 2]);
+            if (a == b || b == c || a == c) continue;
+
+            // Clave independiente del orden para eliminar duplicados
+            uint64_t lo = std::min({ a, b, c }), hi = std::max({ a, b, c });
+            uint64_t mid = (uint64_t)a + b + c - lo - hi;
+            if (!seen.insert(lo | (mid << 21) | (hi << 42)).second) continue;
+
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+        }
+
+        if (indices.size() / 3 > maxTriangles && grid > 2) {
+            continue;
+        }
+
+        verts.resize(counts.size() * 3);
+        for (size_t v = 0; v < counts.size(); ++v) {
+            for (int k = 0; k < 3; ++k) {
+                verts[v * 3 + k] = (float)(sums[v * 3 + k] / counts[v]);
+            }
+        }
+        return cell * std::sqrt(3.0f);
+    }
+}
+
+static void WritePage(PageBuildContext& ctx, PageNode& node,
+    const std::vector<float>& verts, const std::vector<uint32_t>& indices) {
+    node.vertexCount = (uint32_t)(verts.size() / 3);
+    node.indexCount = (uint32_t)indices.size();
+    node.dataOffset = ctx.offset;
+    node.dataSize = verts.size() * sizeof(float) + indices.size() * sizeof(uint32_t);
+
+    ctx.out.write(reinterpret_cast<const char*>(verts.data()), verts.size() * sizeof(float));
+    ctx.out.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+    ctx.offset += node.dataSize;
+}
+
+static int32_t BuildNode(PageBuildContext& ctx, std::vector<uint32_t>& tris,
+    const float cellMin[3], const float cellMax[3], uint32_t depth) {
+    int32_t index = (int32_t)ctx.nodes.size();
+    ctx.nodes.push_back(PageNode{});
+
+    PageNode node = {};
+    std::fill(std::begin(node.children), std::end(node.children), -1);
+    node.depth = depth;
+    TriangleBounds(ctx, tris, node.boundsMin, node.boundsMax);
+
+    std::vector<float> verts;
+    std::vector<uint32_t> indices;
+
+    if (tris.size() <= ctx.maxTriangles || depth >= kMaxDepth) {
+        ExtractLeaf(ctx, tris, verts, indices);
+        node.geometricError = 0.0f;
+    }
+    else {
+        // Repartir por centroide entre los 8 octantes de la celda
+        float mid[3];
+        for (int k = 0; k < 3; ++k) mid[k] = (cellMin[k] + cellMax[k]) * 0.5f;
+
+        std::vector<uint32_t> octants[8];
+        for (uint32_t t : tris) {
+            int octant = 0;
+            for (int k = 0; k < 3; ++k) {
+                float c = (ctx.positions[ctx.triangles[t * 3 + 0] * 3 + k] +
+                    ctx.positions[ctx.triangles[t * 3 + 1] * 3 + k] +
+                    ctx.positions[ctx.triangles[t * 3 + 2] * 3 + k]) / 3.0f;
+                if (c >= mid[k]) octant |= 1 << k;
+            }
+            octants[octant].push_back(t);
+        }
+
+        for (int o = 0; o < 8; ++o) {
+            if (octants[o].empty()) continue;
+            float childMin[3], childMax[3];
+            for (int k = 0; k < 3; ++k) {
+                bool upper = (o >> k) & 1;
+                childMin[k] = upper ? mid[k] : cellMin[k];
+                childMax[k] = upper ? cellMax[k] : mid[k];
+            }
+            node.children[o] = BuildNode(ctx, octants[o], childMin, childMax, depth + 1);
+            std::vector<uint32_t>().swap(octants[o]);
+        }
+
+        node.geometricError = Simplify(ctx, tris, node.boundsMin, node.boundsMax,
+            ctx.maxTriangles, verts, indices);
+    }
+
+    WritePage(ctx, node, verts, indices);
+    ctx.nodes[index] = node;
+    return index;
+}
+
+bool PageFile::Build(const aiScene* scene, const std::string& outPath, uint32_t maxTrianglesPerPage) {
+    if (!scene) return false;
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    PageBuildContext ctx;
+    ctx.maxTriangles = std::max(1024u, maxTrianglesPerPage);
+
+    size_t vertexCount = 0, triangleCount = 0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
+        vertexCount += scene->mMeshes[m]->mNumVertices;
+        triangleCount += scene->mMeshes[m]->mNumFaces;
+    }
+    ctx.positions.reserve(vertexCount * 3);
+    ctx.triangles.reserve(triangleCount * 3);
+
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
+        const aiMesh* mesh = scene->mMeshes[m];
+        if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)) continue;
+
+        uint32_t base = (uint32_t)(ctx.positions.size() / 3);
+        for (unsigned v = 0; v < mesh->mNumVertices; ++v) {
+            ctx.positions.push_back(mesh->mVertices[v].x);
+            ctx.positions.push_back(mesh->mVertices[v].y);
+            ctx.positions.push_back(mesh->mVertices[v].z);
+        }
+        for (unsigned f = 0; f < mesh->mNumFaces; ++f) {
+            const aiFace& face = mesh->mFaces[f];
+            if (face.mNumIndices != 3) continue;
+            ctx.triangles.push_back(base + face.mIndices[0]);
+            ctx.triangles.push_back(base + face.mIndices[1]);
+            ctx.triangles.push_back(base + face.mIndices[2]);
+        }
+    }
+
+    if (ctx.triangles.empty()) {
+        std::cerr << "PageFile: scene has no triangles\n";
+        return false;
+    }
+
+    std::vector<uint32_t> all(ctx.triangles.size() / 3);
+    for (uint32_t t = 0; t < all.size(); ++t) all[t] = t;
+
+    PageFileHeader header = {};
+    std::memcpy(header.magic, "MPGS", 4);
+    header.version = kVersion;
+    header.totalTriangles = all.size();
+    TriangleBounds(ctx, all, header.boundsMin, header.boundsMax);
+
+    // Centrar como en la carga normal
+    for (int k = 0; k < 3; ++k) {
+        header.center[k] = (header.boundsMin[k] + header.boundsMax[k]) * 0.5f;
+    }
+    for (size_t i = 0; i < ctx.positions.size(); ++i) {
+        ctx.positions[i] -= header.center[i % 3];
+    }
+    for (int k = 0; k < 3; ++k) {
+        header.boundsMin[k] -= header.center[k];
+        header.boundsMax[k] -= header.center[k];
+    }
+
+    ctx.out.open(outPath, std::ios::binary | std::ios::trunc);
+    if (!ctx.out) {
+        std::cerr << "PageFile: cannot write " << outPath << "\n";
+        return false;
+    }
+
+    ctx.out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ctx.offset = sizeof(header);
+
+    header.rootNode = (uint32_t)BuildNode(ctx, all, header.boundsMin, header.boundsMax, 0);
+    header.nodeCount = (uint32_t)ctx.nodes.size();
+    header.nodeTableOffset = ctx.offset;
+
+    ctx.out.write(reinterpret_cast<const char*>(ctx.nodes.data()), ctx.nodes.size() * sizeof(PageNode));
+    ctx.out.seekp(0);
+    ctx.out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ctx.out.close();
+
+    if (!ctx.out) {
+        std::cerr << "PageFile: write failed for " << outPath << "\n";
+        return false;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Page file written: " << outPath << "\n";
+    std::cout << "  Nodes: " << header.nodeCount << ", triangles: " << header.totalTriangles
+        << ", size: " << (header.nodeTableOffset >> 20) << " MB, " << ms << " ms\n";
+    return true;
+}
+
+bool PageFile::ReadIndex(const std::string& path, PageFileHeader& header, std::vector<PageNode>& nodes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "PageFile: cannot open " << path << "\n";
+        return false;
+    }
+
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, "MPGS", 4) != 0 || header.version != kVersion) {
+        std::cerr << "PageFile: invalid header in " << path << "\n";
+        return false;
+    }
+
+    nodes.resize(header.nodeCount);
+    in.seekg((std::streamoff)header.nodeTableOffset);
+    in.read(reinterpret_cast<char*>(nodes.data()), nodes.size() * sizeof(PageNode));
+    if (!in || header.rootNode >= header.nodeCount) {
+        std::cerr << "PageFile: truncated node table in " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct aiScene;
+
+// Formato .mpages: octree de paginas de geometria en disco.
+// Cabecera al principio, paginas a continuacion y la tabla de nodos al final.
+// Las hojas guardan la geometria completa de su celda; los nodos internos una
+// version simplificada (vertex clustering) de todo su subarbol.
+struct PageFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t rootNode;
+    float boundsMin[3];
+    float boundsMax[3];
+    float center[3];        // las posiciones se guardan relativas a este centro
+    float reserved;
+    uint64_t nodeTableOffset;
+    uint64_t totalTriangles;
+};
+
+struct PageNode {
+    float boundsMin[3];
+    float boundsMax[3];
+    int32_t children[8];    // -1 = sin hijo
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint64_t dataOffset;    // vertexCount * 3 floats, luego indexCount uint32
+    uint64_t dataSize;
+    float geometricError;   // 0 en hojas
+    uint32_t depth;
+};
+
+class PageFile {
+public:
+    static const uint32_t kVersion = 1;
+
+    static bool Build(const aiScene* scene, const std::string& outPath,
+        uint32_t maxTrianglesPerPage = 65536);
+    static bool ReadIndex(const std::string& path, PageFileHeader& header,
+        std::vector<PageNode>& nodes);
+};
@@ -0,0 +1,545 @@
+#include "RayPicker.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PICKING_SSE 1
+#include <emmintrin.h>
+#endif
+
+static const unsigned kLeafTriangles = 4;   // un paquete por hoja
+static const int kBinCount = 16;
+static const int kMaxBuildDepth = 48;
+static const int kStackSize = 256;
+static const uint32_t kEmptyLane = 0xffffffffu;
+
+// --- Construccion -----------------------------------------------------------
+
+namespace {
+
+struct TriBounds {
+    float mn[3], mx[3], c[3];
+};
+
+// Nodo binario intermedio; se colapsa a BVH4 al final
+struct BuildNode {
+    float mn[3], mx[3];
+    int left = -1, right = -1;      // left < 0: hoja
+    uint32_t begin = 0, count = 0;
+};
+
+struct Box {
+    float mn[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float mx[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+    void Grow(const float p[3]) {
+        for (int k = 0; k < 3; ++k) { mn[k] = std::min(mn[k], p[k]); mx[k] = std::max(mx[k], p[k]); }
+    }
+    void Grow(const TriBounds& t) {
+        for (int k = 0; k < 3; ++k) { mn[k] = std::min(mn[k], t.mn[k]); mx[k] = std::max(mx[k], t.mx[k]); }
+    }
+    void Grow(const Box& b) {
+        for (int k = 0; k < 3; ++k) { mn[k] = std::min(mn[k], b.mn[k]); mx[k] = std::max(mx[k], b.mx[k]); }
+    }
+    float HalfArea() const {
+        float d[3] = { mx[0] - mn[0], mx[1] - mn[1], mx[2] - mn[2] };
+        if (d[0] < 0.0f) return 0.0f;
+        return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+    }
+};
+
+struct BuildContext {
+    std::vector<TriBounds> tris;
+    std::vector<uint32_t> order;
+    std::vector<BuildNode> nodes;
+};
+
+// SAH con bins sobre el eje mas largo de los centroides
+int BuildBinary(BuildContext& ctx, uint32_t begin, uint32_t end, int depth) {
+    Box bounds, centroids;
+    for (uint32_t i = begin; i < end; ++i) {
+        bounds.Grow(ctx.tris[ctx.order[i]]);
+        centroids.Grow(ctx.tris[ctx.order[i]].c);
+    }
+
+    int index = (int)ctx.nodes.size();
+    ctx.nodes.emplace_back();
+    {
+        BuildNode& node = ctx.nodes[index];
+        for (int k = 0; k < 3; ++k) { node.mn[k] = bounds.mn[k]; node.mx[k] = bounds.mx[k]; }
+        node.begin = begin;
+        node.count = end - begin;
+    }
+
+    uint32_t count = end - begin;
+    if (count <= kLeafTriangles) {
+        return index;
+    }
+
+    int axis = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (centroids.mx[k] - centroids.mn[k] > centroids.mx[axis] - centroids.mn[axis]) axis = k;
+    }
+    float extent = centroids.mx[axis] - centroids.mn[axis];
+
+    // Por debajo de kMaxBuildDepth solo medianas: la profundidad queda acotada
+    uint32_t mid = begin + count / 2;
+    if (extent > 0.0f && depth < kMaxBuildDepth && count > 2 * kLeafTriangles) {
+        Box binBounds[kBinCount];
+        uint32_t binCount[kBinCount] = {};
+        float scale = kBinCount / extent;
+        auto binOf = [&](uint32_t tri) {
+            int b = (int)((ctx.tris[tri].c[axis] - centroids.mn[axis]) * scale);
+            return std::min(b, kBinCount - 1);
+        };
+        for (uint32_t i = begin; i < end; ++i) {
+            int b = binOf(ctx.order[i]);
+            binCount[b]++;
+            binBounds[b].Grow(ctx.tris[ctx.order[i]]);
+        }
+
+        // Barrido derecha -> izquierda y luego izquierda -> derecha
+        float rightCost[kBinCount];
+        Box acc;
+        uint32_t accCount = 0;
+        for (int b = kBinCount - 1; b > 0; --b) {
+            if (binCount[b]) acc.Grow(binBounds[b]);
+            accCount += binCount[b];
+            rightCost[b] = acc.HalfArea() * accCount;
+        }
+        acc = Box();
+        accCount = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        int bestSplit = -1;
+        for (int b = 0; b < kBinCount - 1; ++b) {
+            if (binCount[b]) acc.Grow(binBounds[b]);
+            accCount += binCount[b];
+            if (accCount == 0 || accCount == count) continue;
+            float cost = acc.HalfArea() * accCount + rightCost[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+
+        if (bestSplit >= 0) {
+            uint32_t* first = ctx.order.data() + begin;
+            uint32_t* split = std::partition(first, ctx.order.data() + end,
+                [&](uint32_t tri) { return binOf(tri) <= bestSplit; });
+            mid = begin + (uint32_t)(split - first);
+        }
+    }
+    if (count <= 2 * kLeafTriangles) {
+        // Pocos triangulos: una hoja llena y el resto, para no malgastar carriles
+        mid = begin + kLeafTriangles;
+        std::nth_element(ctx.order.begin() + begin, ctx.order.begin() + mid, ctx.order.begin() + end,
+            [&](uint32_t a, uint32_t b) { return ctx.tris[a].c[axis] < ctx.tris[b].c[axis]; });
+    } else if (mid == begin || mid == end || extent <= 0.0f || depth >= kMaxBuildDepth) {
+        // Centroides iguales o particion vacia: mediana
+        mid = begin + count / 2;
+        std::nth_element(ctx.order.begin() + begin, ctx.order.begin() + mid, ctx.order.begin() + end,
+            [&](uint32_t a, uint32_t b) { return ctx.tris[a].c[axis] < ctx.tris[b].c[axis]; });
+    }
+
+    int left = BuildBinary(ctx, begin, mid, depth + 1);
+    int right = BuildBinary(ctx, mid, end, depth + 1);
+    ctx.nodes[index].left = left;
+    ctx.nodes[index].right = right;
+    return index;
+}
+
+float NodeHalfArea(const BuildNode& n) {
+    float d[3] = { n.mx[0] - n.mn[0], n.mx[1] - n.mn[1], n.mx[2] - n.mn[2] };
+    return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+}
+
+} // namespace
+
+RayPicker::RayPicker()
+    : mTriangleCount(0), mTrackedBytes(0), mLastBuildMs(0.0), mLastQueryMs(0.0), mLastNodesVisited(0) {
+}
+
+void RayPicker::Clear() {
+    mTrees.clear();
+    for (int k = 0; k < 3; ++k) {
+        mTreeLo[k].clear();
+        mTreeHi[k].clear();
+    }
+    mTriangleCount = 0;
+    MemoryTracker::Resize(MemoryCategory::Acceleration, mTrackedBytes, 0);
+}
+
+void RayPicker::AddMesh(int meshId, const float* vertexData, int stride, size_t vertexCount,
+    const unsigned* indices, size_t indexCount) {
+    if (indexCount < 3) return;
+
+    mTrees.emplace_back();
+    Tree& tree = mTrees.back();
+    tree.meshId = meshId;
+    tree.positions.resize(vertexCount * 3);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        for (int k = 0; k < 3; ++k) tree.positions[v * 3 + k] = vertexData[v * stride + k];
+    }
+    tree.indices.assign(indices, indices + indexCount - indexCount % 3);
+    mTriangleCount += indexCount / 3;
+}
+
+void RayPicker::BuildTree(Tree& tree) {
+    BuildContext ctx;
+    size_t triCount = tree.indices.size() / 3;
+    ctx.tris.resize(triCount);
+    for (size_t t = 0; t < triCount; ++t) {
+        TriBounds& b = ctx.tris[t];
+        for (int k = 0; k < 3; ++k) { b.mn[k] = std::numeric_limits<float>::max(); b.mx[k] = std::numeric_limits<float>::lowest(); }
+        for (int c = 0; c < 3; ++c) {
+            const float* p = &tree.positions[(size_t)tree.indices[t * 3 + c] * 3];
+            for (int k = 0; k < 3; ++k) { b.mn[k] = std::min(b.mn[k], p[k]); b.mx[k] = std::max(b.mx[k], p[k]); }
+        }
+        for (int k = 0; k < 3; ++k) b.c[k] = (b.mn[k] + b.mx[k]) * 0.5f;
+    }
+    ctx.order.resize(triCount);
+    std::iota(ctx.order.begin(), ctx.order.end(), 0u);
+    ctx.nodes.reserve(triCount / 2 + 1);
+
+    BuildBinary(ctx, 0, (uint32_t)triCount, 0);
+    for (int k = 0; k < 3; ++k) {
+        tree.boundsMin[k] = ctx.nodes[0].mn[k];
+        tree.boundsMax[k] = ctx.nodes[0].mx[k];
+    }
+
+    auto emitPacket = [&](const BuildNode& leaf) {
+        Packet packet;
+        for (int lane = 0; lane < 4; ++lane) {
+            if ((uint32_t)lane < leaf.count) {
+                uint32_t tri = ctx.order[leaf.begin + lane];
+                const float* p0 = &tree.positions[(size_t)tree.indices[tri * 3 + 0] * 3];
+                const float* p1 = &tree.positions[(size_t)tree.indices[tri * 3 + 1] * 3];
+                const float* p2 = &tree.positions[(size_t)tree.indices[tri * 3 + 2] * 3];
+                for (int k = 0; k < 3; ++k) {
+                    packet.v0[k][lane] = p0[k];
+                    packet.e1[k][lane] = p1[k] - p0[k];
+                    packet.e2[k][lane] = p2[k] - p0[k];
+                }
+                packet.id[lane] = tri;
+            } else {
+                // Aristas nulas: determinante 0, nunca hay impacto
+                for (int k = 0; k < 3; ++k) packet.v0[k][lane] = packet.e1[k][lane] = packet.e2[k][lane] = 0.0f;
+                packet.id[lane] = kEmptyLane;
+            }
+        }
+        tree.packets.push_back(packet);
+        return -(int32_t)tree.packets.size();     // -(indice + 1)
+    };
+
+    // Colapsa el arbol binario: cada nodo absorbe a sus nietos hasta tener 4 hijos
+    std::function<int32_t(int)> collapse = [&](int binaryIndex) -> int32_t {
+        int slots[4];
+        int slotCount = 0;
+        const BuildNode& root = ctx.nodes[binaryIndex];
+        if (root.left < 0) {
+            slots[slotCount++] = binaryIndex;
+        } else {
+            slots[slotCount++] = root.left;
+            slots[slotCount++] = root.right;
+        }
+        while (slotCount < 4) {
+            int best = -1;
+            float bestArea = -1.0f;
+            for (int s = 0; s < slotCount; ++s) {
+                const BuildNode& n = ctx.nodes[slots[s]];
+                if (n.left >= 0 && NodeHalfArea(n) > bestArea) {
+                    bestArea = NodeHalfArea(n);
+                    best = s;
+                }
+            }
+            if (best < 0) break;
+            const BuildNode& n = ctx.nodes[slots[best]];
+            slots[best] = n.left;
+            slots[slotCount++] = n.right;
+        }
+
+        int32_t nodeIndex = (int32_t)tree.nodes.size();
+        tree.nodes.emplace_back();
+        for (int s = 0; s < 4; ++s) {
+            int32_t child = 0;
+            float lo[3], hi[3];
+            if (s < slotCount) {
+                const BuildNode& n = ctx.nodes[slots[s]];
+                for (int k = 0; k < 3; ++k) { lo[k] = n.mn[k]; hi[k] = n.mx[k]; }
+                child = n.left < 0 ? emitPacket(n) : collapse(slots[s]);
+            } else {
+                for (int k = 0; k < 3; ++k) {
+                    lo[k] = std::numeric_limits<float>::infinity();
+                    hi[k] = -std::numeric_limits<float>::infinity();
+                }
+            }
+            // Se escribe por indice: la recursion puede haber realocado nodes
+            Node& node = tree.nodes[nodeIndex];
+            for (int k = 0; k < 3; ++k) { node.lo[k][s] = lo[k]; node.hi[k][s] = hi[k]; }
+            node.child[s] = child;
+        }
+        return nodeIndex;
+    };
+    collapse(0);
+
+    tree.nodes.shrink_to_fit();
+    tree.packets.shrink_to_fit();
+    std::vector<float>().swap(tree.positions);
+    std::vector<unsigned>().swap(tree.indices);
+}
+
+void RayPicker::Build() {
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Los meshes grandes primero: reparto mas equilibrado entre workers
+    std::vector<size_t> order(mTrees.size());
+    std::iota(order.begin(), order.end(), (size_t)0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return mTrees[a].indices.size() > mTrees[b].indices.size();
+    });
+    JobSystem::ParallelFor(order.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) BuildTree(mTrees[order[i]]);
+    });
+
+    size_t padded = (mTrees.size() + 3) & ~(size_t)3;
+    for (int k = 0; k < 3; ++k) {
+        mTreeLo[k].assign(padded, std::numeric_limits<float>::infinity());
+        mTreeHi[k].assign(padded, -std::numeric_limits<float>::infinity());
+        for (size_t t = 0; t < mTrees.size(); ++t) {
+            mTreeLo[k][t] = mTrees[t].boundsMin[k];
+            mTreeHi[k][t] = mTrees[t].boundsMax[k];
+        }
+    }
+
+    mLastBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    MemoryTracker::Resize(MemoryCategory::Acceleration, mTrackedBytes, GetMemoryBytes());
+    std::cout << "Picking BVH: " << mTrees.size() << " meshes, " << mTriangleCount << " triangles, "
+        << GetMemoryBytes() / (1024 * 1024) << " MB, built in " << mLastBuildMs << " ms" << std::endl;
+}
+
+size_t RayPicker::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (const Tree& tree : mTrees) {
+        bytes += tree.nodes.capacity() * sizeof(Node) + tree.packets.capacity() * sizeof(Packet);
+    }
+    return bytes;
+}
+
+// --- Consulta ---------------------------------------------------------------
+
+namespace {
+
+struct Ray {
+    float origin[3];
+    float dir[3];
+    float invDir[3];
+    int nearSide[3];                // 0: usar lo como plano de entrada, 1: hi
+};
+
+// Entrada en las 4 cajas; bit i activo si la caja i se cruza antes de tMax
+inline int IntersectBoxes(const float lo[3][4], const float hi[3][4], const Ray& ray, float tMax, float tNear[4]) {
+#ifdef PICKING_SSE
+    __m128 tEnter = _mm_setzero_ps();
+    __m128 tExit = _mm_set1_ps(tMax);
+    for (int k = 0; k < 3; ++k) {
+        const float* nearPlane = ray.nearSide[k] ? hi[k] : lo[k];
+        const float* farPlane = ray.nearSide[k] ? lo[k] : hi[k];
+        __m128 o = _mm_set1_ps(ray.origin[k]);
+        __m128 inv = _mm_set1_ps(ray.invDir[k]);
+        tEnter = _mm_max_ps(tEnter, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(nearPlane), o), inv));
+        tExit = _mm_min_ps(tExit, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(farPlane), o), inv));
+    }
+    _mm_storeu_ps(tNear, tEnter);
+    return _mm_movemask_ps(_mm_cmple_ps(tEnter, tExit));
+#else
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        float tEnter = 0.0f, tExit = tMax;
+        for (int k = 0; k < 3; ++k) {
+            float nearPlane = ray.nearSide[k] ? hi[k][i] : lo[k][i];
+            float farPlane = ray.nearSide[k] ? lo[k][i] : hi[k][i];
+            tEnter = std::max(tEnter, (nearPlane - ray.origin[k]) * ray.invDir[k]);
+            tExit = std::min(tExit, (farPlane - ray.origin[k]) * ray.invDir[k]);
+        }
+        tNear[i] = tEnter;
+        if (tEnter <= tExit) mask |= 1 << i;
+    }
+    return mask;
+#endif
+}
+
+// Moller-Trumbore sobre 4 triangulos (dos caras). Devuelve el carril mas
+// cercano con t < tMax, o -1.
+inline int IntersectTriangles(const float v0[3][4], const float e1[3][4], const float e2[3][4],
+    const Ray& ray, float tMax, float& tHit, float& uHit, float& vHit) {
+    float t[4], u[4], v[4];
+    int mask;
+#ifdef PICKING_SSE
+    const __m128 dx = _mm_set1_ps(ray.dir[0]), dy = _mm_set1_ps(ray.dir[1]), dz = _mm_set1_ps(ray.dir[2]);
+    const __m128 e1x = _mm_loadu_ps(e1[0]), e1y = _mm_loadu_ps(e1[1]), e1z = _mm_loadu_ps(e1[2]);
+    const __m128 e2x = _mm_loadu_ps(e2[0]), e2y = _mm_loadu_ps(e2[1]), e2z = _mm_loadu_ps(e2[2]);
+
+    // p = d x e2, det = e1 . p
+    __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    // s = o - v0, u = (s . p) / det
+    __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin[0]), _mm_loadu_ps(v0[0]));
+    __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin[1]), _mm_loadu_ps(v0[1]));
+    __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin[2]), _mm_loadu_ps(v0[2]));
+    __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+    // q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+    __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+    __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+    const __m128 zero = _mm_setzero_ps();
+    __m128 valid = _mm_cmpneq_ps(det, zero);
+    valid = _mm_and_ps(valid, _mm_cmpge_ps(uu, zero));
+    valid = _mm_and_ps(valid, _mm_cmpge_ps(vv, zero));
+    valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(uu, vv), _mm_set1_ps(1.0f)));
+    valid = _mm_and_ps(valid, _mm_cmpgt_ps(tt, zero));
+    valid = _mm_and_ps(valid, _mm_cmplt_ps(tt, _mm_set1_ps(tMax)));
+    mask = _mm_movemask_ps(valid);
+    if (!mask) return -1;
+    _mm_storeu_ps(t, tt);
+    _mm_storeu_ps(u, uu);
+    _mm_storeu_ps(v, vv);
+#else
+    mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        const float* d = ray.dir;
+        float p[3] = { d[1] * e2[2][i] - d[2] * e2[1][i], d[2] * e2[0][i] - d[0] * e2[2][i], d[0] * e2[1][i] - d[1] * e2[0][i] };
+        float det = e1[0][i] * p[0] + e1[1][i] * p[1] + e1[2][i] * p[2];
+        if (det == 0.0f) continue;
+        float invDet = 1.0f / det;
+        float s[3] = { ray.origin[0] - v0[0][i], ray.origin[1] - v0[1][i], ray.origin[2] - v0[2][i] };
+        u[i] = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+        float q[3] = { s[1] * e1[2][i] - s[2] * e1[1][i], s[2] * e1[0][i] - s[0] * e1[2][i], s[0] * e1[1][i] - s[1] * e1[0][i] };
+        v[i] = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * invDet;
+        t[i] = (e2[0][i] * q[0] + e2[1][i] * q[1] + e2[2][i] * q[2]) * invDet;
+        if (u[i] >= 0.0f && v[i] >= 0.0f && u[i] + v[i] <= 1.0f && t[i] > 0.0f && t[i] < tMax) mask |= 1 << i;
+    }
+    if (!mask) return -1;
+#endif
+    int best = -1;
+    for (int i = 0; i < 4; ++i) {
+        if ((mask & (1 << i)) && (best < 0 || t[i] < t[best])) best = i;
+    }
+    tHit = t[best];
+    uHit = u[best];
+    vHit = v[best];
+    return best;
+}
+
+} // namespace
+
+bool RayPicker::Intersect(const float origin[3], const float dir[3], PickResult& out) const {
+    auto t0 = std::chrono::steady_clock::now();
+    out = PickResult();
+    mLastNodesVisited = 0;
+
+    float len = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+    if (len <= 0.0f || mTrees.empty()) return false;
+
+    Ray ray;
+    for (int k = 0; k < 3; ++k) {
+        ray.origin[k] = origin[k];
+        ray.dir[k] = dir[k] / len;
+        // Evita 0 * inf = NaN en los planos paralelos
+        float d = std::fabs(ray.dir[k]) < 1e-20f ? std::copysign(1e-20f, ray.dir[k]) : ray.dir[k];
+        ray.invDir[k] = 1.0f / d;
+        ray.nearSide[k] = ray.invDir[k] < 0.0f ? 1 : 0;
+    }
+
+    // Arboles cruzados, del mas cercano al mas lejano
+    struct Candidate { float tNear; size_t tree; };
+    std::vector<Candidate> candidates;
+    float best = std::numeric_limits<float>::max();
+    for (size_t base = 0; base < mTreeLo[0].size(); base += 4) {
+        const float lo[3][4] = {
+            { mTreeLo[0][base], mTreeLo[0][base + 1], mTreeLo[0][base + 2], mTreeLo[0][base + 3] },
+            { mTreeLo[1][base], mTreeLo[1][base + 1], mTreeLo[1][base + 2], mTreeLo[1][base + 3] },
+            { mTreeLo[2][base], mTreeLo[2][base + 1], mTreeLo[2][base + 2], mTreeLo[2][base + 3] } };
+        const float hi[3][4] = {
+            { mTreeHi[0][base], mTreeHi[0][base + 1], mTreeHi[0][base + 2], mTreeHi[0][base + 3] },
+            { mTreeHi[1][base], mTreeHi[1][base + 1], mTreeHi[1][base + 2], mTreeHi[1][base + 3] },
+            { mTreeHi[2][base], mTreeHi[2][base + 1], mTreeHi[2][base + 2], mTreeHi[2][base + 3] } };
+        float tNear[4];
+        int mask = IntersectBoxes(lo, hi, ray, best, tNear);
+        for (int i = 0; i < 4; ++i) {
+            if (!(mask & (1 << i))) continue;
+            candidates.push_back({ tNear[i], base + i });
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.tNear < b.tNear; });
+
+    struct StackEntry { int32_t node; float tNear; };
+    StackEntry stack[kStackSize];
+
+    for (const Candidate& candidate : candidates) {
+        if (candidate.tNear >= best) break;
+        const Tree& tree = mTrees[candidate.tree];
+        if (tree.nodes.empty()) continue;
+
+        int sp = 0;
+        stack[sp++] = { 0, candidate.tNear };
+        while (sp > 0) {
+            StackEntry entry = stack[--sp];
+            if (entry.tNear >= best) continue;
+
+            if (entry.node < 0) {
+                const Packet& packet = tree.packets[-entry.node - 1];
+                float t, u, v;
+                int lane = IntersectTriangles(packet.v0, packet.e1, packet.e2, ray, best, t, u, v);
+                if (lane >= 0) {
+                    best = t;
+                    out.hit = true;
+                    out.mesh = tree.meshId;
+                    out.triangle = packet.id[lane];
+                    out.u = u;
+                    out.v = v;
+                }
+                continue;
+            }
+
+            const Node& node = tree.nodes[entry.node];
+            mLastNodesVisited++;
+            float tNear[4];
+            int mask = IntersectBoxes(node.lo, node.hi, ray, best, tNear);
+
+            // Se apilan de lejos a cerca para visitar primero el mas cercano
+            StackEntry hits[4];
+            int hitCount = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (!(mask & (1 << i))) continue;
+                StackEntry e = { node.child[i], tNear[i] };
+                int j = hitCount++;
+                while (j > 0 && hits[j - 1].tNear < e.tNear) { hits[j] = hits[j - 1]; --j; }
+                hits[j] = e;
+            }
+            for (int i = 0; i < hitCount && sp < kStackSize; ++i) stack[sp++] = hits[i];
+        }
+    }
+
+    if (out.hit) {
+        out.distance = best;
+        for (int k = 0; k < 3; ++k) out.position[k] = ray.origin[k] + ray.dir[k] * best;
+    }
+    mLastQueryMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return out.hit;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PickResult {
+    bool hit = false;
+    int mesh = -1;                  // id pasado a AddMesh
+    unsigned int triangle = 0;      // triangulo dentro del index buffer del mesh
+    float u = 0.0f, v = 0.0f;       // baricentricas de v1 y v2 (v0 = 1 - u - v)
+    float distance = 0.0f;          // a lo largo de la direccion normalizada
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    int sourceMesh = -1;            // mesh importado (Renderer::PickAt); distinto en lotes estaticos
+    unsigned int sourceTriangle = 0;
+};
+
+// Picking por rayo: un BVH4 por mesh (cajas de 4 hijos y hojas de 4
+// triangulos en SoA, probados con SSE) y una lista de cajas de mesh por
+// encima, recorridas de la mas cercana a la mas lejana.
+class RayPicker {
+public:
+    RayPicker();
+
+    void Clear();
+    // Copia posiciones e indices; los arboles se construyen en Build()
+    void AddMesh(int meshId, const float* vertexData, int stride, size_t vertexCount,
+        const unsigned* indices, size_t indexCount);
+    // Un arbol por mesh, en paralelo en el JobSystem
+    void Build();
+
+    bool IsEmpty() const { return mTrees.empty(); }
+    size_t GetTriangleCount() const { return mTriangleCount; }
+    size_t GetMemoryBytes() const;
+    double GetLastBuildMs() const { return mLastBuildMs; }
+
+    // dir no necesita estar normalizada; devuelve el impacto mas cercano
+    bool Intersect(const float origin[3], const float dir[3], PickResult& out) const;
+    double GetLastQueryMs() const { return mLastQueryMs; }
+    size_t GetLastNodesVisited() const { return mLastNodesVisited; }
+
+private:
+    // Cajas de 4 hijos en SoA. child >= 0: nodo; < 0: hoja -(paquete + 1).
+    // Las ranuras vacias tienen la caja invertida y nunca se cruzan.
+    struct Node {
+        float lo[3][4];
+        float hi[3][4];
+        int32_t child[4];
+    };
+
+    // Hasta 4 triangulos: v0 y aristas e1 = v1 - v0, e2 = v2 - v0
+    struct Packet {
+        float v0[3][4];
+        float e1[3][4];
+        float e2[3][4];
+        uint32_t id[4];             // 0xffffffff en carriles vacios
+    };
+
+    struct Tree {
+        int meshId = -1;
+        std::vector<Node> nodes;
+        std::vector<Packet> packets;
+        float boundsMin[3], boundsMax[3];
+        // Solo durante la construccion
+        std::vector<float> positions;
+        std::vector<unsigned> indices;
+    };
+
+    std::vector<Tree> mTrees;
+    std::vector<float> mTreeLo[3];  // cajas de los arboles en SoA, rellenas a 4
+    std::vector<float> mTreeHi[3];
+    size_t mTriangleCount;
+    size_t mTrackedBytes;           // lo registrado en MemoryTracker
+    double mLastBuildMs;
+    mutable double mLastQueryMs;
+    mutable size_t mLastNodesVisited;
+
+    static void BuildTree(Tree& tree);
+};
@@ -0,0 +1,493 @@
+#include "RenderGraph.h"
+#include "GLState.h"
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+// Formato externo compatible, bytes por texel y tipo de attachment
+struct TextureFormatInfo {
+    GLenum format;
+    GLenum type;
+    size_t bytesPerTexel;
+    GLenum attachment;      // GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT o GL_DEPTH_STENCIL_ATTACHMENT
+};
+
+static TextureFormatInfo GetFormatInfo(unsigned int internalFormat) {
+    switch (internalFormat) {
+    case GL_DEPTH_COMPONENT24: return { GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4, GL_DEPTH_ATTACHMENT };
+    case GL_DEPTH_COMPONENT32F: return { GL_DEPTH_COMPONENT, GL_FLOAT, 4, GL_DEPTH_ATTACHMENT };
+    case GL_DEPTH24_STENCIL8: return { GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, 4, GL_DEPTH_STENCIL_ATTACHMENT };
+    case GL_RGBA16F: return { GL_RGBA, GL_HALF_FLOAT, 8, GL_COLOR_ATTACHMENT0 };
+    case GL_RGBA32F: return { GL_RGBA, GL_FLOAT, 16, GL_COLOR_ATTACHMENT0 };
+    case GL_RG16F: return { GL_RG, GL_HALF_FLOAT, 4, GL_COLOR_ATTACHMENT0 };
+    case GL_R16F: return { GL_RED, GL_HALF_FLOAT, 2, GL_COLOR_ATTACHMENT0 };
+    case GL_R32F: return { GL_RED, GL_FLOAT, 4, GL_COLOR_ATTACHMENT0 };
+    case GL_R11F_G11F_B10F: return { GL_RGB, GL_FLOAT, 4, GL_COLOR_ATTACHMENT0 };
+    case GL_R8: return { GL_RED, GL_UNSIGNED_BYTE, 1, GL_COLOR_ATTACHMENT0 };
+    default: return { GL_RGBA, GL_UNSIGNED_BYTE, 4, GL_COLOR_ATTACHMENT0 };   // GL_RGBA8, GL_SRGB8_ALPHA8
+    }
+}
+
+static bool SameDesc(const RGTextureDesc& a, const RGTextureDesc& b) {
+    return a.width == b.width && a.height == b.height && a.format == b.format;
+}
+
+RGHandle RenderGraphBuilder::CreateTexture(const char* name, const RGTextureDesc& desc) {
+    size_t bytes = (size_t)std::max(desc.width, 1) * (size_t)std::max(desc.height, 1) *
+        GetFormatInfo(desc.format).bytesPerTexel;
+    return mGraph.AddResource(name, RenderGraph::kTexture, desc, bytes, mPass);
+}
+
+RGHandle RenderGraphBuilder::CreateBuffer(const char* name, size_t bytes) {
+    return mGraph.AddResource(name, RenderGraph::kBuffer, RGTextureDesc(), bytes, mPass);
+}
+
+void RenderGraphBuilder::Read(RGHandle resource) {
+    if (mGraph.IsValid(resource)) mGraph.mPasses[mPass].reads.push_back(resource);
+}
+
+void RenderGraphBuilder::Write(RGHandle resource) {
+    if (mGraph.IsValid(resource)) mGraph.mPasses[mPass].writes.push_back(resource);
+}
+
+void RenderGraphBuilder::WriteColor(RGHandle texture) {
+    if (!mGraph.IsValid(texture)) return;
+    RenderGraph::Pass& pass = mGraph.mPasses[mPass];
+    if (pass.colorTargets.size() >= 4) {
+        std::cerr << "RenderGraph: pass " << pass.name << " has more than 4 color targets\n";
+        return;
+    }
+    pass.colorTargets.push_back(texture);
+    pass.writes.push_back(texture);
+}
+
+void RenderGraphBuilder::WriteDepth(RGHandle texture) {
+    if (!mGraph.IsValid(texture)) return;
+    RenderGraph::Pass& pass = mGraph.mPasses[mPass];
+    pass.depthTarget = texture;
+    pass.writes.push_back(texture);
+}
+
+void RenderGraphBuilder::SetSideEffect() {
+    mGraph.mPasses[mPass].sideEffect = true;
+}
+
+RenderGraph::RenderGraph()
+    : mFrame(0), mVirtualBytes(0), mPhysicalBytes(0), mAliasedResources(0), mCompiled(false) {
+}
+
+void RenderGraph::Shutdown() {
+    for (Physical& physical : mPhysical) {
+        DestroyPhysical(physical);
+    }
+    mPhysical.clear();
+    for (CachedFramebuffer& cached : mFramebuffers) {
+        glDeleteFramebuffers(1, &cached.fbo);
+    }
+    mFramebuffers.clear();
+    Reset();
+}
+
+void RenderGraph::Reset() {
+    mResources.clear();
+    mPasses.clear();
+    mOrder.clear();
+    mCompiled = false;
+    mFrame++;
+}
+
+RGHandle RenderGraph::AddResource(const char* name, ResourceKind kind, const RGTextureDesc& desc, size_t bytes,
+    int producer) {
+    Resource resource;
+    resource.name = name;
+    resource.kind = kind;
+    resource.desc = desc;
+    resource.bytes = bytes;
+    resource.producer = producer;
+    resource.firstUse = -1;
+    resource.lastUse = -1;
+    resource.physical = -1;
+    mResources.push_back(resource);
+    return (RGHandle)mResources.size() - 1;
+}
+
+RGHandle RenderGraph::ImportBackbuffer(const char* name, int width, int height) {
+    RGTextureDesc desc;
+    desc.width = width;
+    desc.height = height;
+    return AddResource(name, kBackbuffer, desc, 0, -1);
+}
+
+RGHandle RenderGraph::Import(const char* name) {
+    return AddResource(name, kExternal, RGTextureDesc(), 0, -1);
+}
+
+void RenderGraph::AddPass(const char* name, const SetupFn& setup, const ExecuteFn& execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    pass.depthTarget = -1;
+    pass.sideEffect = false;
+    pass.alive = false;
+    mPasses.push_back(pass);
+
+    RenderGraphBuilder builder(*this, (int)mPasses.size() - 1);
+    setup(builder);
+}
+
+bool RenderGraph::Compile() {
+    const int passCount = (int)mPasses.size();
+    const int resourceCount = (int)mResources.size();
+    mOrder.clear();
+
+    // Escritores y lectores de cada recurso, en orden de declaracion
+    std::vector<std::vector<int>> writers(resourceCount), readers(resourceCount);
+    for (int p = 0; p < passCount; ++p) {
+        for (RGHandle r : mPasses[p].writes) writers[r].push_back(p);
+        for (RGHandle r : mPasses[p].reads) readers[r].push_back(p);
+    }
+    for (int r = 0; r < resourceCount; ++r) {
+        std::vector<int>& w = writers[r];
+        w.erase(std::unique(w.begin(), w.end()), w.end());
+    }
+
+    // Culling: vivos los que escriben el backbuffer o tienen efectos
+    // laterales, y hacia atras los que producen lo que leen los vivos
+    std::vector<int> work;
+    for (int p = 0; p < passCount; ++p) {
+        Pass& pass = mPasses[p];
+        pass.alive = pass.sideEffect;
+        for (RGHandle r : pass.writes) {
+            if (mResources[r].kind == kBackbuffer) pass.alive = true;
+        }
+        if (pass.alive) work.push_back(p);
+    }
+    while (!work.empty()) {
+        int p = work.back();
+        work.pop_back();
+        for (RGHandle r : mPasses[p].reads) {
+            for (int w : writers[r]) {
+                if (w != p && !mPasses[w].alive) {
+                    mPasses[w].alive = true;
+                    work.push_back(w);
+                }
+            }
+        }
+    }
+
+    // Dependencias: cada lector tras los escritores declarados antes que el
+    // (o tras todos si lee algo que se produce mas adelante) y los escritores
+    // de un mismo recurso en orden de declaracion
+    std::vector<std::vector<int>> edges(passCount);
+    std::vector<int> incoming(passCount, 0);
+    auto addEdge = [&](int from, int to) {
+        if (from == to || !mPasses[from].alive || !mPasses[to].alive) return;
+        edges[from].push_back(to);
+        incoming[to]++;
+    };
+    for (int r = 0; r < resourceCount; ++r) {
+        const std::vector<int>& w = writers[r];
+        for (size_t i = 1; i < w.size(); ++i) addEdge(w[i - 1], w[i]);
+        for (int reader : readers[r]) {
+            bool earlier = !w.empty() && w.front() < reader;
+            for (int writer : w) {
+                if (!earlier || writer < reader) addEdge(writer, reader);
+            }
+        }
+    }
+
+    // Orden topologico estable: entre los disponibles, el declarado antes
+    std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+    int aliveCount = 0;
+    for (int p = 0; p < passCount; ++p) {
+        if (!mPasses[p].alive) continue;
+        aliveCount++;
+        if (incoming[p] == 0) ready.push(p);
+    }
+    while (!ready.empty()) {
+        int p = ready.top();
+        ready.pop();
+        mOrder.push_back(p);
+        for (int next : edges[p]) {
+            if (--incoming[next] == 0) ready.push(next);
+        }
+    }
+    if ((int)mOrder.size() != aliveCount) {
+        std::cerr << "RenderGraph: dependency cycle, falling back to declaration order\n";
+        mOrder.clear();
+        for (int p = 0; p < passCount; ++p) {
+            if (mPasses[p].alive) mOrder.push_back(p);
+        }
+    }
+
+    // Vida de cada recurso en posiciones de mOrder
+    for (int i = 0; i < (int)mOrder.size(); ++i) {
+        const Pass& pass = mPasses[mOrder[i]];
+        auto touch = [&](RGHandle r) {
+            Resource& resource = mResources[r];
+            if (resource.firstUse < 0) resource.firstUse = i;
+            resource.lastUse = i;
+        };
+        for (RGHandle r : pass.reads) touch(r);
+        for (RGHandle r : pass.writes) touch(r);
+    }
+
+    // Aliasing: por orden de primer uso, cada transitorio toma un fisico
+    // compatible que ya este libre en ese punto del frame
+    ReleaseUnused();
+    for (Physical& physical : mPhysical) physical.busyUntil = -1;
+    std::vector<int> byFirstUse;
+    for (int r = 0; r < resourceCount; ++r) {
+        const Resource& resource = mResources[r];
+        if ((resource.kind == kTexture || resource.kind == kBuffer) && resource.firstUse >= 0) {
+            byFirstUse.push_back(r);
+        }
+    }
+    std::stable_sort(byFirstUse.begin(), byFirstUse.end(),
+        [this](int a, int b) { return mResources[a].firstUse < mResources[b].firstUse; });
+
+    mVirtualBytes = 0;
+    mPhysicalBytes = 0;
+    mAliasedResources = 0;
+    for (int r : byFirstUse) {
+        Resource& resource = mResources[r];
+        resource.physical = AcquirePhysical(resource);
+        mVirtualBytes += resource.bytes;
+    }
+    for (const Physical& physical : mPhysical) {
+        if (physical.lastFrame == mFrame) mPhysicalBytes += physical.bytes;
+    }
+
+    mCompiled = true;
+    return true;
+}
+
+int RenderGraph::AcquirePhysical(const Resource& resource) {
+    // Preferible uno ya usado este frame (eso es lo que ahorra memoria)
+    int best = -1;
+    for (int i = 0; i < (int)mPhysical.size(); ++i) {
+        const Physical& physical = mPhysical[i];
+        if (physical.kind != resource.kind || physical.busyUntil >= resource.firstUse) continue;
+        bool compatible = resource.kind == kTexture ? SameDesc(physical.desc, resource.desc)
+            : (physical.bytes >= resource.bytes && physical.bytes <= resource.bytes * 2);
+        if (!compatible) continue;
+        if (best < 0 || (physical.lastFrame == mFrame && mPhysical[best].lastFrame != mFrame)) best = i;
+    }
+
+    if (best >= 0) {
+        Physical& physical = mPhysical[best];
+        if (physical.lastFrame == mFrame) mAliasedResources++;
+        physical.lastFrame = mFrame;
+        physical.busyUntil = resource.lastUse;
+        return best;
+    }
+
+    Physical physical;
+    physical.kind = resource.kind;
+    physical.desc = resource.desc;
+    physical.bytes = resource.bytes;
+    physical.object = 0;
+    physical.lastFrame = mFrame;
+    physical.busyUntil = resource.lastUse;
+
+    if (resource.kind == kTexture) {
+        TextureFormatInfo info = GetFormatInfo(resource.desc.format);
+        bool depth = info.attachment != GL_COLOR_ATTACHMENT0;
+        glGenTextures(1, &physical.object);
+        GLState::BindTexture(0, GL_TEXTURE_2D, physical.object);
+        glTexImage2D(GL_TEXTURE_2D, 0, (GLint)resource.desc.format, resource.desc.width, resource.desc.height, 0,
+            info.format, info.type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, depth ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GLState::BindTexture(0, GL_TEXTURE_2D, 0);
+        MemoryTracker::Allocate(MemoryCategory::RenderTarget, physical.bytes);
+    } else {
+        // Redondeado a 4 KB para reutilizarlo si el tamano pedido varia poco
+        physical.bytes = (resource.bytes + 4095) & ~(size_t)4095;
+        glGenBuffers(1, &physical.object);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, physical.object);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)physical.bytes, nullptr, GL_DYNAMIC_DRAW);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+        MemoryTracker::Allocate(MemoryCategory::DynamicBuffer, physical.bytes);
+    }
+
+    mPhysical.push_back(physical);
+    return (int)mPhysical.size() - 1;
+}
+
+void RenderGraph::ReleaseUnused() {
+    for (size_t i = 0; i < mPhysical.size();) {
+        if (mFrame - mPhysical[i].lastFrame > kRetainFrames) {
+            DestroyPhysical(mPhysical[i]);
+            mPhysical.erase(mPhysical.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void RenderGraph::DestroyPhysical(Physical& physical) {
+    if (physical.kind == kTexture) {
+        // Fuera los framebuffers que la usaban
+        for (size_t i = 0; i < mFramebuffers.size();) {
+            const unsigned int* a = mFramebuffers[i].attachments;
+            if (std::find(a, a + 5, physical.object) != a + 5) {
+                glDeleteFramebuffers(1, &mFramebuffers[i].fbo);
+                mFramebuffers.erase(mFramebuffers.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+        GLState::DeleteTextures(1, &physical.object);
+        MemoryTracker::Free(MemoryCategory::RenderTarget, physical.bytes);
+    } else {
+        GLState::DeleteBuffers(1, &physical.object);
+        MemoryTracker::Free(MemoryCategory::DynamicBuffer, physical.bytes);
+    }
+    physical.object = 0;
+}
+
+unsigned int RenderGraph::GetFramebuffer(const unsigned int attachments[5]) const {
+    for (const CachedFramebuffer& cached : mFramebuffers) {
+        if (std::equal(attachments, attachments + 5, cached.attachments)) return cached.fbo;
+    }
+
+    CachedFramebuffer cached;
+    std::copy(attachments, attachments + 5, cached.attachments);
+    glGenFramebuffers(1, &cached.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, cached.fbo);
+
+    GLenum drawBuffers[4];
+    int colorCount = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!attachments[i]) continue;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + colorCount, GL_TEXTURE_2D, attachments[i], 0);
+        drawBuffers[colorCount] = GL_COLOR_ATTACHMENT0 + colorCount;
+        colorCount++;
+    }
+    if (attachments[4]) {
+        GLenum attachment = GL_DEPTH_ATTACHMENT;
+        for (const Physical& physical : mPhysical) {
+            if (physical.kind == kTexture && physical.object == attachments[4]) {
+                attachment = GetFormatInfo(physical.desc.format).attachment;
+            }
+        }
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, attachments[4], 0);
+    }
+    if (colorCount > 0) {
+        glDrawBuffers(colorCount, drawBuffers);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+    } else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "RenderGraph: incomplete framebuffer (0x" << std::hex << status << std::dec << ")\n";
+    }
+    mFramebuffers.push_back(cached);
+    return cached.fbo;
+}
+
+unsigned int RenderGraph::GetTexture(RGHandle texture) const {
+    if (!IsValid(texture) || mResources[texture].kind != kTexture || mResources[texture].physical < 0) return 0;
+    return mPhysical[mResources[texture].physical].object;
+}
+
+unsigned int RenderGraph::GetBuffer(RGHandle buffer) const {
+    if (!IsValid(buffer) || mResources[buffer].kind != kBuffer || mResources[buffer].physical < 0) return 0;
+    return mPhysical[mResources[buffer].physical].object;
+}
+
+unsigned int RenderGraph::GetReadFramebuffer(RGHandle texture) const {
+    unsigned int object = GetTexture(texture);
+    if (!object) return 0;
+    unsigned int attachments[5] = { 0, 0, 0, 0, 0 };
+    bool depth = GetFormatInfo(mResources[texture].desc.format).attachment != GL_COLOR_ATTACHMENT0;
+    attachments[depth ? 4 : 0] = object;
+    return GetFramebuffer(attachments);
+}
+
+void RenderGraph::Execute() {
+    if (!mCompiled) Compile();
+
+    int backbufferW = 0, backbufferH = 0;
+    for (int index : mOrder) {
+        const Pass& pass = mPasses[index];
+
+        // Framebuffer del pase: el por defecto si escribe el backbuffer
+        unsigned int attachments[5] = { 0, 0, 0, 0, 0 };
+        bool toBackbuffer = false, hasTargets = false;
+        int width = 0, height = 0;
+        for (size_t i = 0; i < pass.colorTargets.size(); ++i) {
+            const Resource& resource = mResources[pass.colorTargets[i]];
+            if (resource.kind == kBackbuffer) {
+                toBackbuffer = true;
+                backbufferW = resource.desc.width;
+                backbufferH = resource.desc.height;
+            } else {
+                attachments[i] = GetTexture(pass.colorTargets[i]);
+            }
+            width = resource.desc.width;
+            height = resource.desc.height;
+            hasTargets = true;
+        }
+        if (IsValid(pass.depthTarget)) {
+            const Resource& resource = mResources[pass.depthTarget];
+            attachments[4] = GetTexture(pass.depthTarget);
+            width = resource.desc.width;
+            height = resource.desc.height;
+            hasTargets = true;
+        }
+
+        if (toBackbuffer) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            GLState::Viewport(0, 0, width, height);
+        } else if (hasTargets) {
+            glBindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer(attachments));
+            GLState::Viewport(0, 0, width, height);
+        }
+
+        if (pass.execute) pass.execute(*this);
+        GL_CHECK(pass.name);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (backbufferW > 0 && backbufferH > 0) {
+        GLState::Viewport(0, 0, backbufferW, backbufferH);
+    }
+}
+
+void RenderGraph::PrintStats() const {
+    std::cout << "Render graph: " << mOrder.size() << "/" << mPasses.size() << " passes (";
+    for (size_t i = 0; i < mOrder.size(); ++i) {
+        std::cout << (i ? " -> " : "") << mPasses[mOrder[i]].name;
+    }
+    std::cout << ")";
+    bool anyCulled = false;
+    for (const Pass& pass : mPasses) {
+        if (pass.alive) continue;
+        std::cout << (anyCulled ? ", " : ", culled: ") << pass.name;
+        anyCulled = true;
+    }
+    std::cout << std::endl;
+
+    size_t transient = 0, physicalCount = 0;
+    for (const Resource& resource : mResources) {
+        if ((resource.kind == kTexture || resource.kind == kBuffer) && resource.physical >= 0) transient++;
+    }
+    for (const Physical& physical : mPhysical) {
+        if (physical.lastFrame == mFrame) physicalCount++;
+    }
+    size_t saved = mVirtualBytes > mPhysicalBytes ? mVirtualBytes - mPhysicalBytes : 0;
+    std::cout << "  Transients: " << transient << " -> " << physicalCount << " physical ("
+        << (mVirtualBytes >> 10) << " KB -> " << (mPhysicalBytes >> 10) << " KB, aliasing saved "
+        << (saved >> 10) << " KB, " << mAliasedResources << " aliased), pool " << mPhysical.size() << std::endl;
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Recurso virtual del grafo (indice del frame; -1 = ninguno)
+typedef int RGHandle;
+
+struct RGTextureDesc {
+    int width = 0;
+    int height = 0;
+    unsigned int format = 0;    // formato interno de GL (GL_RGBA8, GL_DEPTH_COMPONENT24...)
+};
+
+class RenderGraph;
+
+// Lo que un pase declara al anadirse: recursos que crea, lee y escribe
+class RenderGraphBuilder {
+public:
+    // Transitorios: viven del primer al ultimo pase que los usa
+    RGHandle CreateTexture(const char* name, const RGTextureDesc& desc);
+    RGHandle CreateBuffer(const char* name, size_t bytes);
+
+    void Read(RGHandle resource);
+    // Escritura sin attachment (buffers, recursos importados)
+    void Write(RGHandle resource);
+    // Attachments del framebuffer del pase; el color en orden de declaracion
+    void WriteColor(RGHandle texture);
+    void WriteDepth(RGHandle texture);
+    // No se descarta aunque nadie lea lo que escribe
+    void SetSideEffect();
+
+private:
+    friend class RenderGraph;
+    RenderGraphBuilder(RenderGraph& graph, int pass) : mGraph(graph), mPass(pass) {}
+    RenderGraph& mGraph;
+    int mPass;
+};
+
+// Grafo de render que se reconstruye cada frame. Los pases declaran lo que
+// leen y escriben; Compile() descarta los que no llegan a ninguna salida, los
+// ordena por dependencias y asigna a los transitorios texturas y buffers
+// fisicos de un pool: dos recursos con la misma descripcion cuyas vidas no se
+// solapan comparten el mismo objeto de GL (GL no permite solapar memoria
+// entre texturas distintas). Execute() enlaza el framebuffer y el viewport
+// de cada pase antes de llamarlo.
+class RenderGraph {
+public:
+    typedef std::function<void(RenderGraphBuilder&)> SetupFn;
+    typedef std::function<void(const RenderGraph&)> ExecuteFn;
+
+    // Frames sin usarse antes de liberar un recurso fisico
+    static const unsigned kRetainFrames = 8;
+
+    RenderGraph();
+
+    void Shutdown();
+
+    // Vacia los pases y recursos del frame anterior (el pool se conserva)
+    void Reset();
+
+    // Framebuffer por defecto; escribirlo cuenta como salida del frame
+    RGHandle ImportBackbuffer(const char* name, int width, int height);
+    // Recurso gestionado fuera del grafo (p. ej. las cascadas de sombra):
+    // solo participa en las dependencias
+    RGHandle Import(const char* name);
+
+    // 'setup' se llama en el acto; 'execute' en Execute() si el pase sobrevive
+    void AddPass(const char* name, const SetupFn& setup, const ExecuteFn& execute);
+
+    bool Compile();
+    void Execute();
+
+    // Objetos de GL asignados (validos durante Execute)
+    unsigned int GetTexture(RGHandle texture) const;
+    unsigned int GetBuffer(RGHandle buffer) const;
+    // Framebuffer de lectura con la textura como unico attachment (blits)
+    unsigned int GetReadFramebuffer(RGHandle texture) const;
+
+    size_t GetPassCount() const { return mPasses.size(); }
+    size_t GetCulledPassCount() const { return mPasses.size() - mOrder.size(); }
+    size_t GetVirtualBytes() const { return mVirtualBytes; }
+    size_t GetPhysicalBytes() const { return mPhysicalBytes; }
+    void PrintStats() const;
+
+private:
+    friend class RenderGraphBuilder;
+
+    enum ResourceKind { kTexture, kBuffer, kBackbuffer, kExternal };
+
+    struct Resource {
+        const char* name;
+        ResourceKind kind;
+        RGTextureDesc desc;
+        size_t bytes;
+        int producer;           // pase que lo crea (-1 = importado)
+        int firstUse, lastUse;  // posiciones en mOrder
+        int physical;           // indice en mPhysical
+    };
+
+    struct Pass {
+        const char* name;
+        ExecuteFn execute;
+        std::vector<RGHandle> reads;
+        std::vector<RGHandle> writes;
+        std::vector<RGHandle> colorTargets;
+        RGHandle depthTarget;
+        bool sideEffect;
+        bool alive;
+    };
+
+    struct Physical {
+        ResourceKind kind;
+        RGTextureDesc desc;
+        size_t bytes;
+        unsigned int object;
+        unsigned long long lastFrame;   // ultimo frame en que se uso
+        int busyUntil;                  // ultima posicion ocupada este frame (-1 = libre)
+    };
+
+    struct CachedFramebuffer {
+        unsigned int attachments[5];    // 4 de color + profundidad
+        unsigned int fbo;
+    };
+
+    std::vector<Resource> mResources;
+    std::vector<Pass> mPasses;
+    std::vector<int> mOrder;            // pases vivos en orden de ejecucion
+    std::vector<Physical> mPhysical;
+    mutable std::vector<CachedFramebuffer> mFramebuffers;
+    unsigned long long mFrame;
+    size_t mVirtualBytes, mPhysicalBytes;
+    size_t mAliasedResources;
+    bool mCompiled;
+
+    RGHandle AddResource(const char* name, ResourceKind kind, const RGTextureDesc& desc, size_t bytes, int producer);
+    bool IsValid(RGHandle resource) const { return resource >= 0 && resource < (int)mResources.size(); }
+    int AcquirePhysical(const Resource& resource);
+    void ReleaseUnused();
+    void DestroyPhysical(Physical& physical);
+    unsigned int GetFramebuffer(const unsigned int attachments[5]) const;
+};
@@ -0,0 +1,224 @@
+#include "RenderThread.h"
+#include "JobSystem.h"
+#include "Window.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static std::thread sThread;
+static Window* sWindow = nullptr;
+static bool sRunning = false;
+
+// Doble buffer: una lista se graba mientras la otra se ejecuta
+static RenderCommandList sLists[2];
+static int sRecording = 0;
+static unsigned long long sFrame = 0;
+
+// Estado compartido con el hilo de render
+static std::mutex sMutex;
+static std::condition_variable sCondition;
+static int sPending = -1;       // lista enviada que el render aun no ha cogido
+static int sExecuting = -1;     // lista que esta ejecutando
+static bool sQuit = false;
+static bool sContextReady = false;
+
+// Respuestas de Request para el hilo principal
+static std::mutex sReplyMutex;
+static std::vector<std::function<void()>> sReplies;
+
+// Tiempos desde el ultimo PrintStats; los del render con sMutex
+static Clock::time_point sStatsStart = Clock::now();
+static unsigned long long sStatsFrames = 0;
+static double sMainWaitMs = 0.0;
+static double sRenderBusyMs = 0.0;
+static double sRenderIdleMs = 0.0;
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool RenderThread::Start(Window* window) {
+    if (sRunning) return true;
+    if (!window) return false;
+
+    // El contexto y el worker 0 del JobSystem pasan al hilo de render
+    sWindow = window;
+    window->ReleaseContext();
+    JobSystem::ReleaseWorker0();
+    sQuit = false;
+    sContextReady = false;
+    sPending = sExecuting = -1;
+    sThread = std::thread(ThreadMain, window);
+
+    // El contexto tiene que estar actual alli antes de la primera lista
+    std::unique_lock<std::mutex> lock(sMutex);
+    sCondition.wait(lock, [] { return sContextReady || sQuit; });
+    if (sQuit) {
+        lock.unlock();
+        sThread.join();
+        window->MakeContextCurrent();
+        JobSystem::AcquireWorker0();
+        std::cerr << "Render thread: could not take the GL context, rendering on the main thread" << std::endl;
+        return false;
+    }
+
+    sRunning = true;
+    sStatsStart = Clock::now();
+    sStatsFrames = 0;
+    sMainWaitMs = sRenderBusyMs = sRenderIdleMs = 0.0;
+    std::cout << "Render thread: ON" << std::endl;
+    return true;
+}
+
+void RenderThread::Stop() {
+    if (!sRunning) return;
+
+    // Lo que quede grabado sale como un frame mas
+    if (!sLists[sRecording].commands.empty()) EndFrame();
+
+    {
+        std::unique_lock<std::mutex> lock(sMutex);
+        sCondition.wait(lock, [] { return sPending < 0 && sExecuting < 0; });
+        sQuit = true;
+    }
+    sCondition.notify_all();
+    sThread.join();
+    sRunning = false;
+
+    // El hilo solto el contexto y el worker 0 al salir; las ultimas
+    // respuestas se entregan ya
+    sWindow->MakeContextCurrent();
+    JobSystem::AcquireWorker0();
+    BeginFrame();
+    std::cout << "Render thread: OFF" << std::endl;
+}
+
+bool RenderThread::IsRunning() {
+    return sRunning;
+}
+
+void RenderThread::Enqueue(std::function<void()> command) {
+    if (!sRunning) {
+        command();
+        return;
+    }
+    sLists[sRecording].commands.push_back(std::move(command));
+}
+
+void RenderThread::Request(std::function<void()> renderSide, std::function<void()> mainSide) {
+    if (!sRunning) {
+        renderSide();
+        mainSide();
+        return;
+    }
+    sLists[sRecording].commands.push_back([renderSide, mainSide] {
+        renderSide();
+        std::lock_guard<std::mutex> lock(sReplyMutex);
+        sReplies.push_back(mainSide);
+    });
+}
+
+void RenderThread::BeginFrame() {
+    std::vector<std::function<void()>> replies;
+    {
+        std::lock_guard<std::mutex> lock(sReplyMutex);
+        replies.swap(sReplies);
+    }
+    for (auto& reply : replies) reply();
+}
+
+void RenderThread::EndFrame() {
+    sStatsFrames++;
+    if (!sRunning) return;
+
+    const int submitted = sRecording;
+    const int next = 1 - submitted;
+    sLists[submitted].frame = sFrame++;
+
+    auto waitStart = Clock::now();
+    {
+        std::unique_lock<std::mutex> lock(sMutex);
+        // El render tiene que haber cogido la lista anterior
+        sCondition.wait(lock, [] { return sPending < 0; });
+        sPending = submitted;
+        sCondition.notify_all();
+        // y terminado la que se va a volver a grabar: un frame por delante
+        sCondition.wait(lock, [next] { return sExecuting != next; });
+    }
+    sMainWaitMs += MsSince(waitStart);
+
+    sRecording = next;
+    sLists[next].commands.clear();
+}
+
+void RenderThread::ThreadMain(Window* window) {
+    bool current = window->MakeContextCurrent();
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        if (current) sContextReady = true;
+        else sQuit = true;
+    }
+    sCondition.notify_all();
+    if (!current) return;
+
+    // Los ParallelFor del Renderer se lanzan desde aqui
+    JobSystem::AcquireWorker0();
+
+    std::unique_lock<std::mutex> lock(sMutex);
+    for (;;) {
+        auto idleStart = Clock::now();
+        sCondition.wait(lock, [] { return sPending >= 0 || sQuit; });
+        sRenderIdleMs += MsSince(idleStart);
+        if (sPending < 0) break;
+
+        sExecuting = sPending;
+        sPending = -1;
+        RenderCommandList& list = sLists[sExecuting];
+        lock.unlock();
+        sCondition.notify_all();
+
+        auto busyStart = Clock::now();
+        for (auto& command : list.commands) command();
+        double busyMs = MsSince(busyStart);
+
+        lock.lock();
+        sRenderBusyMs += busyMs;
+        sExecuting = -1;
+        sCondition.notify_all();
+    }
+    lock.unlock();
+
+    JobSystem::ReleaseWorker0();
+    window->ReleaseContext();
+}
+
+void RenderThread::PrintStats() {
+    if (!sRunning || sStatsFrames == 0) return;
+
+    double wallMs = MsSince(sStatsStart);
+    double renderBusyMs, renderIdleMs;
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        renderBusyMs = sRenderBusyMs;
+        renderIdleMs = sRenderIdleMs;
+        sRenderBusyMs = sRenderIdleMs = 0.0;
+    }
+    // Con los dos hilos ocupados a la vez, la suma pasa del tiempo real
+    double mainBusyMs = std::max(0.0, wallMs - sMainWaitMs);
+    double overlapMs = std::max(0.0, mainBusyMs + renderBusyMs - wallMs);
+    double frames = (double)sStatsFrames;
+
+    std::cout << "Render thread: main " << (mainBusyMs / frames) << " ms busy + " << (sMainWaitMs / frames)
+        << " ms waiting, render " << (renderBusyMs / frames) << " ms busy + " << (renderIdleMs / frames)
+        << " ms idle per frame, overlap " << (overlapMs / frames) << " ms (" << sStatsFrames << " frames)" << std::endl;
+
+    sStatsStart = Clock::now();
+    sStatsFrames = 0;
+    sMainWaitMs = 0.0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+class Window;
+
+// Comandos de un frame. El hilo principal la graba y la envia en EndFrame;
+// desde ahi es inmutable hasta que el hilo de render la ha ejecutado. Los
+// comandos capturan por valor lo que necesitan (vista de la camara, dt...).
+struct RenderCommandList {
+    std::vector<std::function<void()>> commands;
+    unsigned long long frame = 0;
+};
+
+// Hilo de render: es el dueno del contexto de GL y ejecuta las listas que
+// graba el hilo principal, con doble buffer. El principal puede ir un frame
+// por delante: graba el N+1 mientras se ejecuta el N, y espera si el render
+// aun no ha terminado el N-1. Sin hilo (Start no llamado o Stop) los
+// comandos se ejecutan al encolarlos, en el mismo orden.
+//
+// Todo lo que toque GL o el estado del Renderer tiene que pasar por
+// Enqueue/Request. Mientras corre, el hilo de render es tambien el worker 0
+// del JobSystem. SDL_GL_SwapWindow desde otro hilo funciona en Windows y
+// Linux; en macOS habria que dejar el render en el hilo principal.
+class RenderThread {
+public:
+    // Llamar desde el hilo con el contexto actual, fuera de un frame
+    static bool Start(Window* window);
+    // Ejecuta lo enviado, para el hilo y devuelve el contexto al que llama
+    static void Stop();
+    static bool IsRunning();
+
+    // Solo desde el hilo principal
+    static void Enqueue(std::function<void()> command);
+    // 'renderSide' en el hilo de render y 'mainSide' despues en el principal,
+    // en el primer BeginFrame tras ejecutarse
+    static void Request(std::function<void()> renderSide, std::function<void()> mainSide);
+
+    // Hilo principal: respuestas de Request al empezar el frame y envio de
+    // la lista al acabarlo
+    static void BeginFrame();
+    static void EndFrame();
+
+    // Tiempos por hilo desde la ultima llamada (ocupado, esperando, solape)
+    static void PrintStats();
+
+private:
+    static void ThreadMain(Window* window);
+};
@@ -1,19 +1,44 @@
 #include "Renderer.h"
+#include "GLState.h"
 #include "Shader.h"
 #include "Camera.h"
 #include "Texture.h"
+#include "TextureArray.h"
+#include "JobSystem.h"
+#include "PageFile.h"
+#include "StreamingManager.h"
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+#include "ClusteredLighting.h"
+#include "ShadowCascades.h"
+#include "RayPicker.h"
+#include "MemoryTracker.h"
+#include "MemoryArena.h"
+#include "MeshBuilder.h"
+#include "ModelCache.h"
+#include "SkinningSystem.h"
+#include "RenderGraph.h"
+#include "DynamicResolution.h"
+#include "UniformBuffers.h"
+#include "RingBuffer.h"
+#include "GLTrace.h"
 #include <glad/glad.h>
 
 #include <string>
 #include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
 #include <iostream>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <filesystem>
+#include <chrono>
+#include <random>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
-#include <assimp/postprocess.h>
 
 // Recursos estticos
 unsigned int Renderer::sProgram = 0;
@@ -23,9 +48,22 @@ unsigned int Renderer::sRectVAO = 0;
 unsigned int Renderer::sRectVBO = 0;
 unsigned int Renderer::sRectEBO = 0;
 bool Renderer::sWireframeMode = false;
+bool Renderer::sClusterCulling = true;
+bool Renderer::sOcclusionCulling = true;
+bool Renderer::sOcclusionQueries = true;
+bool Renderer::sDepthPrepass = true;
+bool Renderer::sOverdrawHeatmap = false;
 
 unsigned int Renderer::sModelProgram = 0;
 unsigned int Renderer::sModelProgramTextured = 0;
+unsigned int Renderer::sBoxProgram = 0;
+unsigned int Renderer::sDepthProgram = 0;
+unsigned int Renderer::sModelProgramSkinned = 0;
+unsigned int Renderer::sModelProgramTexturedSkinned = 0;
+unsigned int Renderer::sDepthProgramSkinned = 0;
+unsigned int Renderer::sBoxVAO = 0;
+unsigned int Renderer::sBoxVBO = 0;
+unsigned int Renderer::sBoxEBO = 0;
 
 
 float Renderer::sModelCenterX = 0.0f;
@@ -34,12 +72,113 @@ float Renderer::sModelCenterZ = 0.0f;
 float Renderer::sModelSize = 0.0f;
 
 std::vector<Mesh> Renderer::sMeshes;
+std::vector<Meshlet> Renderer::sMeshlets;
+std::vector<StaticBatchPart> Renderer::sBatchParts;
 std::vector<Material> Renderer::sMaterials;
+std::vector<TextureArray*> Renderer::sTextureArrays;
 
 int Renderer::sViewportW = 800;
 int Renderer::sViewportH = 600;
 
+std::string Renderer::sLastModelPath;
+StreamingManager* Renderer::sStreaming = nullptr;
+
 static bool sInitialized = false;
+static GLsync sFrameFence = nullptr;
+
+// Temporales de la importacion; se descartan al terminar cada carga
+static LinearArena sImportArena(16u << 20, 256u << 20, MemoryCategory::Import);
+// Datos de un solo frame (listas de dibujo, claves de orden), alternados
+static FrameAllocator sFrameAllocator(1u << 20, 16u << 20);
+
+// Resultado del culling por meshlet y rangos para glMultiDrawElements.
+// Todo lo de este bloque vive en sFrameAllocator.
+static unsigned char* sMeshletVisible = nullptr;
+static ArenaVector<GLsizei> sDrawCounts;
+static ArenaVector<const void*> sDrawOffsets;
+
+static OcclusionCuller sOcclusionCuller;
+
+#ifndef GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+#define GL_ANY_SAMPLES_PASSED_CONSERVATIVE 0x8D6A
+#endif
+
+// Occlusion queries: solo para meshes con al menos este numero de indices
+static const size_t kQueryMinIndices = 30000;
+// Los meshes visibles se vuelven a consultar cada N frames (coherencia temporal)
+static const unsigned kVisibleRequeryInterval = 4;
+
+static GLenum sQueryTarget = GL_ANY_SAMPLES_PASSED;
+static unsigned int sDrawFrame = 0;
+static ArenaVector<size_t> sQueryCandidates;
+
+// Mesh visible en este frame; sus rangos estan en sDrawCounts/sDrawOffsets
+struct DrawItem {
+    size_t mesh;
+    size_t firstRange;
+    size_t rangeCount;   // 0 = mesh sin meshlets, se dibuja entero
+    float depth;         // profundidad en vista del centro de la AABB
+    bool conditional;
+};
+static ArenaVector<DrawItem> sDrawItems;
+static ArenaVector<DrawItem> sSortedItems;
+
+// Muestras sombreadas del pase de color, leidas con un frame de retraso
+static GLuint sOverdrawQuery = 0;
+static bool sOverdrawQueryPending = false;
+static double sShadedSamplesPerPixel = 0.0;
+
+// Occluders: meshes con diagonal >= 10% de la escena, hasta este total
+static const float kOccluderMinSizeRatio = 0.1f;
+static const size_t kOccluderTriangleBudget = 150000;
+
+// Luces puntuales asignadas a clusters cada frame
+static ClusteredLighting sLighting;
+static const size_t kDefaultLightCount = 256;
+static const size_t kMaxLightCount = 16384;
+
+// Sombras del sol; lo estatico se cachea entre frames
+static ShadowCascades sShadows;
+
+// Paletas de huesos de las instancias animadas
+static SkinningSystem sSkinning;
+static const size_t kAnimatedInstanceSteps[] = { 1, 16, 128, 512 };
+
+// BVH de todos los meshes para picking con el raton
+static RayPicker sPicker;
+
+// Pases del frame y targets transitorios (se reconstruye en cada DrawLoadedModel)
+static RenderGraph sRenderGraph;
+// Color con el que el pase Opaque limpia SceneColor (el de Clear)
+static float sClearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+// Escala de la escena segun el tiempo de GPU; sRenderW/H es el area dibujada
+// este frame dentro de los targets y Present la escala a la ventana
+static DynamicResolution sDynamicResolution;
+static int sRenderW = 800;
+static int sRenderH = 600;
+
+// Datos dinamicos del frame (por ahora los bloques de vista), triple buffer
+static RingBuffer sFrameRing;
+static const size_t kFrameRingBytes = 64u << 10;
+
+// Bloques std140 de vista y materiales (binding points fijos)
+static UniformBuffers sUniforms;
+
+// Estadisticas por frame: el que se esta grabando y el ultimo completo
+static FrameStats sFrameStats;
+static FrameStats sLastFrameStats;
+static unsigned long long sStatsFrame = 0;
+static std::chrono::steady_clock::time_point sFrameStart;
+static std::chrono::steady_clock::time_point sLastSummary;
+static const double kStatsSummarySeconds = 2.0;
+static bool sPrintFrameDetails = false;
+static const char* kGLTracePath = "gltrace.bin";
+static const size_t kGLTraceMaxBytes = 64u << 20;
+
+// Lotes estaticos al cargar: meshes pequenos del mismo material en un VAO
+static bool sStaticBatching = true;
+static StaticBatchSettings sBatchSettings;
 
 // Shaders
 static const char* kVertexSrc = R"(#version 330 core
@@ -54,31 +193,89 @@ void main(){ FragColor = vec4(1.0, 0.5, 0.2, 1.0); }
 
 static const char* kModelVS = R"(#version 330 core
 layout (location = 0) in vec3 aPos;
-uniform mat4 uMVP;
+layout (location = 2) in vec3 aNormal;
+out vec3 vWorldPos;
+out vec3 vNormal;
+invariant gl_Position;
 void main(){ 
-    gl_Position = uMVP * vec4(aPos, 1.0); 
+    vec3 pos = aPos;
+    vec3 normal = aNormal;
+#ifdef SKINNED
+    LoadSkin();
+    pos = SkinPoint(aPos);
+    normal = SkinDir(aNormal);
+#endif
+    gl_Position = uViewProj * vec4(pos, 1.0); 
+    vWorldPos = pos;
+    vNormal = normal;
 }
 )";
 
+// ApplyLighting() viene de ClusteredLighting y MaterialColor() de
+// UniformBuffers (se insertan tras #version)
 static const char* kModelFS = R"(#version 330 core
 out vec4 FragColor;
-uniform vec3 uColor;
 void main(){ 
-    FragColor = vec4(uColor, 1.0);
+    FragColor = vec4(ApplyLighting(MaterialColor().rgb), 1.0);
+}
+)";
+
+// Depth prepass: misma transformacion que los shaders de color (invariant)
+static const char* kDepthVS = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+invariant gl_Position;
+void main(){
+    vec3 pos = aPos;
+#ifdef SKINNED
+    LoadSkin();
+    pos = SkinPoint(aPos);
+#endif
+    gl_Position = uViewProj * vec4(pos, 1.0);
+}
+)";
+
+static const char* kDepthFS = R"(#version 330 core
+void main(){ }
+)";
+
+// Caja unitaria escalada a la AABB del mesh (solo profundidad)
+static const char* kBoxVS = R"(#version 330 core
+layout (location = 0) in vec3 aPos;
+uniform vec3 uBoxMin;
+uniform vec3 uBoxMax;
+void main(){
+    gl_Position = uViewProj * vec4(mix(uBoxMin, uBoxMax, aPos), 1.0);
 }
 )";
 
+static const char* kBoxFS = R"(#version 330 core
+out vec4 FragColor;
+void main(){ FragColor = vec4(1.0); }
+)";
+
 static const char* kModelTexturedVS = R"(#version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aNormal;
 
 out vec2 TexCoord;
+out vec3 vWorldPos;
+out vec3 vNormal;
 
-uniform mat4 uMVP;
+invariant gl_Position;
 
 void main(){ 
-    gl_Position = uMVP * vec4(aPos, 1.0);
+    vec3 pos = aPos;
+    vec3 normal = aNormal;
+#ifdef SKINNED
+    LoadSkin();
+    pos = SkinPoint(aPos);
+    normal = SkinDir(aNormal);
+#endif
+    gl_Position = uViewProj * vec4(pos, 1.0);
     TexCoord = aTexCoord;
+    vWorldPos = pos;
+    vNormal = normal;
 }
 )";
 
@@ -87,28 +284,24 @@ out vec4 FragColor;
 
 in vec2 TexCoord;
 
-uniform sampler2D uTexture;
-uniform bool uHasTexture;
-uniform vec3 uColor;
+uniform sampler2DArray uTextureArray;
 
 void main(){ 
-    if (uHasTexture) {
-        FragColor = texture(uTexture, TexCoord);
-    } else {
-        FragColor = vec4(uColor, 1.0);
-    }
+    vec4 params = uMaterials[uMaterialIndex].params;
+    vec4 albedo = params.y > 0.5 ? texture(uTextureArray, vec3(TexCoord, params.x)) : MaterialColor();
+    FragColor = vec4(ApplyLighting(albedo.rgb), albedo.a);
 }
 )";
 
-// Helpers de matrices
+// Helpers de matrices (column-major, como Camera): o = a * b
 static void MatMul(float o[16], const float a[16], const float b[16]) {
     float r[16];
-    for (int row = 0; row < 4; ++row)
-        for (int col = 0; col < 4; ++col)
-            r[col + row * 4] = a[0 + row * 4] * b[col + 0 * 4]
-            + a[1 + row * 4] * b[col + 1 * 4]
-            + a[2 + row * 4] * b[col + 2 * 4]
-            + a[3 + row * 4] * b[col + 3 * 4];
+    for (int col = 0; col < 4; ++col)
+        for (int row = 0; row < 4; ++row)
+            r[row + col * 4] = a[row + 0 * 4] * b[0 + col * 4]
+            + a[row + 1 * 4] * b[1 + col * 4]
+            + a[row + 2 * 4] * b[2 + col * 4]
+            + a[row + 3 * 4] * b[3 + col * 4];
     for (int i = 0; i < 16; ++i) o[i] = r[i];
 }
 
@@ -117,11 +310,95 @@ static void MatIdentity(float m[16]) {
     m[0] = m[5] = m[10] = m[15] = 1.f;
 }
 
+// Inversa por cofactores; false si la matriz es singular
+static bool MatInverse(float o[16], const float m[16]) {
+    float inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f) return false;
+    float invDet = 1.0f / det;
+    for (int i = 0; i < 16; ++i) o[i] = inv[i] * invDet;
+    return true;
+}
+
+static bool HasGLExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (ext && std::strcmp(ext, name) == 0) return true;
+    }
+    return false;
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// Descarta meshlets fuera del frustum o con todos sus triangulos de espaldas
+static bool IsMeshletVisible(const Meshlet& m, const Frustum& frustum, const float cameraPos[3], bool coneCulling) {
+    if (!frustum.IntersectsSphere(m.center, m.radius)) return false;
+
+    if (coneCulling && m.coneCutoff < 1.0f) {
+        float d[3] = { m.center[0] - cameraPos[0], m.center[1] - cameraPos[1], m.center[2] - cameraPos[2] };
+        float dist = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        float along = d[0] * m.coneAxis[0] + d[1] * m.coneAxis[1] + d[2] * m.coneAxis[2];
+        // Conservador para cualquier punto de la esfera
+        if (along >= m.coneCutoff * dist + m.radius * (1.0f + m.coneCutoff)) return false;
+    }
+    return true;
+}
+
+// Bloques FrameData y MaterialData tras la linea #version
+static std::string WithUniformBlocks(const char* src, const std::string& extra = std::string()) {
+    std::string out(src);
+    size_t lineEnd = out.find('\n');
+    out.insert(lineEnd + 1, UniformBuffers::GetShaderSource() + extra);
+    return out;
+}
+
+// Inserta el GLSL de iluminacion y sombras tras la linea #version del fragment shader
+static std::string WithLighting(const char* fragmentSrc) {
+    return WithUniformBlocks(fragmentSrc,
+        std::string(ClusteredLighting::GetShaderSource()) + ShadowCascades::GetShaderSource());
+}
+
+// Variante skinned de un vertex shader: SKINNED y el GLSL de la paleta
+static std::string WithSkinning(const char* vertexSrc) {
+    return WithUniformBlocks(vertexSrc, std::string("#define SKINNED\n") + SkinningSystem::GetShaderSource());
+}
+
+// Programa ya enlazado con sus bloques en los binding points fijos
+static unsigned int ReleaseWithBlocks(Shader& shader) {
+    unsigned int program = shader.ReleaseProgram();
+    UniformBuffers::BindBlocks(program);
+    return program;
+}
+
 bool Renderer::Init() {
     if (sInitialized) return true;
 
     std::cout << "=== Renderer::Init() ===" << std::endl;
 
+    // Lo que haya hecho la ventana antes no esta en la copia
+    GLState::Invalidate();
+
     // Shader tri/rect
     {
         Shader sh;
@@ -137,12 +414,12 @@ bool Renderer::Init() {
         float v[] = { -0.5f,-0.5f,0,  0.5f,-0.5f,0,  0.0f,0.5f,0 };
         glGenVertexArrays(1, &sTriVAO);
         glGenBuffers(1, &sTriVBO);
-        glBindVertexArray(sTriVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, sTriVBO);
+        GLState::BindVertexArray(sTriVAO);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, sTriVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(v), v, GL_STATIC_DRAW);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
-        glBindVertexArray(0);
+        GLState::BindVertexArray(0);
     }
 
     // VAO/VBO/EBO rectngulo
@@ -152,36 +429,121 @@ bool Renderer::Init() {
         glGenVertexArrays(1, &sRectVAO);
         glGenBuffers(1, &sRectVBO);
         glGenBuffers(1, &sRectEBO);
-        glBindVertexArray(sRectVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, sRectVBO);
+        GLState::BindVertexArray(sRectVAO);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, sRectVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sRectEBO);
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, sRectEBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
-        glBindVertexArray(0);
+        GLState::BindVertexArray(0);
     }
 
     // Shader para modelo sin textura
     {
         Shader sh;
-        if (!sh.CompileFromSource(kModelVS, kModelFS)) {
+        std::string vs = WithUniformBlocks(kModelVS);
+        std::string fs = WithLighting(kModelFS);
+        if (!sh.CompileFromSource(vs.c_str(), fs.c_str())) {
             std::cerr << "Model shader compile/link failed\n";
             return false;
         }
-        sModelProgram = sh.ReleaseProgram();
+        sModelProgram = ReleaseWithBlocks(sh);
     }
 
     // Shader para modelo con textura
     {
         Shader sh;
-        if (!sh.CompileFromSource(kModelTexturedVS, kModelTexturedFS)) {
+        std::string vs = WithUniformBlocks(kModelTexturedVS);
+        std::string fs = WithLighting(kModelTexturedFS);
+        if (!sh.CompileFromSource(vs.c_str(), fs.c_str())) {
             std::cerr << "Model textured shader compile/link failed\n";
             return false;
         }
-        sModelProgramTextured = sh.ReleaseProgram();
+        sModelProgramTextured = ReleaseWithBlocks(sh);
     }
 
+    // Shader del depth prepass
+    {
+        Shader sh;
+        std::string vs = WithUniformBlocks(kDepthVS);
+        if (!sh.CompileFromSource(vs.c_str(), kDepthFS)) {
+            std::cerr << "Depth shader compile/link failed\n";
+            return false;
+        }
+        sDepthProgram = ReleaseWithBlocks(sh);
+    }
+
+    // Variantes skinned de los tres programas anteriores
+    {
+        Shader model, textured, depth;
+        std::string modelVS = WithSkinning(kModelVS);
+        std::string texturedVS = WithSkinning(kModelTexturedVS);
+        std::string depthVS = WithSkinning(kDepthVS);
+        std::string modelFS = WithLighting(kModelFS);
+        std::string texturedFS = WithLighting(kModelTexturedFS);
+        if (!model.CompileFromSource(modelVS.c_str(), modelFS.c_str()) ||
+            !textured.CompileFromSource(texturedVS.c_str(), texturedFS.c_str()) ||
+            !depth.CompileFromSource(depthVS.c_str(), kDepthFS)) {
+            std::cerr << "Skinned shader compile/link failed\n";
+            return false;
+        }
+        sModelProgramSkinned = ReleaseWithBlocks(model);
+        sModelProgramTexturedSkinned = ReleaseWithBlocks(textured);
+        sDepthProgramSkinned = ReleaseWithBlocks(depth);
+    }
+    glGenQueries(1, &sOverdrawQuery);
+
+    // Caja para occlusion queries
+    {
+        Shader sh;
+        std::string vs = WithUniformBlocks(kBoxVS);
+        if (!sh.CompileFromSource(vs.c_str(), kBoxFS)) {
+            std::cerr << "Box shader compile/link failed\n";
+            return false;
+        }
+        sBoxProgram = ReleaseWithBlocks(sh);
+
+        float verts[] = { 0,0,0, 1,0,0, 1,1,0, 0,1,0, 0,0,1, 1,0,1, 1,1,1, 0,1,1 };
+        unsigned idx[] = {
+            0,1,2, 0,2,3,  4,6,5, 4,7,6,  0,4,5, 0,5,1,
+            3,2,6, 3,6,7,  0,3,7, 0,7,4,  1,5,6, 1,6,2 };
+        glGenVertexArrays(1, &sBoxVAO);
+        glGenBuffers(1, &sBoxVBO);
+        glGenBuffers(1, &sBoxEBO);
+        GLState::BindVertexArray(sBoxVAO);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, sBoxVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, sBoxEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        GLState::BindVertexArray(0);
+    }
+
+    // La variante conservadora es de GL 4.3 / ARB_ES3_compatibility
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 3) || HasGLExtension("GL_ARB_ES3_compatibility")) {
+        sQueryTarget = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+    }
+    std::cout << "Occlusion query target: "
+        << (sQueryTarget == GL_ANY_SAMPLES_PASSED ? "GL_ANY_SAMPLES_PASSED" : "GL_ANY_SAMPLES_PASSED_CONSERVATIVE") << std::endl;
+
+    MemoryTracker::InitGPU();
+    sLighting.Init();
+    sShadows.Init();
+    sSkinning.Init();
+    sDynamicResolution.Init();
+
+    // Mapeo persistente con GL 4.4 / ARB_buffer_storage; si no, huerfanos
+    bool bufferStorage = major > 4 || (major == 4 && minor >= 4) || HasGLExtension("GL_ARB_buffer_storage");
+    GLint uboAlignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+    sFrameRing.Init(GL_UNIFORM_BUFFER, kFrameRingBytes, (size_t)std::max(uboAlignment, 1), bufferStorage);
+    sUniforms.Init(&sFrameRing);
+
     sInitialized = true;
     std::cout << "Renderer initialized successfully\n";
     return true;
@@ -190,65 +552,267 @@ bool Renderer::Init() {
 void Renderer::ClearModelData() {
     // Eliminar meshes
     for (auto& mesh : sMeshes) {
-        if (mesh.VAO) glDeleteVertexArrays(1, &mesh.VAO);
-        if (mesh.VBO) glDeleteBuffers(1, &mesh.VBO);
-        if (mesh.EBO) glDeleteBuffers(1, &mesh.EBO);
+        if (mesh.VAO) GLState::DeleteVertexArrays(1, &mesh.VAO);
+        if (mesh.VBO) GLState::DeleteBuffers(1, &mesh.VBO);
+        if (mesh.EBO) GLState::DeleteBuffers(1, &mesh.EBO);
+        if (mesh.occlusionQuery) glDeleteQueries(1, &mesh.occlusionQuery);
+        if (mesh.depthVAO) GLState::DeleteVertexArrays(1, &mesh.depthVAO);
+        if (mesh.positionVBO) GLState::DeleteBuffers(1, &mesh.positionVBO);
+        if (mesh.skinVBO) GLState::DeleteBuffers(1, &mesh.skinVBO);
+        MemoryTracker::Free(MemoryCategory::Vertex, mesh.vertexBytes);
+        MemoryTracker::Free(MemoryCategory::Index, mesh.indexBytes);
     }
     sMeshes.clear();
+    sMeshlets.clear();
+    sBatchParts.clear();
+    sOcclusionCuller.ClearOccluders();
+    sPicker.Clear();
+    sSkinning.Clear();
 
     // Eliminar materiales y texturas
-    for (auto& mat : sMaterials) {
-        if (mat.diffuseTexture) {
-            delete mat.diffuseTexture;
-            mat.diffuseTexture = nullptr;
+    sMaterials.clear();
+    sUniforms.SetMaterials(std::vector<MaterialBlock>());
+    for (auto* texArray : sTextureArrays) {
+        delete texArray;
+    }
+    sTextureArrays.clear();
+
+    delete sStreaming;
+    sStreaming = nullptr;
+}
+
+bool Renderer::OpenStreaming(const std::string& path) {
+    sStreaming = new StreamingManager();
+    if (!sStreaming->Open(path)) {
+        delete sStreaming;
+        sStreaming = nullptr;
+        return false;
+    }
+
+    const PageFileHeader& header = sStreaming->GetHeader();
+    sModelCenterX = header.center[0];
+    sModelCenterY = header.center[1];
+    sModelCenterZ = header.center[2];
+    sModelSize = std::max({ header.boundsMax[0] - header.boundsMin[0],
+        header.boundsMax[1] - header.boundsMin[1],
+        header.boundsMax[2] - header.boundsMin[2] });
+
+    // El benchmark de import necesita el fichero original: lo pone quien lo
+    // conoce (LoadModelFromPath), despues de abrir
+    sLastModelPath.clear();
+    return true;
+}
+
+bool Renderer::HasLoadedModel() {
+    return !sMeshes.empty() || sStreaming != nullptr;
+}
+
+void Renderer::BuildTextureArrays(const std::vector<std::string>& paths,
+    std::vector<int>& outArray, std::vector<int>& outLayer) {
+    outArray.assign(paths.size(), -1);
+    outLayer.assign(paths.size(), -1);
+
+    // Agrupar por (ancho, alto, canales): cada grupo comparte un GL_TEXTURE_2D_ARRAY
+    std::map<std::tuple<int, int, int>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        int w = 0, h = 0, channels = 0;
+        if (!Texture::GetImageInfo(paths[i].c_str(), w, h, channels)) {
+            std::cerr << "  Failed to read texture header: " << paths[i] << "\n";
+            continue;
+        }
+        groups[std::make_tuple(w, h, channels)].push_back(i);
+    }
+
+    GLint maxLayers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    if (maxLayers < 1) maxLayers = 1;
+
+    for (const auto& group : groups) {
+        const int w = std::get<0>(group.first);
+        const int h = std::get<1>(group.first);
+        const int channels = std::get<2>(group.first);
+        const std::vector<size_t>& members = group.second;
+
+        // Partir el grupo si supera el limite de capas del driver
+        for (size_t start = 0; start < members.size(); start += (size_t)maxLayers) {
+            size_t count = std::min(members.size() - start, (size_t)maxLayers);
+
+            TextureArray* texArray = new TextureArray();
+            if (!texArray->Create(w, h, channels, (int)count)) {
+                delete texArray;
+                continue;
+            }
+
+            int arrayIndex = (int)sTextureArrays.size();
+            for (size_t l = 0; l < count; ++l) {
+                size_t pathIndex = members[start + l];
+                if (texArray->LoadLayerFromFile((int)l, paths[pathIndex].c_str())) {
+                    outArray[pathIndex] = arrayIndex;
+                    outLayer[pathIndex] = (int)l;
+                }
+            }
+            texArray->GenerateMipmaps();
+            sTextureArrays.push_back(texArray);
+
+            std::cout << "  Texture array " << arrayIndex << ": " << w << "x" << h
+                << ", " << channels << " channels, " << count << " layers" << std::endl;
         }
     }
-    sMaterials.clear();
 }
 
 void Renderer::Shutdown() {
     if (!sInitialized) return;
 
-    if (sTriVAO) glDeleteVertexArrays(1, &sTriVAO);
-    if (sTriVBO) glDeleteBuffers(1, &sTriVBO);
-    if (sRectVAO) glDeleteVertexArrays(1, &sRectVAO);
-    if (sRectVBO) glDeleteBuffers(1, &sRectVBO);
-    if (sRectEBO) glDeleteBuffers(1, &sRectEBO);
-    if (sProgram) glDeleteProgram(sProgram);
-    if (sModelProgram) glDeleteProgram(sModelProgram);
-    if (sModelProgramTextured) glDeleteProgram(sModelProgramTextured);
+    // Escribe la traza si habia una abierta
+    GLTrace::Uninstall();
+    if (sTriVAO) GLState::DeleteVertexArrays(1, &sTriVAO);
+    if (sTriVBO) GLState::DeleteBuffers(1, &sTriVBO);
+    if (sRectVAO) GLState::DeleteVertexArrays(1, &sRectVAO);
+    if (sRectVBO) GLState::DeleteBuffers(1, &sRectVBO);
+    if (sRectEBO) GLState::DeleteBuffers(1, &sRectEBO);
+    if (sProgram) GLState::DeleteProgram(sProgram);
+    if (sModelProgram) GLState::DeleteProgram(sModelProgram);
+    if (sModelProgramTextured) GLState::DeleteProgram(sModelProgramTextured);
+    if (sBoxProgram) GLState::DeleteProgram(sBoxProgram);
+    if (sDepthProgram) GLState::DeleteProgram(sDepthProgram);
+    if (sModelProgramSkinned) GLState::DeleteProgram(sModelProgramSkinned);
+    if (sModelProgramTexturedSkinned) GLState::DeleteProgram(sModelProgramTexturedSkinned);
+    if (sDepthProgramSkinned) GLState::DeleteProgram(sDepthProgramSkinned);
+    if (sOverdrawQuery) glDeleteQueries(1, &sOverdrawQuery);
+    sOverdrawQuery = 0;
+    sOverdrawQueryPending = false;
+    if (sBoxVAO) GLState::DeleteVertexArrays(1, &sBoxVAO);
+    if (sBoxVBO) GLState::DeleteBuffers(1, &sBoxVBO);
+    if (sBoxEBO) GLState::DeleteBuffers(1, &sBoxEBO);
+    if (sFrameFence) glDeleteSync(sFrameFence);
+    sFrameFence = nullptr;
 
     ClearModelData();
+    sLighting.Shutdown();
+    sShadows.Shutdown();
+    sSkinning.Shutdown();
+    sRenderGraph.Shutdown();
+    sDynamicResolution.Shutdown();
+    sUniforms.Shutdown();
+    sFrameRing.Shutdown();
+
+    // Las listas apuntan a la arena de frame: se sueltan antes de liberarla
+    sMeshletVisible = nullptr;
+    sDrawCounts = ArenaVector<GLsizei>();
+    sDrawOffsets = ArenaVector<const void*>();
+    sQueryCandidates = ArenaVector<size_t>();
+    sDrawItems = ArenaVector<DrawItem>();
+    sSortedItems = ArenaVector<DrawItem>();
+    sFrameAllocator.Release();
+    sImportArena.Release();
 
     sInitialized = false;
 }
 
+// Cierra las estadisticas del frame anterior, antes de que los contadores de
+// GLState, GLTrace y el anillo se reinicien
+static void FinishFrameStats() {
+    auto now = std::chrono::steady_clock::now();
+    FrameStats& stats = sFrameStats;
+    stats.frameMs = stats.frame > 0 ? ElapsedMs(sFrameStart, now) : 0.0;
+    stats.gpuMs = sDynamicResolution.GetGpuMs();
+    stats.stateIssued = GLState::GetIssuedCalls();
+    stats.stateFiltered = GLState::GetFilteredCalls();
+    stats.ringBytes = sFrameRing.GetFrameBytes();
+
+    GLTrace::BeginFrame();
+    stats.glInstrumented = GLTrace::IsInstalled();
+    if (stats.glInstrumented) {
+        const GLCallCounters& gl = GLTrace::GetLastFrame();
+        stats.glCalls = gl.calls;
+        stats.drawCalls = gl.drawCalls;
+        stats.triangles = gl.triangles;
+        stats.instances = gl.instances;
+        stats.stateChanges = gl.stateChanges;
+        stats.uniformUpdates = gl.uniformUpdates;
+        stats.bufferUploads = gl.bufferUploads;
+        stats.bufferBytes = gl.bufferBytes;
+        stats.textureUploads = gl.textureUploads;
+        stats.textureBytes = gl.textureBytes;
+    }
+
+    sLastFrameStats = stats;
+    // El numero se pone al empezar: el detalle se imprime con el frame abierto
+    sFrameStats = FrameStats();
+    sFrameStats.frame = ++sStatsFrame;
+    sFrameStart = now;
+
+    if (!Renderer::HasLoadedModel() || ElapsedMs(sLastSummary, now) < kStatsSummarySeconds * 1000.0) return;
+    sLastSummary = now;
+
+    const FrameStats& last = sLastFrameStats;
+
+    std::cout << "Frame " << last.frame << ": " << last.frameMs << " ms (GPU " << last.gpuMs << " ms), "
+        << last.renderWidth << "x" << last.renderHeight
+        << " | " << last.drawItems << " meshes, meshlets " << last.visibleMeshlets << "/" << last.totalMeshlets
+        << ", " << last.multiDraws << " multi-draws, " << last.textureBinds << " texture binds";
+    if (last.skinnedDraws > 0) std::cout << ", " << last.skinnedDraws << " skinned";
+    std::cout << " | state cache " << last.stateIssued << " issued/" << last.stateFiltered << " filtered"
+        << ", ring " << (last.ringBytes >> 10) << " KB";
+    if (last.glInstrumented) {
+        std::cout << " | GL " << last.glCalls << " calls, " << last.drawCalls << " draws, "
+            << last.triangles << " tris, " << last.stateChanges << " state, " << last.uniformUpdates << " uniforms, "
+            << last.bufferUploads << " buffer uploads (" << (last.bufferBytes >> 10) << " KB), "
+            << last.textureUploads << " texture uploads (" << (last.textureBytes >> 10) << " KB)";
+    }
+    else {
+        std::cout << " | GL counters off";
+    }
+    std::cout << std::endl;
+}
+
+void Renderer::BeginFrame() {
+    FinishFrameStats();
+    sFrameAllocator.BeginFrame();
+    GLState::ResetFrameStats();
+    sFrameRing.BeginFrame();
+    if (!sFrameFence) return;
+    glClientWaitSync(sFrameFence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000); // 100 ms max
+    glDeleteSync(sFrameFence);
+    sFrameFence = nullptr;
+}
+
+void Renderer::EndFrame() {
+    sFrameRing.EndFrame();
+    if (sFrameFence) glDeleteSync(sFrameFence);
+    sFrameFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
 void Renderer::Clear(float r, float g, float b, float a) {
+    sClearColor[0] = r;
+    sClearColor[1] = g;
+    sClearColor[2] = b;
+    sClearColor[3] = a;
     glClearColor(r, g, b, a);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);  
+    GLState::SetEnabled(GL_DEPTH_TEST, true);  
 }
 
 void Renderer::DrawTriangle() {
-    glUseProgram(sProgram);
-    glBindVertexArray(sTriVAO);
+    GLState::UseProgram(sProgram);
+    GLState::BindVertexArray(sTriVAO);
     glDrawArrays(GL_TRIANGLES, 0, 3);
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
 }
 
 void Renderer::DrawRectangleIndexed(bool wireframe) {
-    if (wireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glUseProgram(sProgram);
-    glBindVertexArray(sRectVAO);
+    if (wireframe) GLState::PolygonMode(GL_LINE);
+    GLState::UseProgram(sProgram);
+    GLState::BindVertexArray(sRectVAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)0);
-    glBindVertexArray(0);
-    if (wireframe) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    GLState::BindVertexArray(0);
+    if (wireframe) GLState::PolygonMode(GL_FILL);
 }
 
 void Renderer::SetViewportSize(int w, int h) {
     sViewportW = w;
     sViewportH = h;
-    glViewport(0, 0, w, h);
+    GLState::Viewport(0, 0, w, h);
 }
 
 void Renderer::OnFileDropped(const char* path) {
@@ -260,87 +824,154 @@ void Renderer::OnFileDropped(const char* path) {
 bool Renderer::LoadModelFromPath(const std::string& path) {
     // Limpiar modelo anterior
     ClearModelData();
+    MemoryTracker::SetActiveModel(path);
 
-    Assimp::Importer importer;
-    unsigned flags = aiProcess_Triangulate
-        | aiProcess_JoinIdenticalVertices
-        | aiProcess_GenNormals
-        | aiProcess_FlipUVs;
+    // Formato paginado: streaming directo, sin pasar por Assimp
+    std::filesystem::path modelPath(path);
+    if (modelPath.extension() == ".mpages") {
+        return OpenStreaming(path);
+    }
 
-    const aiScene* scene = importer.ReadFile(path.c_str(), flags);
-    if (!scene || !scene->mRootNode || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)) {
-        std::cerr << "Assimp load failed: " << importer.GetErrorString() << "\n";
-        return false;
+    // Si ya existe una conversion al dia, no hace falta importar la escena
+    std::string pagedPath = path + ".mpages";
+    std::error_code ec;
+    if (std::filesystem::exists(pagedPath, ec) &&
+        std::filesystem::last_write_time(pagedPath, ec) >= std::filesystem::last_write_time(modelPath, ec)) {
+        std::cout << "Using paged version: " << pagedPath << std::endl;
+        if (OpenStreaming(pagedPath)) {
+            sLastModelPath = path;
+            return true;
+        }
+    }
+
+    // La arena se vacia al salir, despues de destruir model
+    ArenaScope importScope(sImportArena);
+    ModelBuildData model;
+    auto tStart = std::chrono::steady_clock::now();
+
+    // Version cocinada (MotorcinCook) al dia: sin Assimp ni construccion
+    bool cooked = false;
+    if (ModelCache::IsUpToDate(path)) {
+        std::string cookedPath = ModelCache::GetCookedPath(path);
+        cooked = ModelCache::Read(cookedPath, sImportArena, model);
+        if (cooked) {
+            std::cout << "Using cooked version: " << cookedPath << std::endl;
+        } else {
+            model = ModelBuildData();
+        }
     }
 
-    std::cout << "Scene loaded. Meshes: " << scene->mNumMeshes << std::endl;
-    std::cout << "Materials: " << scene->mNumMaterials << std::endl;
+    if (!cooked) {
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(path.c_str(), MeshBuilder::kImportFlags);
+        if (!scene || !scene->mRootNode || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)) {
+            std::cerr << "Assimp load failed: " << importer.GetErrorString() << "\n";
+            return false;
+        }
+        // La escena importada vive hasta el final de este bloque
+        aiMemoryInfo sceneMemory;
+        importer.GetMemoryRequirements(sceneMemory);
+        ScopedMemory importMemory(MemoryCategory::Import, sceneMemory.total);
+
+        std::cout << "Scene loaded. Meshes: " << scene->mNumMeshes << std::endl;
+        std::cout << "Materials: " << scene->mNumMaterials << std::endl;
+
+        size_t totalTriangles = 0;
+        for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+            totalTriangles += scene->mMeshes[i]->mNumFaces;
+        }
+
+        if (totalTriangles > ModelCache::kStreamingTriangleThreshold) {
+            std::cout << "Large model (" << totalTriangles << " triangles), converting to paged format" << std::endl;
+            if (PageFile::Build(scene, pagedPath)) {
+                importer.FreeScene();
+                if (!OpenStreaming(pagedPath)) return false;
+                sLastModelPath = path;
+                return true;
+            }
+            std::cerr << "Paged conversion failed, loading in memory\n";
+        }
+
+        // Limites, meshes en paralelo (solo CPU), materiales y luces
+        MeshBuilder::BuildModel(scene, sImportArena, model);
+    }
+
+    sLastModelPath = path;
+    auto tBuild = std::chrono::steady_clock::now();
 
     // Obtener directorio del modelo para texturas relativas
-    std::filesystem::path modelPath(path);
     std::string directory = modelPath.parent_path().string();
 
     // Cargar materiales
-    for (unsigned int m = 0; m < scene->mNumMaterials; ++m) {
-        const aiMaterial* aiMat = scene->mMaterials[m];
-        Material mat;
+    std::vector<std::string> texturePaths;
+    std::vector<int> materialTexture(model.materials.size(), -1);
+    std::string fullPath;       // reutilizada entre materiales
 
-        aiColor3D color(0.8f, 0.8f, 0.8f);
-        aiMat->Get(AI_MATKEY_COLOR_DIFFUSE, color);
-        mat.color[0] = color.r;
-        mat.color[1] = color.g;
-        mat.color[2] = color.b;
+    for (size_t m = 0; m < model.materials.size(); ++m) {
+        const MaterialSource& source = model.materials[m];
+        Material mat;
+        mat.color[0] = source.color[0];
+        mat.color[1] = source.color[1];
+        mat.color[2] = source.color[2];
 
-        if (aiMat->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
-            aiString texPath;
-            if (aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) == AI_SUCCESS) {
-                std::string fullPath = directory + "/" + texPath.C_Str();
+        if (!source.texture.empty()) {
+            fullPath.assign(directory).append("/").append(source.texture);
 
+            // Materiales que comparten textura comparten capa
+            auto it = std::find(texturePaths.begin(), texturePaths.end(), fullPath);
+            if (it == texturePaths.end()) {
                 std::cout << "  Loading texture: " << fullPath << std::endl;
-
-                mat.diffuseTexture = new Texture();
-                if (!mat.diffuseTexture->LoadFromFile(fullPath.c_str())) {
-                    std::cerr << "  Failed to load texture, using color instead\n";
-                    delete mat.diffuseTexture;
-                    mat.diffuseTexture = nullptr;
-                }
+                texturePaths.push_back(fullPath);
+                it = texturePaths.end() - 1;
             }
+            materialTexture[m] = (int)(it - texturePaths.begin());
         }
 
         sMaterials.push_back(mat);
     }
 
-    // Calcular bounding box global
-    float minX = std::numeric_limits<float>::max();
-    float minY = std::numeric_limits<float>::max();
-    float minZ = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::lowest();
-    float maxY = std::numeric_limits<float>::lowest();
-    float maxZ = std::numeric_limits<float>::lowest();
+    // Agrupar texturas difusas en texture arrays por tamano y formato
+    std::vector<int> textureArray, textureLayer;
+    BuildTextureArrays(texturePaths, textureArray, textureLayer);
 
-    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-        const aiMesh* mesh = scene->mMeshes[i];
-        for (unsigned v = 0; v < mesh->mNumVertices; ++v) {
-            float x = mesh->mVertices[v].x;
-            float y = mesh->mVertices[v].y;
-            float z = mesh->mVertices[v].z;
-
-            if (x < minX) minX = x;
-            if (x > maxX) maxX = x;
-            if (y < minY) minY = y;
-            if (y > maxY) maxY = y;
-            if (z < minZ) minZ = z;
-            if (z > maxZ) maxZ = z;
+    for (size_t m = 0; m < model.materials.size(); ++m) {
+        int t = materialTexture[m];
+        if (t < 0) continue;
+        if (textureArray[t] < 0) {
+            std::cerr << "  Failed to load texture, using color instead\n";
+            continue;
         }
+        sMaterials[m].textureArray = textureArray[t];
+        sMaterials[m].textureLayer = textureLayer[t];
     }
 
-    float centerX = (minX + maxX) * 0.5f;
-    float centerY = (minY + maxY) * 0.5f;
-    float centerZ = (minZ + maxZ) * 0.5f;
+    // Array de materiales del shader, subido una sola vez
+    std::vector<MaterialBlock> materialBlocks(sMaterials.size());
+    for (size_t m = 0; m < sMaterials.size(); ++m) {
+        const Material& mat = sMaterials[m];
+        MaterialBlock& block = materialBlocks[m];
+        std::memcpy(block.color, mat.color, sizeof(mat.color));
+        bool hasTexture = mat.textureArray >= 0 && mat.textureArray < (int)sTextureArrays.size()
+            && sTextureArrays[mat.textureArray]->IsValid();
+        block.params[0] = (float)mat.textureLayer;
+        block.params[1] = hasTexture ? 1.0f : 0.0f;
+    }
+    sUniforms.SetMaterials(materialBlocks);
+
+    std::cout << "Unique textures: " << texturePaths.size()
+        << ", texture arrays: " << sTextureArrays.size() << std::endl;
+
+    // Bounding box global (los vertices ya estan centrados en el)
+    const float* boundsMin = model.boundsMin;
+    const float* boundsMax = model.boundsMax;
 
-    float sizeX = maxX - minX;
-    float sizeY = maxY - minY;
-    float sizeZ = maxZ - minZ;
+    float centerX = (boundsMin[0] + boundsMax[0]) * 0.5f;
+    float centerY = (boundsMin[1] + boundsMax[1]) * 0.5f;
+    float centerZ = (boundsMin[2] + boundsMax[2]) * 0.5f;
+
+    float sizeX = boundsMax[0] - boundsMin[0];
+    float sizeY = boundsMax[1] - boundsMin[1];
+    float sizeZ = boundsMax[2] - boundsMin[2];
     float maxSize = std::max({ sizeX, sizeY, sizeZ });
 
     // GUARDAR INFO DEL MODELO
@@ -353,82 +984,266 @@ bool Renderer::LoadModelFromPath(const std::string& path) {
     std::cout << "Center: (" << centerX << ", " << centerY << ", " << centerZ << ")" << std::endl;
     std::cout << "Size: " << maxSize << std::endl;
 
-    // Procesar meshes
-    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
-        const aiMesh* aiMesh = scene->mMeshes[i];
+    auto tMaterials = std::chrono::steady_clock::now();
 
-        if (!(aiMesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE)) {
+    // Lotes estaticos: se anaden al final y sus partes quedan marcadas
+    if (sStaticBatching) {
+        size_t batches = MeshBuilder::BuildStaticBatches(model.meshes, !model.clips.empty(), maxSize,
+            sBatchSettings, sImportArena, sBatchParts);
+        std::cout << "Static batching: " << sBatchParts.size() << " meshes merged into " << batches
+            << " batches" << std::endl;
+    }
+    auto tBatch = std::chrono::steady_clock::now();
+    const std::vector<MeshBuildData>& buildData = model.meshes;
+
+    // Subir a GL en el hilo del contexto
+    std::vector<float> positions;       // reutilizado entre meshes
+    for (size_t i = 0; i < buildData.size(); ++i) {
+        const MeshBuildData& data = buildData[i];
+        if (!data.valid || data.batched) {
             continue;
         }
 
-        std::cout << "Processing mesh " << i << ": " << aiMesh->mNumVertices << " vertices" << std::endl;
-
-        std::vector<float> vertexData;
-        bool hasUVs = aiMesh->HasTextureCoords(0);
-        int stride = hasUVs ? 5 : 3;
-
-        vertexData.reserve(aiMesh->mNumVertices * stride);
-
-        for (unsigned v = 0; v < aiMesh->mNumVertices; ++v) {
-            // Posicin (centrada)
-            vertexData.push_back(aiMesh->mVertices[v].x - centerX);
-            vertexData.push_back(aiMesh->mVertices[v].y - centerY);
-            vertexData.push_back(aiMesh->mVertices[v].z - centerZ);
-
-            if (hasUVs) {
-                vertexData.push_back(aiMesh->mTextureCoords[0][v].x);
-                vertexData.push_back(aiMesh->mTextureCoords[0][v].y);
-            }
-        }
+        bool hasUVs = data.hasUVs;
+        int stride = MeshBuilder::VertexStride(hasUVs);
 
-        std::vector<unsigned> indices;
-        indices.reserve(aiMesh->mNumFaces * 3);
-        for (unsigned f = 0; f < aiMesh->mNumFaces; ++f) {
-            const aiFace& face = aiMesh->mFaces[f];
-            if (face.mNumIndices == 3) {
-                indices.push_back(face.mIndices[0]);
-                indices.push_back(face.mIndices[1]);
-                indices.push_back(face.mIndices[2]);
-            }
-        }
+        std::cout << "Processing mesh " << i << ": " << data.vertexData.size() / stride << " vertices" << std::endl;
 
         Mesh mesh;
         glGenVertexArrays(1, &mesh.VAO);
         glGenBuffers(1, &mesh.VBO);
         glGenBuffers(1, &mesh.EBO);
 
-        glBindVertexArray(mesh.VAO);
+        GLState::BindVertexArray(mesh.VAO);
 
-        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBufferData(GL_ARRAY_BUFFER, data.vertexData.size() * sizeof(float), data.vertexData.data(), GL_STATIC_DRAW);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(unsigned), data.indices.data(), GL_STATIC_DRAW);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
 
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
         if (hasUVs) {
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(3 * sizeof(float)));
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(6 * sizeof(float)));
             glEnableVertexAttribArray(1);
         }
 
-        glBindVertexArray(0);
+        // Huesos en un VBO aparte: el layout intercalado no cambia
+        bool skinned = !data.skin.empty() && !model.clips.empty();
+        if (skinned) {
+            glGenBuffers(1, &mesh.skinVBO);
+            GLState::BindBuffer(GL_ARRAY_BUFFER, mesh.skinVBO);
+            glBufferData(GL_ARRAY_BUFFER, data.skin.size(), data.skin.data(), GL_STATIC_DRAW);
+            glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, Animation::kSkinStride, (void*)0);
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, Animation::kSkinStride, (void*)4);
+            glEnableVertexAttribArray(4);
+            mesh.skinned = true;
+        }
+
+        GLState::BindVertexArray(0);
 
-        mesh.indexCount = indices.size();
-        mesh.materialIndex = aiMesh->mMaterialIndex;
+        // Stream de solo posiciones para el depth prepass
+        glGenVertexArrays(1, &mesh.depthVAO);
+        GLState::BindVertexArray(mesh.depthVAO);
+        {
+            positions.clear();
+            positions.reserve(data.vertexData.size() / stride * 3);
+            for (size_t v = 0; v < data.vertexData.size(); v += stride) {
+                positions.insert(positions.end(), &data.vertexData[v], &data.vertexData[v] + 3);
+            }
+            glGenBuffers(1, &mesh.positionVBO);
+            GLState::BindBuffer(GL_ARRAY_BUFFER, mesh.positionVBO);
+            glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+            mesh.vertexBytes = (data.vertexData.size() + positions.size()) * sizeof(float) + (skinned ? data.skin.size() : 0);
+        }
+        GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        GLState::BindVertexArray(0);
+
+        mesh.indexCount = data.indices.size();
+        mesh.indexBytes = data.indices.size() * sizeof(unsigned);
+        MemoryTracker::Allocate(MemoryCategory::Vertex, mesh.vertexBytes);
+        MemoryTracker::Allocate(MemoryCategory::Index, mesh.indexBytes);
+        mesh.materialIndex = data.materialIndex;
+        mesh.sourceIndex = (int)i;
+        if (mesh.indexCount >= kQueryMinIndices) {
+            glGenQueries(1, &mesh.occlusionQuery);
+        }
+        mesh.firstMeshlet = (unsigned)sMeshlets.size();
+        mesh.meshletCount = (unsigned)data.meshlets.size();
+        mesh.firstPart = data.firstPart;
+        mesh.partCount = data.partCount;
+        for (int k = 0; k < 3; ++k) {
+            mesh.boundsMin[k] = data.boundsMin[k];
+            mesh.boundsMax[k] = data.boundsMax[k];
+        }
+        sMeshlets.insert(sMeshlets.end(), data.meshlets.begin(), data.meshlets.end());
 
         sMeshes.push_back(mesh);
 
         std::cout << "  Mesh created. Indices: " << mesh.indexCount
+            << ", Meshlets: " << mesh.meshletCount
             << ", Material: " << mesh.materialIndex
-            << ", Has UVs: " << (hasUVs ? "YES" : "NO") << std::endl;
+            << ", Has UVs: " << (hasUVs ? "YES" : "NO")
+            << (mesh.skinned ? ", skinned" : "");
+        if (mesh.partCount > 0) std::cout << ", batch of " << mesh.partCount << " meshes";
+        std::cout << std::endl;
+    }
+
+    auto tUpload = std::chrono::steady_clock::now();
+    std::cout << "Import timings: " << (cooked ? "cooked read " : "import + mesh build ") << ElapsedMs(tStart, tBuild)
+        << " ms, materials " << ElapsedMs(tBuild, tMaterials)
+        << " ms, batching " << ElapsedMs(tMaterials, tBatch)
+        << " ms, upload " << ElapsedMs(tBatch, tUpload) << " ms ("
+        << JobSystem::GetActiveWorkerCount() << " workers)" << std::endl;
+
+    // Occluders: los meshes mas grandes, hasta el presupuesto de triangulos.
+    // Los lotes no cuentan: sus partes siguen en buildData.
+    std::vector<size_t> occluderCandidates;
+    for (size_t i = 0; i < buildData.size(); ++i) {
+        bool animated = !buildData[i].skin.empty() && !model.clips.empty();
+        if (buildData[i].valid && !buildData[i].indices.empty() && !animated && buildData[i].partCount == 0) {
+            occluderCandidates.push_back(i);
+        }
+    }
+    auto diagonal = [&](size_t i) {
+        const MeshBuildData& d = buildData[i];
+        float dx = d.boundsMax[0] - d.boundsMin[0], dy = d.boundsMax[1] - d.boundsMin[1], dz = d.boundsMax[2] - d.boundsMin[2];
+        return std::sqrt(dx * dx + dy * dy + dz * dz);
+    };
+    std::sort(occluderCandidates.begin(), occluderCandidates.end(), [&](size_t a, size_t b) {
+        return diagonal(a) > diagonal(b);
+    });
+
+    size_t occluderCount = 0;
+    for (size_t i : occluderCandidates) {
+        const MeshBuildData& d = buildData[i];
+        if (diagonal(i) < maxSize * kOccluderMinSizeRatio) break;
+        if (sOcclusionCuller.GetOccluderTriangleCount() + d.indices.size() / 3 > kOccluderTriangleBudget) continue;
+
+        sOcclusionCuller.AddOccluder(d.vertexData.data(), MeshBuilder::VertexStride(d.hasUVs), d.vertexData.size() / MeshBuilder::VertexStride(d.hasUVs),
+            d.indices.data(), d.indices.size());
+        occluderCount++;
+    }
+    std::cout << "Occluders: " << occluderCount << " meshes, "
+        << sOcclusionCuller.GetOccluderTriangleCount() << " triangles" << std::endl;
+
+    // Ordenar por texture array y material: los grupos se dibujan sin rebind
+    auto drawKey = [](const Mesh& mesh) {
+        int arrayIndex = -1;
+        if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)sMaterials.size()) {
+            arrayIndex = sMaterials[mesh.materialIndex].textureArray;
+        }
+        return std::make_pair(arrayIndex, mesh.materialIndex);
+    };
+    std::stable_sort(sMeshes.begin(), sMeshes.end(), [&](const Mesh& a, const Mesh& b) {
+        return drawKey(a) < drawKey(b);
+    });
+
+    // BVH de picking con los ids ya ordenados
+    for (size_t m = 0; m < sMeshes.size(); ++m) {
+        const MeshBuildData& d = buildData[sMeshes[m].sourceIndex];
+        int stride = MeshBuilder::VertexStride(d.hasUVs);
+        sPicker.AddMesh((int)m, d.vertexData.data(), stride, d.vertexData.size() / stride,
+            d.indices.data(), d.indices.size());
+    }
+    sPicker.Build();
+
+    // El rango de profundidad de las cascadas cubre toda la escena
+    sShadows.SetSceneRadius(maxSize * 0.5f * std::sqrt(3.0f));
+
+    // Luces: las puntuales de la escena o, si no hay, un conjunto de prueba
+    sLighting.ClearLights();
+    for (const PointLight& light : model.lights) {
+        sLighting.AddLight(light);
+    }
+    if (sLighting.GetLightCount() == 0) {
+        AddDebugLights(kDefaultLightCount);
+    }
+    std::cout << "Lights: " << sLighting.GetLightCount() << std::endl;
+
+    // Animacion: el esqueleto y los clips pasan al SkinningSystem
+    if (!model.clips.empty()) {
+        const float center[3] = { centerX, centerY, centerZ };
+        sSkinning.SetModel(std::move(model.skeleton), std::move(model.clips), center, maxSize * 1.2f);
+        sSkinning.PrintStats();
     }
 
     std::cout << "Model loaded successfully! Total meshes: " << sMeshes.size() << std::endl;
+    std::cout << "Import arena: " << sImportArena.GetAllocationCount() << " allocations, "
+        << (sImportArena.GetUsedBytes() >> 20) << " MB used, "
+        << sImportArena.GetChunkAllocations() << " chunks requested in total" << std::endl;
+    MemoryTracker::PrintStats();
+
     return true;
 }
 
+void Renderer::RunImportBenchmark() {
+    if (sLastModelPath.empty()) {
+        std::cout << "Import benchmark: no model loaded" << std::endl;
+        return;
+    }
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(sLastModelPath.c_str(), MeshBuilder::kImportFlags);
+    if (!scene || !scene->mRootNode || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)) {
+        std::cerr << "Assimp load failed: " << importer.GetErrorString() << "\n";
+        return;
+    }
+
+    std::cout << "\n=== Import benchmark: " << sLastModelPath << " ===" << std::endl;
+    std::cout << "Meshes: " << scene->mNumMeshes << " (bounds + mesh build, best of 3)" << std::endl;
+
+    // 1, 2, 4, ... hasta el total de workers
+    std::vector<unsigned int> workerCounts;
+    unsigned int maxWorkers = std::max(1u, JobSystem::GetWorkerCount());
+    for (unsigned int n = 1; n < maxWorkers; n *= 2) {
+        workerCounts.push_back(n);
+    }
+    workerCounts.push_back(maxWorkers);
+
+    unsigned int previousWorkers = JobSystem::GetActiveWorkerCount();
+    double baselineMs = 0.0;
+
+    for (unsigned int workers : workerCounts) {
+        JobSystem::SetActiveWorkerCount(workers);
+
+        double bestMs = std::numeric_limits<double>::max();
+        for (int rep = 0; rep < 3; ++rep) {
+            auto t0 = std::chrono::steady_clock::now();
+
+            float boundsMin[3], boundsMax[3];
+            MeshBuilder::ComputeSceneBounds(scene, boundsMin, boundsMax);
+            const float center[3] = {
+                (boundsMin[0] + boundsMax[0]) * 0.5f,
+                (boundsMin[1] + boundsMax[1]) * 0.5f,
+                (boundsMin[2] + boundsMax[2]) * 0.5f };
+
+            ArenaScope importScope(sImportArena);
+            std::vector<MeshBuildData> buildData;
+            MeshBuilder::BuildMeshData(scene, center, sImportArena, buildData);
+
+            bestMs = std::min(bestMs, ElapsedMs(t0, std::chrono::steady_clock::now()));
+        }
+
+        if (workers == 1) baselineMs = bestMs;
+        double speedup = bestMs > 0.0 ? baselineMs / bestMs : 0.0;
+
+        std::cout << "  " << workers << " workers: " << bestMs << " ms, speedup "
+            << speedup << "x, efficiency " << (100.0 * speedup / workers) << "%" << std::endl;
+    }
+
+    JobSystem::SetActiveWorkerCount(previousWorkers);
+    JobSystem::PrintStats();
+}
+
 void Renderer::GetModelCenter(float& x, float& y, float& z) {
     x = sModelCenterX;
     y = sModelCenterY;
@@ -439,17 +1254,27 @@ float Renderer::GetModelSize() {
     return sModelSize;
 }
 
-void Renderer::DrawLoadedModel(Camera* camera) {
-    if (sMeshes.empty() || !camera) {
-        return;
+// Dibuja los rangos visibles de un mesh con el VAO dado (color o solo posicion)
+static void SubmitMeshDraw(const Mesh& mesh, const DrawItem& item, GLuint vao) {
+    if (item.conditional) {
+        glBeginConditionalRender(mesh.occlusionQuery, GL_QUERY_NO_WAIT);
     }
+    GLState::BindVertexArray(vao);
+    if (item.rangeCount > 0) {
+        glMultiDrawElements(GL_TRIANGLES, &sDrawCounts[item.firstRange], GL_UNSIGNED_INT,
+            &sDrawOffsets[item.firstRange], (GLsizei)item.rangeCount);
+    }
+    else {
+        glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indexCount, GL_UNSIGNED_INT, 0);
+    }
+    if (item.conditional) {
+        glEndConditionalRender();
+    }
+}
 
-    static int drawCallCount = 0;
-    bool shouldDebug = (drawCallCount < 5 || drawCallCount % 60 == 0) && drawCallCount < 300;
-
-    if (shouldDebug) {
-        std::cout << "\n=== DRAW CALL #" << drawCallCount << " ===" << std::endl;
-        std::cout << "Meshes to draw: " << sMeshes.size() << std::endl;
+void Renderer::DrawLoadedModel(Camera* camera) {
+    if (!HasLoadedModel() || !camera || sViewportW <= 0 || sViewportH <= 0) {
+        return;
     }
 
     // Calcular MVP
@@ -467,113 +1292,815 @@ void Renderer::DrawLoadedModel(Camera* camera) {
     MatMul(PV, P, V);
     MatMul(MVP, PV, M);
 
-    if (shouldDebug) {
-        std::cout << "MVP matrix first values: " << MVP[0] << ", " << MVP[1] << ", " << MVP[2] << std::endl;
-    }
+    // Tiempos de GPU de frames anteriores -> area dibujada en este
+    sDynamicResolution.Update();
+    sDynamicResolution.GetRenderSize(sViewportW, sViewportH, sRenderW, sRenderH);
+
+    sDrawFrame++;
+    // Listas del frame con su cota maxima reservada: sin crecer a mitad
+    sQueryCandidates = ArenaVector<size_t>(sFrameAllocator.GetAllocator<size_t>());
+    sQueryCandidates.reserve(sMeshes.size());
+    bool useQueries = sOcclusionQueries && !sWireframeMode;
+    float nearPlane = P[14] / (P[10] - 1.0f);
 
-    // Configurar modo de renderizado
+    // Configurar modo de renderizado (se queda fijado entre frames: GLState
+    // no emite nada si no cambia)
     if (sWireframeMode) {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        glLineWidth(2.0f);
-        glDisable(GL_CULL_FACE);
+        GLState::PolygonMode(GL_LINE);
+        GLState::LineWidth(2.0f);
+        GLState::SetEnabled(GL_CULL_FACE, false);
     }
     else {
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glLineWidth(1.0f);
+        GLState::PolygonMode(GL_FILL);
+        GLState::LineWidth(1.0f);
         // CAMBIO: Desactivar culling para ver ambas caras
-        glDisable(GL_CULL_FACE);  // <--- CAMBIA ESTO
-        // glEnable(GL_CULL_FACE);  // <--- COMENTA ESTO
+        GLState::SetEnabled(GL_CULL_FACE, false);  // <--- CAMBIA ESTO
+        // GLState::SetEnabled(GL_CULL_FACE, true);  // <--- COMENTA ESTO
         // glCullFace(GL_BACK);     // <--- COMENTA ESTO
     }
 
-    // Dibujar cada mesh
+    float cameraPos[3];
+    camera->GetPosition(cameraPos[0], cameraPos[1], cameraPos[2]);
+
+    // Modelo paginado: seleccion de paginas por frustum y error en pantalla;
+    // se dibuja en el pase Opaque
+    if (sStreaming) {
+        sStreaming->Update(MVP, cameraPos, camera->GetFOV(), sViewportH);
+    }
+
+    // Culling por meshlet (frustum + cono de normales) repartido entre workers
+    Frustum frustum;
+    frustum.ExtractFromMatrix(MVP);
+
+    sMeshletVisible = sFrameAllocator.AllocateArray<unsigned char>(sMeshlets.size());
+    JobSystem::ParallelFor(sMeshlets.size(), 2048, [&](size_t begin, size_t end) {
+        for (size_t m = begin; m < end; ++m) {
+            sMeshletVisible[m] = IsMeshletVisible(sMeshlets[m], frustum, cameraPos, sClusterCulling) ? 1 : 0;
+        }
+    });
+
+    // Depth buffer de occluders en CPU y su piramide Hi-Z
+    bool useOcclusion = sOcclusionCulling && sOcclusionCuller.HasOccluders();
+    if (useOcclusion) {
+        sOcclusionCuller.Render(MVP);
+    }
+
+    // Culling por mesh y lista de visibles, en el orden de estado de la carga
+    size_t visibleMeshlets = 0;
+    int multiDraws = 0;
+    int occludedMeshes = 0;
+    int occludedParts = 0;
+    int conditionalDraws = 0;
+    int skippedDraws = 0;
+
+    sDrawItems = ArenaVector<DrawItem>(sFrameAllocator.GetAllocator<DrawItem>());
+    sDrawItems.reserve(sMeshes.size());
+    // Un rango por meshlet como mucho, o uno por mesh sin meshlets
+    sDrawCounts = ArenaVector<GLsizei>(sFrameAllocator.GetAllocator<GLsizei>());
+    sDrawCounts.reserve(sMeshlets.size() + sMeshes.size());
+    sDrawOffsets = ArenaVector<const void*>(sFrameAllocator.GetAllocator<const void*>());
+    sDrawOffsets.reserve(sMeshlets.size() + sMeshes.size());
+
+    // Los meshes animados van aparte, instanciados (DrawSkinnedMeshes)
+    const bool animating = sSkinning.HasAnimation();
+
     for (size_t i = 0; i < sMeshes.size(); ++i) {
-        const Mesh& mesh = sMeshes[i];
+        Mesh& mesh = sMeshes[i];
+        if (animating && mesh.skinned) continue;
 
-        if (shouldDebug && i == 0) {
-            std::cout << "Drawing mesh 0:" << std::endl;
-            std::cout << "  VAO: " << mesh.VAO << std::endl;
-            std::cout << "  IndexCount: " << mesh.indexCount << std::endl;
-            std::cout << "  MaterialIndex: " << mesh.materialIndex << std::endl;
+        if (useOcclusion && !sOcclusionCuller.IsVisible(mesh.boundsMin, mesh.boundsMax)) {
+            occludedMeshes++;
+            continue;
         }
 
-        const Material* mat = nullptr;
-        if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)sMaterials.size()) {
-            mat = &sMaterials[mesh.materialIndex];
+        // Un lote visible puede tener partes tapadas: se apagan sus meshlets
+        if (useOcclusion) {
+            for (unsigned int p = mesh.firstPart; p < mesh.firstPart + mesh.partCount; ++p) {
+                const StaticBatchPart& part = sBatchParts[p];
+                if (sOcclusionCuller.IsVisible(part.boundsMin, part.boundsMax)) continue;
+                std::memset(sMeshletVisible + mesh.firstMeshlet + part.firstMeshlet, 0, part.meshletCount);
+                occludedParts++;
+            }
+        }
+
+        DrawItem item;
+        item.mesh = i;
+        item.firstRange = sDrawCounts.size();
+        item.conditional = false;
+
+        // Rangos visibles; los meshlets consecutivos se fusionan en uno
+        unsigned int rangeEnd = 0;
+        for (unsigned int m = mesh.firstMeshlet; m < mesh.firstMeshlet + mesh.meshletCount; ++m) {
+            if (!sMeshletVisible[m]) continue;
+            const Meshlet& meshlet = sMeshlets[m];
+            visibleMeshlets++;
+            if (sDrawCounts.size() > item.firstRange && rangeEnd == meshlet.firstIndex) {
+                sDrawCounts.back() += (GLsizei)meshlet.indexCount;
+            }
+            else {
+                sDrawCounts.push_back((GLsizei)meshlet.indexCount);
+                sDrawOffsets.push_back((const void*)(size_t)(meshlet.firstIndex * sizeof(unsigned)));
+            }
+            rangeEnd = meshlet.firstIndex + meshlet.indexCount;
+        }
+        item.rangeCount = sDrawCounts.size() - item.firstRange;
+        if (mesh.meshletCount > 0 && item.rangeCount == 0) {
+            continue;
         }
 
-        bool hasTexture = mat && mat->diffuseTexture && mat->diffuseTexture->IsValid();
-        unsigned int program = hasTexture ? sModelProgramTextured : sModelProgram;
+        // Resultado de la query del frame anterior: el fence de BeginFrame
+        // garantiza que ya esta disponible, asi que leerlo no bloquea
+        if (useQueries && mesh.occlusionQuery) {
+            if (mesh.queryPending) {
+                GLuint available = 0;
+                glGetQueryObjectuiv(mesh.occlusionQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available) {
+                    GLuint passed = 0;
+                    glGetQueryObjectuiv(mesh.occlusionQuery, GL_QUERY_RESULT, &passed);
+                    mesh.queryVisible = passed != 0;
+                    mesh.queryPending = false;
+                }
+            }
 
-        if (shouldDebug && i == 0) {
-            std::cout << "  Using program: " << program << std::endl;
-            std::cout << "  Has texture: " << (hasTexture ? "YES" : "NO") << std::endl;
-            std::cout << "  Wireframe mode: " << (sWireframeMode ? "ON" : "OFF") << std::endl;
+            // Solo se condiciona con una query lanzada en el frame anterior
+            item.conditional = mesh.queryFrame != 0 && mesh.queryFrame + 1 == sDrawFrame;
+            if (item.conditional) {
+                conditionalDraws++;
+                if (!mesh.queryPending && !mesh.queryVisible) skippedDraws++;
+            }
+            sQueryCandidates.push_back(i);
         }
 
-        glUseProgram(program);
+        // Profundidad en vista: la w de clip del centro de la caja
+        float c[3];
+        for (int k = 0; k < 3; ++k) c[k] = (mesh.boundsMin[k] + mesh.boundsMax[k]) * 0.5f;
+        item.depth = MVP[3] * c[0] + MVP[7] * c[1] + MVP[11] * c[2] + MVP[15];
+
+        sDrawItems.push_back(item);
+    }
+
+    // Orden de delante a atras con claves de 64 bits (profundidad, indice):
+    // se ordenan 8 bytes por item en lugar del DrawItem entero
+    const size_t itemCount = sDrawItems.size();
+    uint64_t* sortKeys = sFrameAllocator.AllocateArray<uint64_t>(itemCount);
+    for (size_t i = 0; i < itemCount; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &sDrawItems[i].depth, sizeof(bits));
+        // Float a entero con el mismo orden (negativos invertidos)
+        bits ^= (bits & 0x80000000u) ? 0xffffffffu : 0x80000000u;
+        sortKeys[i] = ((uint64_t)bits << 32) | (uint64_t)i;
+    }
+    std::sort(sortKeys, sortKeys + itemCount);
+    sSortedItems = ArenaVector<DrawItem>(sFrameAllocator.GetAllocator<DrawItem>());
+    sSortedItems.reserve(itemCount);
+    for (size_t i = 0; i < itemCount; ++i) {
+        sSortedItems.push_back(sDrawItems[(size_t)(sortKeys[i] & 0xffffffffu)]);
+    }
+
+    // Asignacion de luces a clusters; el wireframe y el heatmap van sin luz
+    bool unlit = sWireframeMode || sOverdrawHeatmap;
+    if (!unlit) {
+        float farPlane = P[14] / (P[10] + 1.0f);
+        sLighting.Update(V, P, nearPlane, farPlane);
+    }
 
-        // Set MVP
-        int locMVP = glGetUniformLocation(program, "uMVP");
-        if (locMVP != -1) {
-            glUniformMatrix4fv(locMVP, 1, GL_FALSE, MVP);
+    // Vista de la camara, una vez por frame. Heatmap y wireframe sustituyen
+    // el color de los materiales sin textura
+    float overrideColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (sOverdrawHeatmap) {
+        // Aditivo: cada capa sombreada suma, negro -> naranja -> blanco
+        overrideColor[0] = 0.12f; overrideColor[1] = 0.06f; overrideColor[2] = 0.02f; overrideColor[3] = 1.0f;
+    }
+    else if (sWireframeMode) {
+        // Color brillante para wireframe
+        overrideColor[1] = 1.0f; overrideColor[3] = 1.0f;
+    }
+    sUniforms.BeginFrame(V, P, MVP, overrideColor);
+
+    bool usePrepass = sDepthPrepass && !sWireframeMode;
+    // Con prepass el color va agrupado por estado; sin el, de delante a atras
+    const ArenaVector<DrawItem>& colorItems = usePrepass ? sDrawItems : sSortedItems;
+
+    // Muestras sombreadas del frame anterior, sin esperar a la GPU
+    if (sOverdrawQueryPending) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(sOverdrawQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(sOverdrawQuery, GL_QUERY_RESULT, &samples);
+            double pixels = std::max(1.0, (double)sRenderW * (double)sRenderH);
+            sShadedSamplesPerPixel = samples / pixels;
+            sOverdrawQueryPending = false;
         }
-        else if (shouldDebug && i == 0) {
-            std::cerr << "  WARNING: uMVP uniform not found!" << std::endl;
+    }
+    bool measureOverdraw = !sOverdrawQueryPending;
+
+    int textureBinds = 0;
+    int skinnedDraws = 0;
+    int queriesIssued = 0;
+
+    // Grafo del frame: sombras -> prepass -> color -> presentacion. La escena
+    // va a targets transitorios y Present la copia al backbuffer.
+    sRenderGraph.Reset();
+    RGHandle backbuffer = sRenderGraph.ImportBackbuffer("Backbuffer", sViewportW, sViewportH);
+    RGHandle shadowMaps = sRenderGraph.Import("ShadowCascades");
+    RGHandle sceneDepth = -1;
+    RGHandle sceneColor = -1;
+    RGTextureDesc colorDesc;
+    sDynamicResolution.GetTargetSize(sViewportW, sViewportH, colorDesc.width, colorDesc.height);
+    colorDesc.format = GL_RGBA8;
+    RGTextureDesc depthDesc = colorDesc;
+    depthDesc.format = GL_DEPTH24_STENCIL8;
+
+    // Cascadas: la geometria estatica solo se redibuja si cambian la luz o
+    // los limites; los meshes animados se componen encima cada frame. Sin
+    // luz nadie lee las cascadas y el grafo descarta el pase.
+    sRenderGraph.AddPass("Shadows", [&](RenderGraphBuilder& builder) {
+        builder.Write(shadowMaps);
+    }, [&](const RenderGraph&) {
+        ShadowCascades::DrawFn drawDynamic;
+        if (animating) {
+            drawDynamic = [](const float lightViewProj[16]) {
+                sUniforms.PushView(lightViewProj);
+                DrawSkinnedMeshes(true, true);
+            };
         }
+        sShadows.Update(V, P, [animating](const float lightViewProj[16]) {
+            sUniforms.PushView(lightViewProj);
+            GLState::UseProgram(sDepthProgram);
+
+            Frustum lightFrustum;
+            lightFrustum.ExtractFromMatrix(lightViewProj);
+            for (const Mesh& mesh : sMeshes) {
+                if (animating && mesh.skinned) continue;
+                if (!lightFrustum.IntersectsAABB(mesh.boundsMin, mesh.boundsMax)) continue;
+                GLState::BindVertexArray(mesh.depthVAO);
+                glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indexCount, GL_UNSIGNED_INT, 0);
+            }
+        }, drawDynamic);
+        sUniforms.BindCameraView();
+    });
+
+    // Depth prepass de delante a atras con solo posiciones y un programa
+    // trivial; despues el color solo sombrea el fragmento visible (GL_EQUAL)
+    if (usePrepass) {
+        sRenderGraph.AddPass("DepthPrepass", [&](RenderGraphBuilder& builder) {
+            sceneDepth = builder.CreateTexture("SceneDepth", depthDesc);
+            builder.WriteDepth(sceneDepth);
+        }, [&](const RenderGraph&) {
+            GLState::Viewport(0, 0, sRenderW, sRenderH);
+            GLState::DepthFunc(GL_LESS);
+            GLState::DepthMask(true);
+            glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+            GLState::UseProgram(sDepthProgram);
+            GLState::ColorMask(false);
+            for (const DrawItem& item : sSortedItems) {
+                SubmitMeshDraw(sMeshes[item.mesh], item, sMeshes[item.mesh].depthVAO);
+            }
+            GLState::ColorMask(true);
+        });
+    }
 
-        // Set material
-        if (hasTexture) {
-            mat->diffuseTexture->Bind(0);
-            int locTex = glGetUniformLocation(program, "uTexture");
-            if (locTex != -1) glUniform1i(locTex, 0);
+    sRenderGraph.AddPass("Opaque", [&](RenderGraphBuilder& builder) {
+        if (sceneDepth < 0) {
+            sceneDepth = builder.CreateTexture("SceneDepth", depthDesc);
+        } else {
+            builder.Read(sceneDepth);
+        }
+        sceneColor = builder.CreateTexture("SceneColor", colorDesc);
+        builder.WriteColor(sceneColor);
+        builder.WriteDepth(sceneDepth);
+        if (!unlit) builder.Read(shadowMaps);
+    }, [&](const RenderGraph&) {
+        GLState::Viewport(0, 0, sRenderW, sRenderH);
+        glClearColor(sClearColor[0], sClearColor[1], sClearColor[2], sClearColor[3]);
+        if (usePrepass) {
+            glClear(GL_COLOR_BUFFER_BIT);
+        } else {
+            GLState::DepthMask(true);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        }
 
-            int locHasTex = glGetUniformLocation(program, "uHasTexture");
-            if (locHasTex != -1) glUniform1i(locHasTex, 1);
+        // Paginas del modelo out-of-core (no pasan por el prepass)
+        if (sStreaming) {
+            GLState::UseProgram(sModelProgram);
+            // Material por defecto (gris, o el color de wireframe)
+            int locMaterial = glGetUniformLocation(sModelProgram, "uMaterialIndex");
+            if (locMaterial != -1) glUniform1i(locMaterial, sUniforms.SelectMaterial(-1));
+            // Las paginas solo llevan posiciones: sin normales no hay iluminacion
+            int locUnlit = glGetUniformLocation(sModelProgram, "uUnlit");
+            if (locUnlit != -1) glUniform1i(locUnlit, 1);
+
+            sStreaming->Draw();
         }
-        else {
-            int locHasTex = glGetUniformLocation(program, "uHasTexture");
-            if (locHasTex != -1) glUniform1i(locHasTex, 0);
+
+        if (usePrepass) {
+            GLState::DepthFunc(GL_EQUAL);
+            GLState::DepthMask(false);
+        }
+
+        if (sOverdrawHeatmap) {
+            GLState::SetEnabled(GL_BLEND, true);
+            GLState::BlendFunc(GL_ONE, GL_ONE);
         }
+        if (measureOverdraw) {
+            glBeginQuery(GL_SAMPLES_PASSED, sOverdrawQuery);
+        }
+
+        unsigned int currentProgram = 0;
+        int currentArray = -1;
+        int currentMaterial = -1;
+
+        for (size_t i = 0; i < colorItems.size(); ++i) {
+            const DrawItem& item = colorItems[i];
+            const Mesh& mesh = sMeshes[item.mesh];
 
-        // Set color
-        int locColor = glGetUniformLocation(program, "uColor");
-        if (locColor != -1) {
-            if (sWireframeMode) {
-                // Color brillante para wireframe
-                float wireColor[3] = { 0.0f, 1.0f, 0.0f };
-                glUniform3fv(locColor, 1, wireColor);
+            const Material* mat = nullptr;
+            if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)sMaterials.size()) {
+                mat = &sMaterials[mesh.materialIndex];
             }
-            else if (mat) {
-                glUniform3fv(locColor, 1, mat->color);
+
+            int arrayIndex = mat ? mat->textureArray : -1;
+            bool hasTexture = !sOverdrawHeatmap && arrayIndex >= 0 && arrayIndex < (int)sTextureArrays.size()
+                && sTextureArrays[arrayIndex]->IsValid();
+            unsigned int program = hasTexture ? sModelProgramTextured : sModelProgram;
+
+            if (program != currentProgram) {
+                GLState::UseProgram(program);
+                currentProgram = program;
+                currentMaterial = -1;
+
+                if (hasTexture) {
+                    int locTex = glGetUniformLocation(program, "uTextureArray");
+                    if (locTex != -1) glUniform1i(locTex, 0);
+                }
+
+                int locUnlit = glGetUniformLocation(program, "uUnlit");
+                if (locUnlit != -1) glUniform1i(locUnlit, unlit ? 1 : 0);
+                if (!unlit) {
+                    sLighting.Bind(program, sRenderW, sRenderH);
+                    sShadows.Bind(program);
+                }
             }
-            else {
-                float defaultColor[3] = { 0.8f, 0.8f, 0.8f };
-                glUniform3fv(locColor, 1, defaultColor);
+
+            // Solo se re-enlaza la textura al cambiar de grupo
+            if (hasTexture && arrayIndex != currentArray) {
+                sTextureArrays[arrayIndex]->Bind(0);
+                currentArray = arrayIndex;
+                textureBinds++;
             }
+
+            // Color, capa y textura vienen del bloque de materiales
+            int material = sUniforms.SelectMaterial(mesh.materialIndex);
+            if (material != currentMaterial) {
+                int locMaterial = glGetUniformLocation(program, "uMaterialIndex");
+                if (locMaterial != -1) glUniform1i(locMaterial, material);
+                currentMaterial = material;
+            }
+
+            // Dibujar
+            SubmitMeshDraw(mesh, item, mesh.VAO);
+            if (item.rangeCount > 0) multiDraws++;
         }
 
-        // Dibujar
-        glBindVertexArray(mesh.VAO);
-        glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        // Animados: con test de profundidad normal aunque haya prepass
+        if (animating) {
+            if (usePrepass) {
+                GLState::DepthFunc(GL_LESS);
+                GLState::DepthMask(true);
+            }
+            skinnedDraws = DrawSkinnedMeshes(false, unlit);
+        }
+
+        if (measureOverdraw) {
+            glEndQuery(GL_SAMPLES_PASSED);
+            sOverdrawQueryPending = true;
+        }
+
+        if (sOverdrawHeatmap) {
+            GLState::SetEnabled(GL_BLEND, false);
+        }
+        if (usePrepass) {
+            GLState::DepthFunc(GL_LESS);
+            GLState::DepthMask(true);
+        }
+
+        if (useQueries && !sQueryCandidates.empty()) {
+            queriesIssued = IssueOcclusionQueries(cameraPos, nearPlane);
+        }
+    });
+
+    sRenderGraph.AddPass("Present", [&](RenderGraphBuilder& builder) {
+        builder.Read(sceneColor);
+        builder.WriteColor(backbuffer);
+    }, [&](const RenderGraph& graph) {
+        // Escalado bilineal en el blit; a escala 1 es una copia
+        bool scaled = sRenderW != sViewportW || sRenderH != sViewportH;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, graph.GetReadFramebuffer(sceneColor));
+        glBlitFramebuffer(0, 0, sRenderW, sRenderH, 0, 0, sViewportW, sViewportH,
+            GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    });
+
+    sRenderGraph.Compile();
+    sDynamicResolution.BeginTiming();
+    sRenderGraph.Execute();
+    sDynamicResolution.EndTiming();
+
+    FrameStats& stats = sFrameStats;
+    stats.renderWidth = sRenderW;
+    stats.renderHeight = sRenderH;
+    stats.drawItems = (int)sDrawItems.size();
+    stats.visibleMeshlets = visibleMeshlets;
+    stats.totalMeshlets = sMeshlets.size();
+    stats.multiDraws = multiDraws;
+    stats.textureBinds = textureBinds;
+    stats.skinnedDraws = skinnedDraws;
+    stats.occludedMeshes = occludedMeshes;
+    stats.occludedParts = occludedParts;
+    stats.queriesIssued = queriesIssued;
+    stats.conditionalDraws = conditionalDraws;
+    stats.skippedDraws = skippedDraws;
+    stats.shadedSamplesPerPixel = sShadedSamplesPerPixel;
+
+    // Detalle bajo demanda (PrintFrameDetails); el resumen sale en BeginFrame
+    if (sPrintFrameDetails) {
+        sPrintFrameDetails = false;
+        std::cout << "\n=== Frame " << stats.frame << " details ===" << std::endl;
+        sRenderGraph.PrintStats();
+        sDynamicResolution.PrintStats();
+        sUniforms.PrintStats();
+        sFrameRing.PrintStats();
+        GLState::PrintStats();
+        std::cout << "Render size: " << sRenderW << "x" << sRenderH << " -> " << sViewportW << "x" << sViewportH << std::endl;
+        if (sStreaming) {
+            sStreaming->PrintStats();
+        }
+        std::cout << "Frame allocator: " << sFrameAllocator.GetLastFrameAllocations() << " allocations, "
+            << (sFrameAllocator.GetLastFrameBytes() >> 10) << " KB last frame (peak "
+            << (sFrameAllocator.GetPeakFrameBytes() >> 10) << " KB), "
+            << sFrameAllocator.GetChunkAllocations() << " chunks requested in total" << std::endl;
+        std::cout << "Cone culling: " << (sClusterCulling ? "ON" : "OFF") << std::endl;
+        std::cout << "Depth prepass: " << (usePrepass ? "ON" : "OFF")
+            << ", shaded samples per pixel: " << sShadedSamplesPerPixel << std::endl;
+        if (useQueries) {
+            std::cout << "Occlusion queries: " << queriesIssued << " issued, "
+                << conditionalDraws << " conditional draws, " << skippedDraws << " skipped" << std::endl;
+        }
+        if (useOcclusion) {
+            std::cout << "Occluded meshes: " << occludedMeshes << "/" << sMeshes.size()
+                << ", batch parts " << occludedParts << "/" << sBatchParts.size()
+                << ", occluder raster " << sOcclusionCuller.GetLastRenderMs() << " ms" << std::endl;
+        }
+        if (!unlit) {
+            std::cout << "Clustered lighting: " << sLighting.GetLightCount() << " lights, "
+                << sLighting.GetLastAssignmentCount() << " cluster entries (max "
+                << sLighting.GetLastMaxLightsPerCluster() << " per cluster), assign "
+                << sLighting.GetLastUpdateMs() << " ms" << std::endl;
+            if (sShadows.IsEnabled()) {
+                sShadows.PrintStats();
+            }
+        }
+        if (animating) {
+            sSkinning.PrintStats();
+        }
+    }
+}
+
+int Renderer::DrawSkinnedMeshes(bool depthOnly, bool unlit) {
+    GLsizei instances = (GLsizei)sSkinning.GetInstanceCount();
+    if (instances == 0) return 0;
+
+    unsigned int currentProgram = 0;
+    int currentArray = -1;
+    int currentMaterial = -1;
+    int draws = 0;
+    for (const Mesh& mesh : sMeshes) {
+        if (!mesh.skinned) continue;
+
+        const Material* mat = nullptr;
+        if (mesh.materialIndex >= 0 && mesh.materialIndex < (int)sMaterials.size()) {
+            mat = &sMaterials[mesh.materialIndex];
+        }
+        int arrayIndex = mat ? mat->textureArray : -1;
+        bool hasTexture = !depthOnly && !sOverdrawHeatmap && arrayIndex >= 0 && arrayIndex < (int)sTextureArrays.size()
+            && sTextureArrays[arrayIndex]->IsValid();
+        unsigned int program = depthOnly ? sDepthProgramSkinned
+            : (hasTexture ? sModelProgramTexturedSkinned : sModelProgramSkinned);
+
+        if (program != currentProgram) {
+            GLState::UseProgram(program);
+            currentProgram = program;
+            currentMaterial = -1;
+            sSkinning.Bind(program);
+
+            if (!depthOnly) {
+                int locTex = glGetUniformLocation(program, "uTextureArray");
+                if (locTex != -1) glUniform1i(locTex, 0);
+                int locUnlit = glGetUniformLocation(program, "uUnlit");
+                if (locUnlit != -1) glUniform1i(locUnlit, unlit ? 1 : 0);
+                if (!unlit) {
+                    sLighting.Bind(program, sRenderW, sRenderH);
+                    sShadows.Bind(program);
+                }
+            }
+        }
+
+        if (!depthOnly) {
+            if (hasTexture && arrayIndex != currentArray) {
+                sTextureArrays[arrayIndex]->Bind(0);
+                currentArray = arrayIndex;
+            }
+            // Mismos materiales que el pase estatico
+            int material = sUniforms.SelectMaterial(mesh.materialIndex);
+            if (material != currentMaterial) {
+                int locMaterial = glGetUniformLocation(program, "uMaterialIndex");
+                if (locMaterial != -1) glUniform1i(locMaterial, material);
+                currentMaterial = material;
+            }
+        }
+
+        GLState::BindVertexArray(mesh.VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, (GLsizei)mesh.indexCount, GL_UNSIGNED_INT, 0, instances);
+        draws++;
+    }
+    return draws;
+}
+
+void Renderer::UpdateAnimation(float dt) {
+    if (sSkinning.HasAnimation()) {
+        sSkinning.Update(dt);
+    }
+}
+
+void Renderer::CycleAnimatedInstances() {
+    if (!sSkinning.HasAnimation()) {
+        std::cout << "Animated instances: the loaded model has no skeletal animation" << std::endl;
+        return;
+    }
+
+    size_t current = sSkinning.GetInstanceCount();
+    size_t next = kAnimatedInstanceSteps[0];
+    for (size_t step : kAnimatedInstanceSteps) {
+        if (step > current) {
+            next = step;
+            break;
+        }
+    }
+    sSkinning.SetInstanceCount(next);
+    // Limitado por el tamano del texture buffer: se vuelve a empezar
+    if (sSkinning.GetInstanceCount() == current && current > 1) {
+        sSkinning.SetInstanceCount(1);
+    }
+
+    // Las sombras tienen que cubrir toda la rejilla
+    float modelRadius = sModelSize * 0.5f * std::sqrt(3.0f);
+    sShadows.SetSceneRadius(modelRadius + sSkinning.GetCrowdRadius());
+    std::cout << "Animated instances: " << sSkinning.GetInstanceCount() << std::endl;
+}
+
+void Renderer::ToggleDynamicResolution() {
+    sDynamicResolution.SetEnabled(!sDynamicResolution.IsEnabled());
+    std::cout << "Dynamic resolution: " << (sDynamicResolution.IsEnabled() ? "ON" : "OFF") << std::endl;
+}
+
+void Renderer::SetDynamicResolution(float minScale, float maxScale, float targetMs) {
+    sDynamicResolution.SetLimits(minScale, maxScale);
+    sDynamicResolution.SetTargetMs(targetMs);
+}
+
+DynamicResolutionStats Renderer::GetDynamicResolutionStats() {
+    DynamicResolutionStats stats;
+    stats.enabled = sDynamicResolution.IsEnabled();
+    stats.scale = sDynamicResolution.GetScale();
+    stats.targetScale = sDynamicResolution.GetTargetScale();
+    stats.minScale = sDynamicResolution.GetMinScale();
+    stats.maxScale = sDynamicResolution.GetMaxScale();
+    stats.gpuMs = sDynamicResolution.GetGpuMs();
+    stats.targetMs = sDynamicResolution.GetTargetMs();
+    stats.renderWidth = sRenderW;
+    stats.renderHeight = sRenderH;
+    return stats;
+}
+
+FrameStats Renderer::GetFrameStats() {
+    return sLastFrameStats;
+}
+
+void Renderer::ToggleGLInstrumentation() {
+    if (GLTrace::IsInstalled()) GLTrace::Uninstall();
+    else GLTrace::Install();
+}
+
+void Renderer::ToggleGLTrace() {
+    if (GLTrace::IsCapturing()) GLTrace::StopCapture();
+    else GLTrace::StartCapture(kGLTracePath, kGLTraceMaxBytes);
+}
+
+void Renderer::PrintFrameDetails() {
+    sPrintFrameDetails = true;
+}
 
-        if (hasTexture) {
-            mat->diffuseTexture->Unbind();
+void Renderer::ToggleStaticBatching() {
+    sStaticBatching = !sStaticBatching;
+    std::cout << "Static batching: " << (sStaticBatching ? "ON" : "OFF") << std::endl;
+
+    // Solo cambia al cargar: se recarga el modelo actual
+    if (!sLastModelPath.empty() && !sStreaming) {
+        std::string path = sLastModelPath;
+        LoadModelFromPath(path);
+    }
+}
+
+void Renderer::SetStaticBatchLimits(size_t maxPartIndices, size_t maxBatchIndices, float maxBatchExtent) {
+    sBatchSettings.maxPartIndices = maxPartIndices;
+    sBatchSettings.maxBatchIndices = maxBatchIndices;
+    sBatchSettings.maxBatchExtent = maxBatchExtent;
+}
+
+void Renderer::ToggleClusterCulling() {
+    sClusterCulling = !sClusterCulling;
+    std::cout << "Cluster cone culling: " << (sClusterCulling ? "ON" : "OFF") << std::endl;
+}
+
+void Renderer::ToggleOcclusionCulling() {
+    sOcclusionCulling = !sOcclusionCulling;
+    std::cout << "Occlusion culling: " << (sOcclusionCulling ? "ON" : "OFF") << std::endl;
+}
+
+// Cajas de los meshes pesados contra el depth buffer ya completo del frame.
+// El resultado se usa en el siguiente frame con conditional render.
+int Renderer::IssueOcclusionQueries(const float cameraPos[3], float nearPlane) {
+    // La vista de la camara ya esta en FrameData
+    GLState::UseProgram(sBoxProgram);
+    int locMin = glGetUniformLocation(sBoxProgram, "uBoxMin");
+    int locMax = glGetUniformLocation(sBoxProgram, "uBoxMax");
+
+    GLState::ColorMask(false);
+    GLState::DepthMask(false);
+    // LEQUAL: un mesh en una cara de su caja (paredes, suelos) deja la misma
+    // profundidad que la caja y con LESS se daria por oculto a si mismo
+    GLState::DepthFunc(GL_LEQUAL);
+    GLState::PolygonMode(GL_FILL);
+    GLState::BindVertexArray(sBoxVAO);
+
+    int issued = 0;
+    for (size_t i : sQueryCandidates) {
+        Mesh& mesh = sMeshes[i];
+        if (mesh.queryPending) continue;
+
+        // Coherencia temporal: los visibles se re-consultan escalonados
+        if (mesh.queryVisible && mesh.queryFrame != 0 &&
+            (sDrawFrame + (unsigned)i) % kVisibleRequeryInterval != 0) {
+            continue;
         }
 
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR && shouldDebug && i == 0) {
-            std::cerr << "  OpenGL Error: " << err << std::endl;
+        // Con la camara dentro de la caja el near plane la recortaria
+        bool inside = true;
+        for (int k = 0; k < 3; ++k) {
+            inside = inside && cameraPos[k] >= mesh.boundsMin[k] - nearPlane
+                && cameraPos[k] <= mesh.boundsMax[k] + nearPlane;
         }
+        if (inside) {
+            mesh.queryVisible = true;
+            mesh.queryFrame = 0;
+            continue;
+        }
+
+        if (locMin != -1) glUniform3fv(locMin, 1, mesh.boundsMin);
+        if (locMax != -1) glUniform3fv(locMax, 1, mesh.boundsMax);
+
+        glBeginQuery(sQueryTarget, mesh.occlusionQuery);
+        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        glEndQuery(sQueryTarget);
+
+        mesh.queryFrame = sDrawFrame;
+        mesh.queryPending = true;
+        issued++;
     }
 
-    // Restaurar estado
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glLineWidth(1.0f);
+    GLState::ColorMask(true);
+    GLState::DepthMask(true);
+    GLState::DepthFunc(GL_LESS);
+    return issued;
+}
 
-    drawCallCount++;
+void Renderer::ToggleOcclusionQueries() {
+    sOcclusionQueries = !sOcclusionQueries;
+    std::cout << "GPU occlusion queries: " << (sOcclusionQueries ? "ON" : "OFF") << std::endl;
 }
+
+void Renderer::ToggleDepthPrepass() {
+    sDepthPrepass = !sDepthPrepass;
+    std::cout << "Depth prepass: " << (sDepthPrepass ? "ON" : "OFF") << std::endl;
+}
+
+void Renderer::ToggleOverdrawHeatmap() {
+    sOverdrawHeatmap = !sOverdrawHeatmap;
+    std::cout << "Overdraw heatmap: " << (sOverdrawHeatmap ? "ON" : "OFF") << std::endl;
+}
+
+void Renderer::AddDebugLights(size_t count) {
+    // Semilla fija: el mismo modelo produce siempre las mismas luces
+    static std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    float half = std::max(sModelSize, 1e-3f) * 0.5f;
+    size_t added = 0;
+    while (added < count && sLighting.GetLightCount() < kMaxLightCount) {
+        PointLight light;
+        for (int k = 0; k < 3; ++k) {
+            light.position[k] = (unit(rng) * 2.0f - 1.0f) * half;
+        }
+        light.radius = half * (0.1f + 0.15f * unit(rng));
+
+        // Tono aleatorio con saturacion alta
+        float hue = unit(rng) * 6.0f;
+        float f = hue - std::floor(hue);
+        const float rgb[6][3] = { { 1, f, 0 }, { 1 - f, 1, 0 }, { 0, 1, f }, { 0, 1 - f, 1 }, { f, 0, 1 }, { 1, 0, 1 - f } };
+        const float* c = rgb[(int)hue % 6];
+        for (int k = 0; k < 3; ++k) {
+            light.color[k] = 0.3f + 0.7f * c[k];
+        }
+        light.intensity = 0.8f;
+
+        sLighting.AddLight(light);
+        added++;
+    }
+    std::cout << "Lights: " << sLighting.GetLightCount() << " (+" << added << ")" << std::endl;
+}
+
+void Renderer::ToggleShadows() {
+    sShadows.SetEnabled(!sShadows.IsEnabled());
+    std::cout << "Shadows: " << (sShadows.IsEnabled() ? "ON" : "OFF") << std::endl;
+}
+
+bool Renderer::PickAt(Camera* camera, int mouseX, int mouseY, PickResult& out) {
+    out = PickResult();
+    if (!camera || sPicker.IsEmpty()) {
+        if (sStreaming) std::cout << "Picking: not available for streamed models" << std::endl;
+        return false;
+    }
+
+    float P[16], V[16], PV[16], invPV[16];
+    float aspect = sViewportH > 0 ? (float)sViewportW / (float)sViewportH : 1.0f;
+    camera->GetProjectionMatrix(P, aspect);
+    camera->GetViewMatrix(V);
+    MatMul(PV, P, V);
+    if (!MatInverse(invPV, PV)) return false;
+
+    // Cursor a NDC (y hacia arriba) y de vuelta a mundo en los planos near y far
+    float ndcX = 2.0f * (mouseX + 0.5f) / std::max(sViewportW, 1) - 1.0f;
+    float ndcY = 1.0f - 2.0f * (mouseY + 0.5f) / std::max(sViewportH, 1);
+    float points[2][3];
+    for (int p = 0; p < 2; ++p) {
+        float ndcZ = p == 0 ? -1.0f : 1.0f;
+        float clip[4];
+        for (int r = 0; r < 4; ++r) {
+            clip[r] = invPV[r] * ndcX + invPV[r + 4] * ndcY + invPV[r + 8] * ndcZ + invPV[r + 12];
+        }
+        for (int k = 0; k < 3; ++k) points[p][k] = clip[k] / clip[3];
+    }
+    float dir[3] = { points[1][0] - points[0][0], points[1][1] - points[0][1], points[1][2] - points[0][2] };
+
+    bool hit = sPicker.Intersect(points[0], dir, out);
+    if (hit) {
+        // La distancia se mide desde el plano near: se pasa a distancia a la camara
+        float camPos[3];
+        camera->GetPosition(camPos[0], camPos[1], camPos[2]);
+        float d[3] = { out.position[0] - camPos[0], out.position[1] - camPos[1], out.position[2] - camPos[2] };
+        out.distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+        // Dentro de un lote, la parte que contiene el triangulo
+        const Mesh& mesh = sMeshes[out.mesh];
+        out.sourceMesh = mesh.sourceIndex;
+        out.sourceTriangle = out.triangle;
+        if (mesh.partCount > 0) {
+            auto first = sBatchParts.begin() + mesh.firstPart;
+            auto last = first + mesh.partCount;
+            unsigned int index = out.triangle * 3;
+            auto part = std::upper_bound(first, last, index, [](unsigned int i, const StaticBatchPart& p) {
+                return i < p.firstIndex;
+            }) - 1;
+            out.sourceMesh = part->sourceIndex;
+            out.sourceTriangle = (index - part->firstIndex) / 3;
+        }
+
+        std::cout << "Pick: mesh " << out.mesh << ", triangle " << out.triangle
+            << " (source mesh " << out.sourceMesh << ", triangle " << out.sourceTriangle << ")"
+            << ", barycentrics (" << (1.0f - out.u - out.v) << ", " << out.u << ", " << out.v << ")"
+            << ", distance " << out.distance
+            << ", point (" << out.position[0] << ", " << out.position[1] << ", " << out.position[2] << ")";
+    }
+    else {
+        std::cout << "Pick: no hit";
+    }
+    std::cout << " [" << sPicker.GetLastQueryMs() << " ms, " << sPicker.GetLastNodesVisited()
+        << " nodes, " << sPicker.GetTriangleCount() << " triangles]" << std::endl;
+    return hit;
+}
+
 void Renderer::ToggleWireframe() {
     sWireframeMode = !sWireframeMode;
     std::cout << "Wireframe mode: " << (sWireframeMode ? "ON" : "OFF") << std::endl;
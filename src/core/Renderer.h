@@ -3,18 +3,103 @@
 #include <vector>
 
 class Camera;
-class Texture;
+class TextureArray;
+class StreamingManager;
+struct PickResult;
+
+// Grupo de ~124 triangulos contiguos en el index buffer de un Mesh
+struct Meshlet {
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    float center[3] = { 0.0f, 0.0f, 0.0f };   // esfera envolvente
+    float radius = 0.0f;
+    float coneAxis[3] = { 0.0f, 0.0f, 0.0f };  // cono de normales
+    float coneCutoff = 2.0f;                   // seno del semiangulo; >= 1 sin cono
+};
+
+// Mesh de origen dentro de un lote estatico (MeshBuilder::BuildStaticBatches)
+struct StaticBatchPart {
+    int sourceIndex = -1;            // aiMesh de origen
+    unsigned int firstIndex = 0;     // rango en el index buffer del lote
+    unsigned int indexCount = 0;
+    unsigned int firstMeshlet = 0;   // relativo al primer meshlet del lote
+    unsigned int meshletCount = 0;
+    float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+};
 
 struct Mesh {
     unsigned int VAO = 0;
     unsigned int VBO = 0;
     unsigned int EBO = 0;
+    unsigned int depthVAO = 0;       // solo posiciones, para el depth prepass
+    unsigned int positionVBO = 0;    // 0 si el VBO ya es solo posicion
     size_t indexCount = 0;
     int materialIndex = -1;
+    unsigned int firstMeshlet = 0;   // rango en Renderer::sMeshlets
+    unsigned int meshletCount = 0;
+    float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+    // Occlusion query de la caja (solo meshes pesados)
+    unsigned int occlusionQuery = 0;
+    unsigned int queryFrame = 0;     // frame en que se lanzo (0 = nunca)
+    bool queryPending = false;
+    bool queryVisible = true;        // ultimo resultado leido
+    int sourceIndex = -1;            // entrada de ModelBuildData::meshes (aiMesh o lote)
+    unsigned int firstPart = 0;      // lote estatico: rango en Renderer::sBatchParts
+    unsigned int partCount = 0;
+    size_t vertexBytes = 0;          // VBO + positionVBO + skinVBO
+    size_t indexBytes = 0;
+    unsigned int skinVBO = 0;        // indices y pesos de huesos (atributos 3 y 4)
+    bool skinned = false;            // se dibuja instanciado con la paleta de SkinningSystem
+};
+
+// Estado de la resolucion dinamica (escala por eje respecto a la ventana)
+struct DynamicResolutionStats {
+    bool enabled = false;
+    float scale = 1.0f;             // la de este frame
+    float targetScale = 1.0f;       // la que pide el controlador
+    float minScale = 1.0f, maxScale = 1.0f;
+    double gpuMs = 0.0;             // tiempo de GPU del frame (media)
+    float targetMs = 0.0f;
+    int renderWidth = 0, renderHeight = 0;
+};
+
+// Contadores de un frame completo (el anterior al que se esta grabando).
+// Los de GL solo se llenan con la instrumentacion activa (GLTrace).
+struct FrameStats {
+    unsigned long long frame = 0;
+    double frameMs = 0.0;           // de BeginFrame a BeginFrame
+    double gpuMs = 0.0;             // media de DynamicResolution
+    int renderWidth = 0, renderHeight = 0;
+    // Escena
+    int drawItems = 0;              // meshes que pasan el culling
+    size_t visibleMeshlets = 0, totalMeshlets = 0;
+    int multiDraws = 0;
+    int textureBinds = 0;
+    int skinnedDraws = 0;
+    int occludedMeshes = 0;
+    int occludedParts = 0;          // partes de lotes estaticos
+    int queriesIssued = 0, conditionalDraws = 0, skippedDraws = 0;
+    double shadedSamplesPerPixel = 0.0;
+    // GLState y anillo de datos dinamicos
+    unsigned long long stateIssued = 0, stateFiltered = 0;
+    size_t ringBytes = 0;
+    // Llamadas a GL
+    bool glInstrumented = false;
+    unsigned long long glCalls = 0;
+    unsigned long long drawCalls = 0;
+    unsigned long long triangles = 0;
+    unsigned long long instances = 0;
+    unsigned long long stateChanges = 0;
+    unsigned long long uniformUpdates = 0;
+    unsigned long long bufferUploads = 0, bufferBytes = 0;
+    unsigned long long textureUploads = 0, textureBytes = 0;
 };
 
 struct Material {
-    Texture* diffuseTexture = nullptr;
+    int textureArray = -1;  // indice en sTextureArrays (-1 = sin textura)
+    int textureLayer = -1;  // capa dentro del array
     float color[3] = { 0.8f, 0.8f, 0.8f };
 };
 
@@ -23,6 +108,10 @@ public:
     static bool Init();
     static void Shutdown();
 
+    // Un solo frame en vuelo: BeginFrame espera a que la GPU termine el anterior
+    static void BeginFrame();
+    static void EndFrame();
+
     static void Clear(float r, float g, float b, float a);
     static void DrawTriangle();
     static void DrawRectangleIndexed(bool wireframe);
@@ -31,11 +120,14 @@ public:
     static bool LoadModelFromPath(const std::string& path);
     static void DrawLoadedModel(Camera* camera);
 
+    // Mide el import del ultimo modelo con 1..N workers
+    static void RunImportBenchmark();
+
     static void SetViewportSize(int w, int h);
     static int GetViewportWidth() { return sViewportW; }
     static int GetViewportHeight() { return sViewportH; }
 
-    static bool HasLoadedModel() { return !sMeshes.empty(); }
+    static bool HasLoadedModel();
     static void GetModelCenter(float& x, float& y, float& z);
     static float GetModelSize();
 
@@ -43,6 +135,50 @@ public:
     static void ToggleWireframe();
     static bool IsWireframeEnabled() { return sWireframeMode; }
 
+    // Descarte por meshlet de clusters de espaldas (cono de normales)
+    static void ToggleClusterCulling();
+    // Occlusion culling por software contra los occluders elegidos al cargar
+    static void ToggleOcclusionCulling();
+    // Occlusion queries en GPU con conditional render (un frame de latencia)
+    static void ToggleOcclusionQueries();
+    // Depth prepass (color con GL_EQUAL) y mapa de calor de overdraw
+    static void ToggleDepthPrepass();
+    static void ToggleOverdrawHeatmap();
+    // Luces puntuales aleatorias dentro de la escena (clustered lighting)
+    static void AddDebugLights(size_t count);
+    // Cascaded shadow maps del sol
+    static void ToggleShadows();
+    // Resolucion de la escena segun el tiempo de GPU (escalada a la ventana)
+    static void ToggleDynamicResolution();
+    static void SetDynamicResolution(float minScale, float maxScale, float targetMs);
+    static DynamicResolutionStats GetDynamicResolutionStats();
+
+    // Lotes estaticos al cargar: meshes pequenos con el mismo material en un
+    // solo VBO/EBO. Cambiarlo recarga el modelo.
+    static void ToggleStaticBatching();
+    // Indices maximos de un mesh para entrar en un lote, del lote entero, y
+    // diagonal maxima del lote relativa al tamano de la escena
+    static void SetStaticBatchLimits(size_t maxPartIndices, size_t maxBatchIndices, float maxBatchExtent);
+
+    // Contadores del ultimo frame completo; cada pocos segundos se imprime
+    // un resumen en una linea
+    static FrameStats GetFrameStats();
+    // Envoltorios de GL que cuentan draws, estado y subidas (GLTrace)
+    static void ToggleGLInstrumentation();
+    // Traza binaria de las llamadas a GL (gltrace.bin)
+    static void ToggleGLTrace();
+    // Detalle de cada subsistema en el siguiente frame
+    static void PrintFrameDetails();
+
+    // Avanza las animaciones (antes de DrawLoadedModel)
+    static void UpdateAnimation(float dt);
+    // 1 -> 16 -> 128 -> 512 instancias animadas del modelo
+    static void CycleAnimatedInstances();
+
+    // Rayo desde el cursor (coordenadas de ventana); mesh en PickResult es el
+    // indice en sMeshes. No disponible con modelos paginados.
+    static bool PickAt(Camera* camera, int mouseX, int mouseY, PickResult& out);
+
 private:
     static unsigned int sProgram;
     static unsigned int sTriVAO, sTriVBO;
@@ -50,9 +186,21 @@ private:
 
     static unsigned int sModelProgram;
     static unsigned int sModelProgramTextured;
+    static unsigned int sBoxProgram;
+    static unsigned int sDepthProgram;
+    // Variantes con skinning en el vertex shader
+    static unsigned int sModelProgramSkinned;
+    static unsigned int sModelProgramTexturedSkinned;
+    static unsigned int sDepthProgramSkinned;
+    static unsigned int sBoxVAO, sBoxVBO, sBoxEBO;
 
     static std::vector<Mesh> sMeshes;
+    static std::vector<Meshlet> sMeshlets;
+    static std::vector<StaticBatchPart> sBatchParts;
     static std::vector<Material> sMaterials;
+    static std::vector<TextureArray*> sTextureArrays;
+    static std::string sLastModelPath;
+    static StreamingManager* sStreaming;   // modelo .mpages (out-of-core)
 
     static int sViewportW, sViewportH;
 
@@ -60,6 +208,18 @@ private:
     static float sModelSize;
 
     static bool sWireframeMode; // NUEVO
+    static bool sClusterCulling;
+    static bool sOcclusionCulling;
+    static bool sOcclusionQueries;
+    static bool sDepthPrepass;
+    static bool sOverdrawHeatmap;
 
     static void ClearModelData();
+    static bool OpenStreaming(const std::string& path);
+    static int IssueOcclusionQueries(const float cameraPos[3], float nearPlane);
+    // Meshes skinned, un draw instanciado por mesh con la vista enlazada en
+    // UniformBuffers; devuelve los draws
+    static int DrawSkinnedMeshes(bool depthOnly, bool unlit);
+    static void BuildTextureArrays(const std::vector<std::string>& paths,
+        std::vector<int>& outArray, std::vector<int>& outLayer);
 };
\ No newline at end of file
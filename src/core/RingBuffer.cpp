@@ -0,0 +1,162 @@
+#include "RingBuffer.h"
+#include "GLState.h"
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// GL_ARB_buffer_storage / GL 4.4; puede no venir en el loader de 3.3
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+RingBuffer::RingBuffer()
+    : mBuffer(0), mTarget(0), mPersistent(false), mMapped(nullptr), mRegionBytes(0), mSize(0), mAlignment(1),
+      mTrackedBytes(0), mRegion(0), mHead(0), mRegionEnd(0), mFrameBytes(0), mPeakFrameBytes(0),
+      mStalls(0), mOrphans(0), mOverflows(0), mStallMs(0.0) {
+    for (int i = 0; i < kFrames; ++i) mFences[i] = nullptr;
+}
+
+bool RingBuffer::Init(unsigned int target, size_t bytesPerFrame, size_t alignment, bool persistent) {
+    if (mBuffer) return true;
+
+    mTarget = target;
+    mAlignment = std::max<size_t>(1, alignment);
+    mRegionBytes = (bytesPerFrame + mAlignment - 1) / mAlignment * mAlignment;
+    mSize = mRegionBytes * kFrames;
+
+    glGenBuffers(1, &mBuffer);
+    GLState::BindBuffer(mTarget, mBuffer);
+
+    mPersistent = persistent && glBufferStorage != nullptr;
+    if (mPersistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(mTarget, (GLsizeiptr)mSize, nullptr, flags);
+        mMapped = (unsigned char*)glMapBufferRange(mTarget, 0, (GLsizeiptr)mSize, flags);
+        if (!mMapped) {
+            // Sin mapeo persistente: se rehace el buffer como uno normal
+            std::cerr << "RingBuffer: persistent mapping failed, using orphaning" << std::endl;
+            GLState::DeleteBuffers(1, &mBuffer);
+            glGenBuffers(1, &mBuffer);
+            GLState::BindBuffer(mTarget, mBuffer);
+            mPersistent = false;
+        }
+    }
+    if (!mPersistent) {
+        glBufferData(mTarget, (GLsizeiptr)mSize, nullptr, GL_STREAM_DRAW);
+    }
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mTrackedBytes, mSize);
+
+    mRegion = 0;
+    mHead = 0;
+    mRegionEnd = mRegionBytes;
+    std::cout << "RingBuffer: " << (mSize >> 10) << " KB, "
+        << (mPersistent ? "persistent coherent mapping" : "unsynchronized map + orphaning") << std::endl;
+    return true;
+}
+
+void RingBuffer::Shutdown() {
+    for (int i = 0; i < kFrames; ++i) {
+        if (mFences[i]) glDeleteSync((GLsync)mFences[i]);
+        mFences[i] = nullptr;
+    }
+    if (mBuffer) {
+        if (mMapped) {
+            GLState::BindBuffer(mTarget, mBuffer);
+            glUnmapBuffer(mTarget);
+        }
+        GLState::DeleteBuffers(1, &mBuffer);
+    }
+    mBuffer = 0;
+    mMapped = nullptr;
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mTrackedBytes, 0);
+}
+
+void RingBuffer::BeginFrame() {
+    mPeakFrameBytes = std::max(mPeakFrameBytes, mFrameBytes);
+    mFrameBytes = 0;
+    if (!mBuffer) return;
+
+    // Sin persistencia el cursor sigue donde estaba: se escribe sobre memoria
+    // que la GPU nunca ha visto. Se huerfana aqui y no a mitad de frame, que
+    // perderia los bloques ya escritos (la vista de la camara).
+    if (!mPersistent) {
+        mHead = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+        if (mHead + mRegionBytes > mSize) {
+            // Almacenamiento nuevo; el driver suelta el viejo cuando la GPU acabe
+            GLState::BindBuffer(mTarget, mBuffer);
+            glBufferData(mTarget, (GLsizeiptr)mSize, nullptr, GL_STREAM_DRAW);
+            mHead = 0;
+            mOrphans++;
+        }
+        mRegionEnd = mHead + mRegionBytes;
+        return;
+    }
+
+    mRegion = (mRegion + 1) % kFrames;
+    GLsync fence = (GLsync)mFences[mRegion];
+    if (fence) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            // La GPU va kFrames frames por detras: hay que esperar
+            mStalls++;
+            auto start = std::chrono::steady_clock::now();
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+            } while (status == GL_TIMEOUT_EXPIRED);
+            mStallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        glDeleteSync(fence);
+        mFences[mRegion] = nullptr;
+    }
+    mHead = mRegion * mRegionBytes;
+    mRegionEnd = mHead + mRegionBytes;
+}
+
+void RingBuffer::EndFrame() {
+    if (!mBuffer || !mPersistent) return;
+    if (mFences[mRegion]) glDeleteSync((GLsync)mFences[mRegion]);
+    mFences[mRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool RingBuffer::Write(const void* data, size_t bytes, size_t& offset) {
+    if (!mBuffer || bytes > mRegionBytes) {
+        mOverflows++;
+        return false;
+    }
+
+    size_t aligned = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+    if (aligned + bytes > mRegionEnd) {
+        mOverflows++;
+        return false;
+    }
+    if (mPersistent) {
+        std::memcpy(mMapped + aligned, data, bytes);
+    } else {
+        GLState::BindBuffer(mTarget, mBuffer);
+        void* dst = glMapBufferRange(mTarget, (GLintptr)aligned, (GLsizeiptr)bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!dst) {
+            mOverflows++;
+            return false;
+        }
+        std::memcpy(dst, data, bytes);
+        glUnmapBuffer(mTarget);
+    }
+
+    offset = aligned;
+    mHead = aligned + bytes;
+    mFrameBytes += bytes;
+    return true;
+}
+
+void RingBuffer::PrintStats() const {
+    std::cout << "Ring buffer: " << (mPersistent ? "persistent" : "orphaning") << ", "
+        << mFrameBytes << " bytes this frame (peak " << std::max(mPeakFrameBytes, mFrameBytes) << " of "
+        << mRegionBytes << " per frame), " << mStalls << " stalls (" << mStallMs << " ms), "
+        << mOrphans << " orphans, " << mOverflows << " overflows" << std::endl;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+
+// Buffer de datos dinamicos del frame (bloques de vista, instancias...) que
+// se escriben una vez y la GPU lee en ese mismo frame. Con
+// GL_ARB_buffer_storage (o GL 4.4) se mapea una sola vez, persistente y
+// coherente, en kFrames regiones: cada frame escribe en la suya y un fence
+// dice cuando la GPU ha terminado de leerla. En GL 3.3 pelado se escribe
+// seguido con glMapBufferRange sin sincronizar y el buffer se huerfana con
+// glBufferData solo al empezar un frame, si no queda una region entera: lo
+// escrito en un frame sigue valido hasta que acaba.
+class RingBuffer {
+public:
+    static const int kFrames = 3;
+
+    RingBuffer();
+
+    // 'target' es donde se enlaza para mapear en el modo de respaldo;
+    // 'alignment' el de los offsets (p. ej. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+    bool Init(unsigned int target, size_t bytesPerFrame, size_t alignment, bool persistent);
+    void Shutdown();
+
+    // Pasa a la region siguiente, esperando a la GPU si aun la lee
+    void BeginFrame();
+    // Fence de la region del frame
+    void EndFrame();
+
+    // Copia los datos al anillo y devuelve su offset en GetBuffer(); false si
+    // no caben en lo que queda de la region del frame
+    bool Write(const void* data, size_t bytes, size_t& offset);
+
+    unsigned int GetBuffer() const { return mBuffer; }
+    bool IsPersistent() const { return mPersistent; }
+    size_t GetFrameBytes() const { return mFrameBytes; }
+
+    // Esperas por regiones aun en uso, huerfanos y escrituras que no cabian
+    unsigned long long GetStalls() const { return mStalls; }
+    double GetStallMs() const { return mStallMs; }
+    unsigned long long GetOrphans() const { return mOrphans; }
+    unsigned long long GetOverflows() const { return mOverflows; }
+    void PrintStats() const;
+
+private:
+    unsigned int mBuffer;
+    unsigned int mTarget;
+    bool mPersistent;
+    unsigned char* mMapped;         // todo el buffer (solo persistente)
+    size_t mRegionBytes;
+    size_t mSize;                   // kFrames * mRegionBytes
+    size_t mAlignment;
+    size_t mTrackedBytes;           // para MemoryTracker
+    int mRegion;                    // region del frame actual
+    size_t mHead;                   // siguiente byte libre
+    size_t mRegionEnd;
+    void* mFences[kFrames];         // GLsync por region
+    size_t mFrameBytes, mPeakFrameBytes;
+    unsigned long long mStalls, mOrphans, mOverflows;
+    double mStallMs;
+};
@@ -1,4 +1,5 @@
 #include "Shader.h"
+#include "GLState.h"
 #include <glad/glad.h>
 #include <iostream>
 #include <vector>
@@ -7,7 +8,7 @@
 
 Shader::~Shader() {
     if (m_Program) {
-        glDeleteProgram(m_Program);
+        GLState::DeleteProgram(m_Program);
         m_Program = 0;
     }
 }
@@ -30,7 +31,7 @@ bool Shader::CompileFromSource(const char* vertexSrc, const char* fragmentSrc) {
         glGetProgramInfoLog(m_Program, len, nullptr, log.data());
         std::cerr << "PROGRAM LINK ERROR:\n" << log.data() << std::endl;
         glDeleteShader(vs); glDeleteShader(fs);
-        glDeleteProgram(m_Program); m_Program = 0;
+        GLState::DeleteProgram(m_Program); m_Program = 0;
         return false;
     }
 
@@ -58,7 +59,7 @@ bool Shader::CompileShader(unsigned int& outId, unsigned int type, const char* s
     return true;
 }
 
-void Shader::Use() const { glUseProgram(m_Program); }
+void Shader::Use() const { GLState::UseProgram(m_Program); }
 
 unsigned int Shader::ReleaseProgram() {
     unsigned int t = m_Program;
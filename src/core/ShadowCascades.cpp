@@ -0,0 +1,378 @@
+#include "ShadowCascades.h"
+#include "GLState.h"
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+static const char* kShadowCascadesGLSL = R"(
+uniform sampler2DArrayShadow uShadowMap;
+uniform mat4 uShadowMatrices[4];
+uniform vec4 uCascadeSplits;        // profundidad en vista del final de cada cascada
+uniform vec4 uCascadeTexel;         // tamano del texel en unidades de mundo
+uniform bool uShadowsEnabled;
+uniform vec3 uSunDir;               // hacia la luz
+
+float SunShadow(vec3 n, float viewZ) {
+    if (!uShadowsEnabled || viewZ > uCascadeSplits[3]) return 1.0;
+
+    int cascade = 0;
+    for (int i = 0; i < 3; ++i) {
+        if (viewZ > uCascadeSplits[i]) cascade = i + 1;
+    }
+
+    // Normal offset: evita el acne sin despegar la sombra del objeto
+    vec3 p = vWorldPos + n * uCascadeTexel[cascade] * 1.5;
+    vec3 uvz = (uShadowMatrices[cascade] * vec4(p, 1.0)).xyz * 0.5 + 0.5;
+    if (any(lessThan(uvz, vec3(0.0))) || any(greaterThan(uvz, vec3(1.0)))) return 1.0;
+
+    // PCF 3x3 sobre el filtrado bilineal de la comparacion
+    float texel = 1.0 / float(textureSize(uShadowMap, 0).x);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            lit += texture(uShadowMap, vec4(uvz.xy + vec2(x, y) * texel, float(cascade), uvz.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+vec3 SunLight(vec3 albedo, vec3 n, float viewZ) {
+    float ndl = max(dot(n, uSunDir), 0.0);
+    if (ndl <= 0.0) return vec3(0.0);
+    return albedo * 0.5 * ndl * SunShadow(n, viewZ);
+}
+)";
+
+static const float kSplitLambda = 0.75f;        // mezcla reparto logaritmico / lineal
+static const float kExtentPadding = 1.25f;      // margen para el ajuste a rejilla
+static const float kSnapFraction = 0.25f;       // paso de la rejilla / semilado
+
+const char* ShadowCascades::GetShaderSource() {
+    return kShadowCascadesGLSL;
+}
+
+static void Normalize(float v[3]) {
+    float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (len > 0.0f) {
+        v[0] /= len; v[1] /= len; v[2] /= len;
+    }
+}
+
+static void Cross(float o[3], const float a[3], const float b[3]) {
+    o[0] = a[1] * b[2] - a[2] * b[1];
+    o[1] = a[2] * b[0] - a[0] * b[2];
+    o[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static float Dot(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+ShadowCascades::ShadowCascades()
+    : mStaticArray(0), mCompositeArray(0), mDrawFBO(0), mReadFBO(0),
+      mSceneRadius(1.0f), mEnabled(true), mHasDynamic(false) {
+    for (Cascade& c : mCascades) {
+        c = Cascade();
+    }
+    mLightDir[0] = mLightDir[1] = mLightDir[2] = 0.0f;
+    const float defaultDir[3] = { 0.4f, 0.8f, 0.3f };
+    SetLightDirection(defaultDir);
+}
+
+// Depth32F: 4 bytes por texel y cascada
+static const size_t kArrayBytes = (size_t)ShadowCascades::kResolution * ShadowCascades::kResolution *
+    ShadowCascades::kCascadeCount * 4;
+
+unsigned int ShadowCascades::CreateDepthArray() const {
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, tex);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, kResolution, kResolution, kCascadeCount,
+        0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    MemoryTracker::Allocate(MemoryCategory::RenderTarget, kArrayBytes);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    return tex;
+}
+
+bool ShadowCascades::Init() {
+    if (mStaticArray) return true;
+
+    mStaticArray = CreateDepthArray();
+
+    glGenFramebuffers(1, &mDrawFBO);
+    glGenFramebuffers(1, &mReadFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, mDrawFBO);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, mReadFBO);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (Cascade& c : mCascades) {
+        glGenQueries(1, &c.staticQuery);
+        glGenQueries(1, &c.frameQuery);
+    }
+
+    std::cout << "Shadow cascades: " << kCascadeCount << " x " << kResolution << "x" << kResolution << std::endl;
+    return true;
+}
+
+void ShadowCascades::Shutdown() {
+    for (Cascade& c : mCascades) {
+        if (c.staticQuery) glDeleteQueries(1, &c.staticQuery);
+        if (c.frameQuery) glDeleteQueries(1, &c.frameQuery);
+        c.staticQuery = c.frameQuery = 0;
+        c.staticQueryPending = c.frameQueryPending = false;
+    }
+    for (GLuint* tex : { &mStaticArray, &mCompositeArray }) {
+        if (!*tex) continue;
+        GLState::DeleteTextures(1, tex);
+        MemoryTracker::Free(MemoryCategory::RenderTarget, kArrayBytes);
+    }
+    if (mDrawFBO) glDeleteFramebuffers(1, &mDrawFBO);
+    if (mReadFBO) glDeleteFramebuffers(1, &mReadFBO);
+    mStaticArray = mCompositeArray = mDrawFBO = mReadFBO = 0;
+    Invalidate();
+}
+
+void ShadowCascades::SetLightDirection(const float dir[3]) {
+    float d[3] = { dir[0], dir[1], dir[2] };
+    Normalize(d);
+    if (d[0] == mLightDir[0] && d[1] == mLightDir[1] && d[2] == mLightDir[2]) return;
+
+    mLightDir[0] = d[0]; mLightDir[1] = d[1]; mLightDir[2] = d[2];
+
+    // Base del espacio de luz
+    float travel[3] = { -d[0], -d[1], -d[2] };
+    float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+    if (std::fabs(travel[1]) > 0.99f) {
+        worldUp[0] = 1.0f; worldUp[1] = 0.0f;
+    }
+    Cross(mRight, worldUp, travel);
+    Normalize(mRight);
+    Cross(mUp, travel, mRight);
+
+    Invalidate();
+}
+
+void ShadowCascades::SetSceneRadius(float radius) {
+    mSceneRadius = std::max(radius, 1e-3f);
+    Invalidate();
+}
+
+void ShadowCascades::Invalidate() {
+    for (Cascade& c : mCascades) {
+        c.staticValid = false;
+        c.extent = 0.0f;
+    }
+}
+
+void ShadowCascades::FitCascade(Cascade& cascade, float splitNear, float splitFar, float tanX, float tanY,
+    const float cameraPos[3], const float forward[3]) {
+    // Esfera minima del tramo [splitNear, splitFar] con el centro en el eje de vista
+    float k2 = tanX * tanX + tanY * tanY;
+    float centerDist = (splitFar + splitNear) * (1.0f + k2) * 0.5f;
+    float radius;
+    if (centerDist >= splitFar) {
+        centerDist = splitFar;
+        radius = splitFar * std::sqrt(k2);
+    } else {
+        float dz = centerDist - splitNear;
+        radius = std::sqrt(dz * dz + splitNear * splitNear * k2);
+    }
+
+    float center[3];
+    for (int k = 0; k < 3; ++k) center[k] = cameraPos[k] + forward[k] * centerDist;
+
+    // El centro salta en pasos de una fraccion del semilado (multiplo de texel)
+    float extent = radius * kExtentPadding;
+    float snap = extent * kSnapFraction;
+    float cx = std::round(Dot(center, mRight) / snap) * snap;
+    float cy = std::round(Dot(center, mUp) / snap) * snap;
+
+    cascade.splitFar = splitFar;
+    if (cascade.staticValid && cx == cascade.centerX && cy == cascade.centerY && extent == cascade.extent) {
+        return;
+    }
+
+    cascade.centerX = cx;
+    cascade.centerY = cy;
+    cascade.extent = extent;
+    cascade.staticValid = false;
+
+    // Ortografica en espacio de luz; la profundidad cubre toda la escena
+    float* m = cascade.viewProj;
+    float inv = 1.0f / extent;
+    float invDepth = 1.0f / mSceneRadius;
+    m[0] = mRight[0] * inv;      m[4] = mRight[1] * inv;      m[8] = mRight[2] * inv;       m[12] = -cx * inv;
+    m[1] = mUp[0] * inv;         m[5] = mUp[1] * inv;         m[9] = mUp[2] * inv;          m[13] = -cy * inv;
+    m[2] = -mLightDir[0] * invDepth; m[6] = -mLightDir[1] * invDepth; m[10] = -mLightDir[2] * invDepth; m[14] = 0.0f;
+    m[3] = 0.0f;                 m[7] = 0.0f;                 m[11] = 0.0f;                 m[15] = 1.0f;
+}
+
+void ShadowCascades::CollectQueries(Cascade& cascade) {
+    GLuint available = 0;
+    if (cascade.staticQueryPending) {
+        glGetQueryObjectuiv(cascade.staticQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(cascade.staticQuery, GL_QUERY_RESULT, &ns);
+            cascade.staticGpuMs = ns / 1.0e6;
+            cascade.staticQueryPending = false;
+        }
+    }
+    if (cascade.frameQueryPending) {
+        glGetQueryObjectuiv(cascade.frameQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(cascade.frameQuery, GL_QUERY_RESULT, &ns);
+            cascade.frameGpuMs = ns / 1.0e6;
+            cascade.frameQueryPending = false;
+        }
+    }
+}
+
+void ShadowCascades::Update(const float view[16], const float proj[16], const DrawFn& drawStatic, const DrawFn& drawDynamic) {
+    if (!mEnabled || !mStaticArray) return;
+
+    float tanX = 1.0f / proj[0];
+    float tanY = 1.0f / proj[5];
+    float nearPlane = proj[14] / (proj[10] - 1.0f);
+    float farPlane = proj[14] / (proj[10] + 1.0f);
+    float shadowFar = std::min(farPlane, std::max(nearPlane * 2.0f, mSceneRadius * 4.0f));
+
+    // Posicion y direccion de la camara a partir de la vista
+    float t[3] = { view[12], view[13], view[14] };
+    float cameraPos[3] = {
+        -(view[0] * t[0] + view[1] * t[1] + view[2] * t[2]),
+        -(view[4] * t[0] + view[5] * t[1] + view[6] * t[2]),
+        -(view[8] * t[0] + view[9] * t[1] + view[10] * t[2]) };
+    float forward[3] = { -view[2], -view[6], -view[10] };
+
+    bool needsStatic = false;
+    float splitNear = nearPlane;
+    for (int i = 0; i < kCascadeCount; ++i) {
+        float s = (float)(i + 1) / kCascadeCount;
+        float logSplit = nearPlane * std::pow(shadowFar / nearPlane, s);
+        float linSplit = nearPlane + (shadowFar - nearPlane) * s;
+        float splitFar = kSplitLambda * logSplit + (1.0f - kSplitLambda) * linSplit;
+
+        CollectQueries(mCascades[i]);
+        FitCascade(mCascades[i], splitNear, splitFar, tanX, tanY, cameraPos, forward);
+        needsStatic = needsStatic || !mCascades[i].staticValid;
+        splitNear = splitFar;
+    }
+
+    mHasDynamic = (bool)drawDynamic;
+    if (!needsStatic && !mHasDynamic) {
+        // Todo en cache: ningun comando GL este frame
+        for (Cascade& c : mCascades) c.framesReused++;
+        return;
+    }
+    if (mHasDynamic && !mCompositeArray) {
+        mCompositeArray = CreateDepthArray();
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLState::Viewport(0, 0, kResolution, kResolution);
+    GLState::SetEnabled(GL_DEPTH_TEST, true);
+    GLState::DepthFunc(GL_LESS);
+    GLState::DepthMask(true);
+    GLState::SetEnabled(GL_POLYGON_OFFSET_FILL, true);
+    glPolygonOffset(2.0f, 4.0f);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mDrawFBO);
+
+    for (int i = 0; i < kCascadeCount; ++i) {
+        Cascade& c = mCascades[i];
+
+        if (!c.staticValid) {
+            auto t0 = std::chrono::steady_clock::now();
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mStaticArray, 0, i);
+            bool timed = !c.staticQueryPending;
+            if (timed) glBeginQuery(GL_TIME_ELAPSED, c.staticQuery);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            drawStatic(c.viewProj);
+            if (timed) {
+                glEndQuery(GL_TIME_ELAPSED);
+                c.staticQueryPending = true;
+            }
+            c.staticCpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            c.staticValid = true;
+            c.staticRenders++;
+        } else {
+            c.framesReused++;
+        }
+
+        if (mHasDynamic) {
+            // Copia de la cascada estatica y lo dinamico encima
+            bool timed = !c.frameQueryPending;
+            if (timed) glBeginQuery(GL_TIME_ELAPSED, c.frameQuery);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, mReadFBO);
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mStaticArray, 0, i);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, mCompositeArray, 0, i);
+            glBlitFramebuffer(0, 0, kResolution, kResolution, 0, 0, kResolution, kResolution,
+                GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+            drawDynamic(c.viewProj);
+            if (timed) {
+                glEndQuery(GL_TIME_ELAPSED);
+                c.frameQueryPending = true;
+            }
+        }
+    }
+
+    GLState::SetEnabled(GL_POLYGON_OFFSET_FILL, false);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void ShadowCascades::Bind(unsigned int program) const {
+    GLState::BindTexture(kShadowUnit, GL_TEXTURE_2D_ARRAY, mHasDynamic ? mCompositeArray : mStaticArray);
+
+    float matrices[kCascadeCount * 16];
+    float splits[kCascadeCount];
+    float texels[kCascadeCount];
+    for (int i = 0; i < kCascadeCount; ++i) {
+        std::copy(mCascades[i].viewProj, mCascades[i].viewProj + 16, matrices + i * 16);
+        splits[i] = mCascades[i].splitFar;
+        texels[i] = 2.0f * mCascades[i].extent / kResolution;
+    }
+
+    int loc = glGetUniformLocation(program, "uShadowMap");
+    if (loc != -1) glUniform1i(loc, kShadowUnit);
+    loc = glGetUniformLocation(program, "uShadowMatrices");
+    if (loc != -1) glUniformMatrix4fv(loc, kCascadeCount, GL_FALSE, matrices);
+    loc = glGetUniformLocation(program, "uCascadeSplits");
+    if (loc != -1) glUniform4fv(loc, 1, splits);
+    loc = glGetUniformLocation(program, "uCascadeTexel");
+    if (loc != -1) glUniform4fv(loc, 1, texels);
+    loc = glGetUniformLocation(program, "uShadowsEnabled");
+    if (loc != -1) glUniform1i(loc, (mEnabled && mStaticArray) ? 1 : 0);
+    loc = glGetUniformLocation(program, "uSunDir");
+    if (loc != -1) glUniform3fv(loc, 1, mLightDir);
+}
+
+void ShadowCascades::PrintStats() const {
+    for (int i = 0; i < kCascadeCount; ++i) {
+        const Cascade& c = mCascades[i];
+        std::cout << "Shadow cascade " << i << ": far " << c.splitFar
+            << ", static " << c.staticGpuMs << " ms GPU / " << c.staticCpuMs << " ms CPU, rendered "
+            << c.staticRenders << "x, reused " << c.framesReused << " frames (~"
+            << c.staticGpuMs * c.framesReused << " ms saved)";
+        if (mHasDynamic) {
+            std::cout << ", dynamic composite " << c.frameGpuMs << " ms";
+        }
+        std::cout << std::endl;
+    }
+}
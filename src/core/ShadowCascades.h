@@ -0,0 +1,72 @@
+#pragma once
+#include <functional>
+
+// Cascaded shadow maps de la luz direccional. Cada cascada encierra su tramo
+// del frustum en una esfera (independiente de la rotacion de la camara) con el
+// centro ajustado a una rejilla gruesa en espacio de luz: mientras no cambien
+// la luz ni esos limites, la geometria estatica no se vuelve a dibujar. Lo
+// dinamico se compone cada frame sobre una copia de la cascada estatica.
+class ShadowCascades {
+public:
+    static const int kCascadeCount = 4;
+    static const int kResolution = 2048;
+    static const int kShadowUnit = 4;
+
+    // Dibuja con el programa de profundidad ya activo y esta view-projection
+    typedef std::function<void(const float lightViewProj[16])> DrawFn;
+
+    // GLSL con SunLight(albedo, n, viewZ); va despues del de ClusteredLighting
+    static const char* GetShaderSource();
+
+    ShadowCascades();
+
+    bool Init();
+    void Shutdown();
+
+    // Direccion hacia la luz (se normaliza)
+    void SetLightDirection(const float dir[3]);
+    // Radio de la escena centrada en el origen: fija el rango de profundidad
+    void SetSceneRadius(float radius);
+    void Invalidate();
+
+    void SetEnabled(bool enabled) { mEnabled = enabled; }
+    bool IsEnabled() const { return mEnabled; }
+
+    // Ajusta las cascadas; re-dibuja lo estatico solo si han cambiado.
+    // drawDynamic puede ser vacio. Deja enlazado el framebuffer 0.
+    void Update(const float view[16], const float proj[16], const DrawFn& drawStatic, const DrawFn& drawDynamic);
+    // Texturas y uniforms del programa activo
+    void Bind(unsigned int program) const;
+
+    void PrintStats() const;
+
+private:
+    struct Cascade {
+        float splitFar;
+        float extent;                   // semilado del ortho
+        float centerX, centerY;         // centro ajustado en espacio de luz
+        float viewProj[16];
+        bool staticValid;
+
+        // Tiempos: CPU al dibujar y GPU con GL_TIME_ELAPSED (un frame de retraso)
+        unsigned int staticQuery, frameQuery;
+        bool staticQueryPending, frameQueryPending;
+        double staticCpuMs, staticGpuMs, frameGpuMs;
+        unsigned long long staticRenders, framesReused;
+    };
+
+    Cascade mCascades[kCascadeCount];
+    unsigned int mStaticArray;          // solo geometria estatica
+    unsigned int mCompositeArray;       // estatica + dinamica (se crea al usarse)
+    unsigned int mDrawFBO, mReadFBO;
+    float mLightDir[3];
+    float mRight[3], mUp[3];
+    float mSceneRadius;
+    bool mEnabled;
+    bool mHasDynamic;
+
+    unsigned int CreateDepthArray() const;
+    void FitCascade(Cascade& cascade, float splitNear, float splitFar, float tanX, float tanY,
+        const float cameraPos[3], const float forward[3]);
+    void CollectQueries(Cascade& cascade);
+};
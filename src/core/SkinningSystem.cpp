@@ -0,0 +1,195 @@
+#include "SkinningSystem.h"
+#include "GLState.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+static const char* kSkinningGLSL = R"(
+uniform samplerBuffer uBonePalette;     // 3 texels (filas de una 3x4) por articulacion
+uniform int uJointCount;
+
+layout (location = 3) in uvec4 aJoints;
+layout (location = 4) in vec4 aWeights;
+
+vec4 gSkinRow0, gSkinRow1, gSkinRow2;
+
+// Mezcla de las 4 matrices de la paleta de esta instancia
+void LoadSkin() {
+    int base = gl_InstanceID * uJointCount;
+    gSkinRow0 = vec4(0.0);
+    gSkinRow1 = vec4(0.0);
+    gSkinRow2 = vec4(0.0);
+    for (int i = 0; i < 4; ++i) {
+        float w = aWeights[i];
+        if (w <= 0.0) continue;
+        int texel = (base + int(aJoints[i])) * 3;
+        gSkinRow0 += w * texelFetch(uBonePalette, texel);
+        gSkinRow1 += w * texelFetch(uBonePalette, texel + 1);
+        gSkinRow2 += w * texelFetch(uBonePalette, texel + 2);
+    }
+}
+
+vec3 SkinPoint(vec3 p) {
+    vec4 h = vec4(p, 1.0);
+    return vec3(dot(gSkinRow0, h), dot(gSkinRow1, h), dot(gSkinRow2, h));
+}
+
+vec3 SkinDir(vec3 d) {
+    return vec3(dot(gSkinRow0.xyz, d), dot(gSkinRow1.xyz, d), dot(gSkinRow2.xyz, d));
+}
+)";
+
+const char* SkinningSystem::GetShaderSource() {
+    return kSkinningGLSL;
+}
+
+SkinningSystem::SkinningSystem()
+    : mPaletteBuffer(0), mPaletteTexture(0), mPaletteBytes(0), mMaxPaletteTexels(65536),
+      mSpacing(1.0f), mTime(0.0f), mLastSampleMs(0.0), mLastUploadMs(0.0) {
+    mCenter[0] = mCenter[1] = mCenter[2] = 0.0f;
+}
+
+bool SkinningSystem::Init() {
+    if (mPaletteBuffer) return true;
+
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    if (maxTexels > 0) mMaxPaletteTexels = (size_t)maxTexels;
+
+    glGenBuffers(1, &mPaletteBuffer);
+    glGenTextures(1, &mPaletteTexture);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, mPaletteBuffer);
+    float identity[12] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 };
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(identity), identity, GL_STREAM_DRAW);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mPaletteBytes, sizeof(identity));
+    GLState::BindTexture(0, GL_TEXTURE_BUFFER, mPaletteTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mPaletteBuffer);
+    GLState::BindTexture(0, GL_TEXTURE_BUFFER, 0);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, 0);
+    return true;
+}
+
+void SkinningSystem::Shutdown() {
+    Clear();
+    if (mPaletteTexture) GLState::DeleteTextures(1, &mPaletteTexture);
+    if (mPaletteBuffer) GLState::DeleteBuffers(1, &mPaletteBuffer);
+    mPaletteTexture = mPaletteBuffer = 0;
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mPaletteBytes, 0);
+}
+
+void SkinningSystem::SetModel(Skeleton&& skeleton, std::vector<AnimationClip>&& clips, const float center[3], float spacing) {
+    mSkeleton = std::move(skeleton);
+    mClips = std::move(clips);
+    for (int k = 0; k < 3; ++k) mCenter[k] = center[k];
+    mSpacing = std::max(spacing, 1e-3f);
+    mTime = 0.0f;
+    SetInstanceCount(1);
+}
+
+void SkinningSystem::Clear() {
+    mSkeleton = Skeleton();
+    mClips.clear();
+    mInstances.clear();
+    mPalette.clear();
+}
+
+void SkinningSystem::SetInstanceCount(size_t count) {
+    mInstances.clear();
+    if (mClips.empty() || mSkeleton.joints.empty()) return;
+
+    // El texture buffer limita cuantas paletas caben
+    size_t maxInstances = std::max<size_t>(1, mMaxPaletteTexels / (mSkeleton.joints.size() * 3));
+    if (count > maxInstances) {
+        std::cout << "Animated instances limited to " << maxInstances << " by GL_MAX_TEXTURE_BUFFER_SIZE" << std::endl;
+        count = maxInstances;
+    }
+    count = std::max<size_t>(count, 1);
+
+    // Rejilla cuadrada; cada instancia con su giro, clip y fase
+    size_t side = (size_t)std::ceil(std::sqrt((double)count));
+    float half = (side - 1) * 0.5f;
+    mInstances.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        Instance& inst = mInstances[i];
+        float x = count > 1 ? ((float)(i % side) - half) * mSpacing : 0.0f;
+        float z = count > 1 ? ((float)(i / side) - half) * mSpacing : 0.0f;
+        float yaw = count > 1 ? (float)i * 2.39996f : 0.0f;
+        float c = std::cos(yaw), s = std::sin(yaw);
+
+        // world = traslacion * giro en Y * (-centro): los vertices vienen centrados
+        float* w = inst.world;
+        w[0] = c;    w[1] = 0.0f; w[2] = -s;   w[3] = 0.0f;
+        w[4] = 0.0f; w[5] = 1.0f; w[6] = 0.0f; w[7] = 0.0f;
+        w[8] = s;    w[9] = 0.0f; w[10] = c;   w[11] = 0.0f;
+        w[12] = x - (c * mCenter[0] + s * mCenter[2]);
+        w[13] = -mCenter[1];
+        w[14] = z - (-s * mCenter[0] + c * mCenter[2]);
+        w[15] = 1.0f;
+
+        inst.clip = i % mClips.size();
+        inst.timeOffset = count > 1 ? std::fmod((float)i * 0.618034f, 1.0f) * mClips[inst.clip].duration : 0.0f;
+        inst.speed = count > 1 ? 0.85f + 0.3f * std::fmod((float)i * 0.381966f, 1.0f) : 1.0f;
+    }
+    mPalette.assign(count * mSkeleton.joints.size() * Animation::kPaletteFloats, 0.0f);
+}
+
+float SkinningSystem::GetCrowdRadius() const {
+    if (mInstances.size() <= 1) return 0.0f;
+    size_t side = (size_t)std::ceil(std::sqrt((double)mInstances.size()));
+    return (side - 1) * 0.5f * mSpacing * std::sqrt(2.0f) + mSpacing;
+}
+
+void SkinningSystem::Update(float dt) {
+    if (mInstances.empty()) return;
+    mTime += dt;
+
+    // Un job por esqueleto; la escritura de cada uno va a su tramo de la paleta
+    auto t0 = std::chrono::steady_clock::now();
+    const size_t jointCount = mSkeleton.joints.size();
+    const size_t stride = jointCount * Animation::kPaletteFloats;
+    JobSystem::ParallelFor(mInstances.size(), 1, [&](size_t begin, size_t end) {
+        float scratch[Animation::kMaxJoints * 16];
+        for (size_t i = begin; i < end; ++i) {
+            const Instance& inst = mInstances[i];
+            Animation::SamplePalette(mSkeleton, mClips[inst.clip], mTime * inst.speed + inst.timeOffset,
+                inst.world, &mPalette[i * stride], scratch);
+        }
+    });
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Orphaning: el driver da memoria nueva si la GPU aun lee la anterior
+    size_t bytes = mPalette.size() * sizeof(float);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, mPaletteBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, bytes, mPalette.data(), GL_STREAM_DRAW);
+    GLState::BindBuffer(GL_TEXTURE_BUFFER, 0);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mPaletteBytes, bytes);
+
+    mLastSampleMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    mLastUploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+}
+
+void SkinningSystem::Bind(unsigned int program) const {
+    GLState::BindTexture(kPaletteUnit, GL_TEXTURE_BUFFER, mPaletteTexture);
+
+    int loc = glGetUniformLocation(program, "uBonePalette");
+    if (loc != -1) glUniform1i(loc, kPaletteUnit);
+    loc = glGetUniformLocation(program, "uJointCount");
+    if (loc != -1) glUniform1i(loc, (int)mSkeleton.joints.size());
+}
+
+void SkinningSystem::PrintStats() const {
+    size_t clipBytes = 0, rawBytes = 0;
+    for (const AnimationClip& clip : mClips) {
+        clipBytes += clip.GetSizeBytes();
+        rawBytes += clip.GetRawSizeBytes();
+    }
+    std::cout << "Animation: " << mInstances.size() << " instances, " << mSkeleton.joints.size() << " joints, "
+        << mClips.size() << " clips (" << (clipBytes >> 10) << " KB compressed, " << (rawBytes >> 10)
+        << " KB uncompressed), sample " << mLastSampleMs << " ms, upload " << mLastUploadMs
+        << " ms (" << (mPaletteBytes >> 10) << " KB palette)" << std::endl;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "Animation.h"
+#include <cstddef>
+#include <vector>
+
+// Instancias animadas del modelo cargado. Cada frame se muestrea la pose de
+// cada instancia en su propio job (Animation, con SSE) y las paletas de todas
+// se suben a un texture buffer; los vertex shaders skinned la leen con
+// gl_InstanceID, asi que cada mesh animado es un solo draw instanciado.
+class SkinningSystem {
+public:
+    // Unidad de textura usada por Bind()
+    static const int kPaletteUnit = 5;
+
+    // GLSL con LoadSkin(), SkinPoint() y SkinDir(); va tras la linea #version
+    // del vertex shader (atributos 3 y 4: indices y pesos)
+    static const char* GetShaderSource();
+
+    SkinningSystem();
+
+    bool Init();
+    void Shutdown();
+
+    // Se queda con el esqueleto y los clips. 'center' es el centro que se resto
+    // a los vertices; 'spacing' la separacion entre instancias.
+    void SetModel(Skeleton&& skeleton, std::vector<AnimationClip>&& clips, const float center[3], float spacing);
+    void Clear();
+    bool HasAnimation() const { return !mClips.empty(); }
+
+    // Rejilla de instancias centrada en el origen (1 = solo el modelo)
+    void SetInstanceCount(size_t count);
+    size_t GetInstanceCount() const { return mInstances.size(); }
+    // Radio de la rejilla, para ajustar el rango de las sombras
+    float GetCrowdRadius() const;
+
+    // Avanza el tiempo, muestrea todas las instancias y sube las paletas
+    void Update(float dt);
+    // Texture buffer y uniforms del programa activo
+    void Bind(unsigned int program) const;
+
+    size_t GetJointCount() const { return mSkeleton.joints.size(); }
+    size_t GetClipCount() const { return mClips.size(); }
+    void PrintStats() const;
+
+private:
+    struct Instance {
+        float world[16];
+        size_t clip;
+        float timeOffset;
+        float speed;
+    };
+
+    Skeleton mSkeleton;
+    std::vector<AnimationClip> mClips;
+    std::vector<Instance> mInstances;
+    std::vector<float> mPalette;        // Animation::kPaletteFloats por articulacion e instancia
+    unsigned int mPaletteBuffer, mPaletteTexture;
+    size_t mPaletteBytes;
+    size_t mMaxPaletteTexels;           // GL_MAX_TEXTURE_BUFFER_SIZE
+    float mCenter[3];
+    float mSpacing;
+    float mTime;
+    double mLastSampleMs, mLastUploadMs;
+};
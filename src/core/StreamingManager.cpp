@@ -0,0 +1,414 @@
+#include "StreamingManager.h"
+#include "GLState.h"
+#include "MemoryTracker.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+static const size_t kMaxPendingRequests = 32;
+
+StreamingManager::StreamingManager()
+    : mHeader{}, mFrame(0),
+      mRamBudget(1024ull << 20), mVramBudget(512ull << 20), mUploadBudget(16ull << 20),
+      mMaxScreenError(2.0f), mInFlight(0), mIoRunning(false) {
+}
+
+StreamingManager::~StreamingManager() {
+    Close();
+}
+
+void StreamingManager::SetBudgets(size_t ramBytes, size_t vramBytes, size_t uploadBytesPerFrame) {
+    mRamBudget = ramBytes;
+    mVramBudget = vramBytes;
+    mUploadBudget = uploadBytesPerFrame;
+}
+
+bool StreamingManager::Open(const std::string& path) {
+    Close();
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    if (!PageFile::ReadIndex(path, mHeader, mNodes)) {
+        mNodes.clear();
+        return false;
+    }
+
+    mPath = path;
+    mPages.clear();
+    mPages.resize(mNodes.size());
+    mStats = StreamingStats();
+
+    // La raiz se lee de forma sincrona: es la primera vista y nunca se expulsa
+    std::ifstream in(mPath, std::ios::binary);
+    uint32_t root = mHeader.rootNode;
+    if (!ReadPage(in, root, mPages[root].data) ||
+        (mNodes[root].indexCount > 0 && !UploadPage(root))) {
+        std::cerr << "Streaming: failed to load root page of " << path << "\n";
+        Close();
+        return false;
+    }
+    mStats.ramBytes += mPages[root].data.size();
+    MemoryTracker::Allocate(MemoryCategory::Staging, mPages[root].data.size());
+    mStats.bytesRead += mPages[root].data.size();
+    mStats.pagesInRam++;
+
+    mIoRunning = true;
+    mIoThread = std::thread(&StreamingManager::IoThreadMain, this);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Streaming " << path << ": " << mNodes.size() << " pages, "
+        << mHeader.totalTriangles << " triangles, first view in " << ms << " ms" << std::endl;
+    return true;
+}
+
+void StreamingManager::Close() {
+    if (mIoThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mIoMutex);
+            mIoRunning = false;
+        }
+        mIoCondition.notify_all();
+        mIoThread.join();
+    }
+
+    for (uint32_t i = 0; i < mPages.size(); ++i) {
+        ReleaseGpu(i);
+    }
+    MemoryTracker::Free(MemoryCategory::Staging, mStats.ramBytes);
+    mStats.ramBytes = 0;
+    mStats.pagesInRam = 0;
+
+    mPending.clear();
+    mCompleted.clear();
+    mInFlight = 0;
+    mPages.clear();
+    mNodes.clear();
+    mDrawList.clear();
+    mPath.clear();
+}
+
+bool StreamingManager::ReadPage(std::ifstream& in, uint32_t node, std::vector<char>& out) const {
+    const PageNode& n = mNodes[node];
+    out.resize((size_t)n.dataSize);
+    in.clear();
+    in.seekg((std::streamoff)n.dataOffset);
+    in.read(out.data(), (std::streamsize)n.dataSize);
+    if (!in) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+void StreamingManager::IoThreadMain() {
+    std::ifstream in(mPath, std::ios::binary);
+
+    while (true) {
+        PageRequest request;
+        {
+            std::unique_lock<std::mutex> lock(mIoMutex);
+            mIoCondition.wait(lock, [this]() { return !mIoRunning || !mPending.empty(); });
+            if (!mIoRunning) return;
+
+            // mPending llega ordenada por prioridad
+            request = mPending.front();
+            mPending.erase(mPending.begin());
+            mInFlight++;
+        }
+
+        PageResult result;
+        result.node = request.node;
+        ReadPage(in, request.node, result.data);
+
+        std::lock_guard<std::mutex> lock(mIoMutex);
+        mCompleted.push_back(std::move(result));
+        mInFlight--;
+    }
+}
+
+float StreamingManager::ScreenError(uint32_t node, const float cameraPos[3], float projScale, float& outDistance) const {
+    const PageNode& n = mNodes[node];
+
+    // Distancia de la camara a la caja (0 si esta dentro)
+    float d2 = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        float d = std::max({ n.boundsMin[k] - cameraPos[k], 0.0f, cameraPos[k] - n.boundsMax[k] });
+        d2 += d * d;
+    }
+    outDistance = std::max(std::sqrt(d2), 1e-4f);
+    return n.geometricError * projScale / outDistance;
+}
+
+void StreamingManager::Request(uint32_t node, float priority) {
+    PageState& page = mPages[node];
+    page.lastUsedFrame = mFrame;
+    if (IsOnGpu(node) || page.failed) return;
+
+    if (!page.data.empty()) {
+        mUploadQueue.push_back({ node, priority });
+    }
+    else if (!page.requested) {
+        mFrameRequests.push_back({ node, priority });
+    }
+}
+
+// Refina mientras el error en pantalla supere el limite. Un nodo solo se
+// sustituye por sus hijos cuando todos los hijos visibles estan en GPU; hasta
+// entonces se dibuja el padre y se piden los hijos.
+void StreamingManager::SelectNode(uint32_t node, const float cameraPos[3], float projScale) {
+    const PageNode& n = mNodes[node];
+    if (!mFrustum.IntersectsAABB(n.boundsMin, n.boundsMax)) return;
+
+    mStats.nodesVisited++;
+    mPages[node].lastUsedFrame = mFrame;
+
+    float distance = 0.0f;
+    float error = ScreenError(node, cameraPos, projScale, distance);
+
+    if (error > mMaxScreenError) {
+        bool childrenReady = true;
+        for (int c = 0; c < 8; ++c) {
+            int32_t child = n.children[c];
+            if (child < 0) continue;
+            const PageNode& cn = mNodes[child];
+            if (!mFrustum.IntersectsAABB(cn.boundsMin, cn.boundsMax)) continue;
+
+            if (!IsOnGpu((uint32_t)child)) {
+                // Prioridad: tamano proyectado (cerca y grande primero)
+                float childDistance = 0.0f;
+                ScreenError((uint32_t)child, cameraPos, projScale, childDistance);
+                float extent = 0.0f;
+                for (int k = 0; k < 3; ++k) extent = std::max(extent, cn.boundsMax[k] - cn.boundsMin[k]);
+                Request((uint32_t)child, extent * projScale / childDistance);
+                childrenReady = false;
+            }
+        }
+
+        if (childrenReady) {
+            for (int c = 0; c < 8; ++c) {
+                if (n.children[c] >= 0) SelectNode((uint32_t)n.children[c], cameraPos, projScale);
+            }
+            return;
+        }
+    }
+
+    if (mPages[node].vao) {
+        mDrawList.push_back(node);
+        mStats.pagesDrawn++;
+        mStats.trianglesDrawn += n.indexCount / 3;
+    }
+    else if (n.indexCount > 0) {
+        Request(node, std::numeric_limits<float>::max());
+    }
+}
+
+void StreamingManager::ReceivePages() {
+    std::vector<PageResult> completed;
+    {
+        std::lock_guard<std::mutex> lock(mIoMutex);
+        completed.swap(mCompleted);
+    }
+
+    for (PageResult& result : completed) {
+        PageState& page = mPages[result.node];
+        page.requested = false;
+        if (result.data.empty()) {
+            std::cerr << "Streaming: failed to read page " << result.node << "\n";
+            page.failed = true;
+            continue;
+        }
+        mStats.bytesRead += result.data.size();
+        mStats.ramBytes += result.data.size();
+        MemoryTracker::Allocate(MemoryCategory::Staging, result.data.size());
+        mStats.pagesInRam++;
+        page.data = std::move(result.data);
+    }
+}
+
+bool StreamingManager::UploadPage(uint32_t node) {
+    const PageNode& n = mNodes[node];
+    PageState& page = mPages[node];
+    if (page.data.empty() || IsOnGpu(node)) return false;
+
+    const char* vertices = page.data.data();
+    const char* indices = vertices + (size_t)n.vertexCount * 3 * sizeof(float);
+
+    glGenVertexArrays(1, &page.vao);
+    glGenBuffers(1, &page.vbo);
+    glGenBuffers(1, &page.ebo);
+
+    GLState::BindVertexArray(page.vao);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, page.vbo);
+    glBufferData(GL_ARRAY_BUFFER, (size_t)n.vertexCount * 3 * sizeof(float), vertices, GL_STATIC_DRAW);
+    GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (size_t)n.indexCount * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    GLState::BindVertexArray(0);
+    MemoryTracker::Allocate(MemoryCategory::Vertex, (size_t)n.vertexCount * 3 * sizeof(float));
+    MemoryTracker::Allocate(MemoryCategory::Index, (size_t)n.indexCount * sizeof(uint32_t));
+
+    mStats.vramBytes += (size_t)n.dataSize;
+    mStats.uploadedBytesThisFrame += (size_t)n.dataSize;
+    mStats.pagesOnGpu++;
+    return true;
+}
+
+void StreamingManager::ReleaseGpu(uint32_t node) {
+    PageState& page = mPages[node];
+    if (!page.vao) return;
+
+    GLState::DeleteVertexArrays(1, &page.vao);
+    GLState::DeleteBuffers(1, &page.vbo);
+    GLState::DeleteBuffers(1, &page.ebo);
+    page.vao = page.vbo = page.ebo = 0;
+    MemoryTracker::Free(MemoryCategory::Vertex, (size_t)mNodes[node].vertexCount * 3 * sizeof(float));
+    MemoryTracker::Free(MemoryCategory::Index, (size_t)mNodes[node].indexCount * sizeof(uint32_t));
+
+    mStats.vramBytes -= (size_t)mNodes[node].dataSize;
+    mStats.pagesOnGpu--;
+}
+
+// Expulsa de la GPU las paginas menos usadas que no se necesitan este frame
+bool StreamingManager::EvictGpu(size_t needed) {
+    while (mStats.vramBytes + needed > mVramBudget) {
+        uint32_t victim = UINT32_MAX;
+        uint64_t oldest = mFrame;
+        for (uint32_t i = 0; i < mPages.size(); ++i) {
+            if (i == mHeader.rootNode || !mPages[i].vao) continue;
+            if (mPages[i].lastUsedFrame < oldest) {
+                oldest = mPages[i].lastUsedFrame;
+                victim = i;
+            }
+        }
+        if (victim == UINT32_MAX) return false;
+        ReleaseGpu(victim);
+        mStats.vramEvictions++;
+    }
+    return true;
+}
+
+void StreamingManager::UploadPages() {
+    std::sort(mUploadQueue.begin(), mUploadQueue.end(), [](const PageRequest& a, const PageRequest& b) {
+        return a.priority > b.priority;
+    });
+
+    for (const PageRequest& request : mUploadQueue) {
+        if (mStats.uploadedBytesThisFrame >= mUploadBudget) break;
+        if (!EvictGpu((size_t)mNodes[request.node].dataSize)) break;
+        UploadPage(request.node);
+    }
+}
+
+// Expulsa de RAM las copias menos usadas hasta que quepan 'needed' bytes mas
+bool StreamingManager::EnforceRamBudget(size_t needed) {
+    while (mStats.ramBytes + needed > mRamBudget) {
+        // Se conservan la raiz y las paginas que esperan subida este frame
+        uint32_t victim = UINT32_MAX;
+        uint64_t oldest = UINT64_MAX;
+        for (uint32_t i = 0; i < mPages.size(); ++i) {
+            const PageState& page = mPages[i];
+            if (i == mHeader.rootNode || page.data.empty()) continue;
+            if (!IsOnGpu(i) && page.lastUsedFrame == mFrame) continue;
+            if (page.lastUsedFrame < oldest) {
+                oldest = page.lastUsedFrame;
+                victim = i;
+            }
+        }
+        if (victim == UINT32_MAX) return false;
+
+        mStats.ramBytes -= mPages[victim].data.size();
+        MemoryTracker::Free(MemoryCategory::Staging, mPages[victim].data.size());
+        mStats.pagesInRam--;
+        mStats.ramEvictions++;
+        std::vector<char>().swap(mPages[victim].data);
+    }
+    return true;
+}
+
+void StreamingManager::SubmitRequests() {
+    std::sort(mFrameRequests.begin(), mFrameRequests.end(), [](const PageRequest& a, const PageRequest& b) {
+        return a.priority > b.priority;
+    });
+
+    std::lock_guard<std::mutex> lock(mIoMutex);
+
+    // Lo que no se ha vuelto a pedir este frame se cancela
+    for (const PageRequest& old : mPending) {
+        mPages[old.node].requested = false;
+    }
+    mPending.clear();
+
+    // Hueco para las lecturas mas prioritarias: antes se expulsan las copias
+    // en RAM que no hacen falta este frame. Si aun asi no cabe, se piden
+    // menos paginas hasta que se libere algo.
+    size_t needed = 0, count = 0;
+    for (const PageRequest& request : mFrameRequests) {
+        if (count >= kMaxPendingRequests) break;
+        if (mPages[request.node].requested) continue;
+        needed += (size_t)mNodes[request.node].dataSize;
+        count++;
+    }
+    EnforceRamBudget(needed);
+    size_t projected = mStats.ramBytes;
+
+    for (const PageRequest& request : mFrameRequests) {
+        if (mPending.size() >= kMaxPendingRequests) break;
+        if (mPages[request.node].requested) continue;  // ya se esta leyendo
+
+        projected += (size_t)mNodes[request.node].dataSize;
+        if (projected > mRamBudget) break;
+
+        mPages[request.node].requested = true;
+        mPending.push_back(request);
+    }
+
+    mStats.pendingRequests = (uint32_t)mPending.size() + mInFlight;
+    if (!mPending.empty()) mIoCondition.notify_one();
+}
+
+void StreamingManager::Update(const float viewProj[16], const float cameraPos[3], float fovYDegrees, int viewportHeight) {
+    if (!IsOpen()) return;
+
+    mFrame++;
+    mStats.nodesVisited = 0;
+    mStats.pagesDrawn = 0;
+    mStats.trianglesDrawn = 0;
+    mStats.uploadedBytesThisFrame = 0;
+
+    ReceivePages();
+
+    mFrustum.ExtractFromMatrix(viewProj);
+    float projScale = (float)std::max(viewportHeight, 1) /
+        (2.0f * std::tan(fovYDegrees * 0.5f * 3.14159265f / 180.0f));
+
+    mDrawList.clear();
+    mFrameRequests.clear();
+    mUploadQueue.clear();
+    SelectNode(mHeader.rootNode, cameraPos, projScale);
+
+    UploadPages();
+    SubmitRequests();
+}
+
+void StreamingManager::Draw() const {
+    for (uint32_t node : mDrawList) {
+        GLState::BindVertexArray(mPages[node].vao);
+        glDrawElements(GL_TRIANGLES, (GLsizei)mNodes[node].indexCount, GL_UNSIGNED_INT, 0);
+    }
+}
+
+void StreamingManager::PrintStats() const {
+    std::cout << "Streaming: drawn " << mStats.pagesDrawn << " pages (" << mStats.trianglesDrawn
+        << " tris), visited " << mStats.nodesVisited
+        << ", RAM " << (mStats.ramBytes >> 20) << "/" << (mRamBudget >> 20) << " MB (" << mStats.pagesInRam << " pages)"
+        << ", VRAM " << (mStats.vramBytes >> 20) << "/" << (mVramBudget >> 20) << " MB (" << mStats.pagesOnGpu << " pages)"
+        << ", pending " << mStats.pendingRequests
+        << ", read " << (mStats.bytesRead >> 20) << " MB"
+        << ", evictions " << mStats.ramEvictions << "/" << mStats.vramEvictions << std::endl;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include "PageFile.h"
+#include "Frustum.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StreamingStats {
+    uint32_t nodesVisited = 0;
+    uint32_t pagesDrawn = 0;
+    uint64_t trianglesDrawn = 0;
+    uint32_t pagesInRam = 0;
+    uint32_t pagesOnGpu = 0;
+    uint32_t pendingRequests = 0;
+    size_t ramBytes = 0;
+    size_t vramBytes = 0;
+    size_t uploadedBytesThisFrame = 0;
+    uint64_t bytesRead = 0;
+    uint64_t ramEvictions = 0;
+    uint64_t vramEvictions = 0;
+};
+
+// Streaming out-of-core de un fichero .mpages. Solo el indice (tabla de nodos)
+// vive siempre en memoria; las paginas se leen en un hilo de IO y se suben a
+// la GPU en el hilo del contexto, con presupuestos de RAM y VRAM (LRU).
+class StreamingManager {
+public:
+    StreamingManager();
+    ~StreamingManager();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return !mNodes.empty(); }
+
+    void SetBudgets(size_t ramBytes, size_t vramBytes, size_t uploadBytesPerFrame);
+    void SetMaxScreenError(float pixels) { mMaxScreenError = pixels; }
+
+    // Seleccion de nodos para la camara actual. Solo en el hilo GL.
+    void Update(const float viewProj[16], const float cameraPos[3], float fovYDegrees, int viewportHeight);
+    void Draw() const;
+
+    const PageFileHeader& GetHeader() const { return mHeader; }
+    const StreamingStats& GetStats() const { return mStats; }
+    void PrintStats() const;
+
+private:
+    struct PageState {
+        std::vector<char> data;     // copia en RAM (vacia si no esta cargada)
+        unsigned int vao = 0;
+        unsigned int vbo = 0;
+        unsigned int ebo = 0;
+        bool requested = false;     // en la cola o leyendose
+        bool failed = false;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    struct PageRequest {
+        uint32_t node;
+        float priority;
+    };
+
+    struct PageResult {
+        uint32_t node;
+        std::vector<char> data;
+    };
+
+    std::string mPath;
+    PageFileHeader mHeader;
+    std::vector<PageNode> mNodes;
+    std::vector<PageState> mPages;
+    std::vector<uint32_t> mDrawList;
+    std::vector<PageRequest> mFrameRequests;   // a disco
+    std::vector<PageRequest> mUploadQueue;     // ya en RAM, pendientes de GPU
+    Frustum mFrustum;
+    uint64_t mFrame;
+
+    size_t mRamBudget;
+    size_t mVramBudget;
+    size_t mUploadBudget;
+    float mMaxScreenError;
+    StreamingStats mStats;
+
+    // Hilo de IO
+    std::thread mIoThread;
+    std::mutex mIoMutex;
+    std::condition_variable mIoCondition;
+    std::vector<PageRequest> mPending;
+    std::vector<PageResult> mCompleted;
+    uint32_t mInFlight;
+    bool mIoRunning;
+
+    void IoThreadMain();
+    bool ReadPage(std::ifstream& in, uint32_t node, std::vector<char>& out) const;
+
+    void SelectNode(uint32_t node, const float cameraPos[3], float projScale);
+    float ScreenError(uint32_t node, const float cameraPos[3], float projScale, float& outDistance) const;
+    void Request(uint32_t node, float priority);
+    void SubmitRequests();
+    void ReceivePages();
+    void UploadPages();
+    bool UploadPage(uint32_t node);
+    void ReleaseGpu(uint32_t node);
+    bool EnforceRamBudget(size_t needed);
+    bool EvictGpu(size_t needed);
+    // Las paginas sin triangulos (celdas colapsadas) cuentan como residentes
+    bool IsOnGpu(uint32_t node) const { return mPages[node].vao != 0 || mNodes[node].indexCount == 0; }
+};
@@ -1,4 +1,7 @@
 ﻿#include "Texture.h"
+#include "MemoryTracker.h"
+#include "GLState.h"
+#include "TextureCache.h"
 #include <iostream>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -9,14 +12,21 @@ Texture::Texture()
     , mWidth(0)
     , mHeight(0)
     , mChannels(0)
+    , mSizeBytes(0)
 {
 }
 
 Texture::~Texture() {
+    Release();
+}
+
+void Texture::Release() {
     if (mTextureID) {
-        glDeleteTextures(1, &mTextureID);
+        GLState::DeleteTextures(1, &mTextureID);
         mTextureID = 0;
     }
+    MemoryTracker::Free(MemoryCategory::Texture, mSizeBytes);
+    mSizeBytes = 0;
 }
 
 bool Texture::LoadFromFile(const char* path) {
@@ -26,10 +36,7 @@ bool Texture::LoadFromFile(const char* path) {
     }
 
     // Liberar textura anterior si existe
-    if (mTextureID) {
-        glDeleteTextures(1, &mTextureID);
-        mTextureID = 0;
-    }
+    Release();
 
     // Cargar imagen con stb_image
     stbi_set_flip_vertically_on_load(true);
@@ -40,6 +47,8 @@ bool Texture::LoadFromFile(const char* path) {
         std::cerr << "STB Error: " << stbi_failure_reason() << "\n";
         return false;
     }
+    // La imagen decodificada vive en RAM hasta la subida
+    ScopedMemory staging(MemoryCategory::Staging, (size_t)mWidth * mHeight * mChannels);
 
     std::cout << "Texture loaded: " << path << std::endl;
     std::cout << "  Size: " << mWidth << "x" << mHeight << std::endl;
@@ -47,7 +56,7 @@ bool Texture::LoadFromFile(const char* path) {
 
     // Crear textura OpenGL
     glGenTextures(1, &mTextureID);
-    glBindTexture(GL_TEXTURE_2D, mTextureID);
+    GLState::BindTexture(0, GL_TEXTURE_2D, mTextureID);
 
     // Configurar parámetros
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -67,8 +76,12 @@ bool Texture::LoadFromFile(const char* path) {
     // Subir datos
     glTexImage2D(GL_TEXTURE_2D, 0, format, mWidth, mHeight, 0, format, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
+    // Los drivers guardan RGB como RGBA; los mipmaps suman un tercio
+    size_t baseBytes = (size_t)mWidth * mHeight * (mChannels == 3 ? 4 : mChannels);
+    mSizeBytes = baseBytes + baseBytes / 3;
+    MemoryTracker::Allocate(MemoryCategory::Texture, mSizeBytes);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::BindTexture(0, GL_TEXTURE_2D, 0);
 
     stbi_image_free(data);
 
@@ -76,11 +89,20 @@ bool Texture::LoadFromFile(const char* path) {
     return true;
 }
 
+bool Texture::GetImageInfo(const char* path, int& width, int& height, int& channels) {
+    if (!path || !*path) return false;
+    // Version cocinada si esta al dia; si no, la cabecera de la imagen
+    if (TextureCache::IsUpToDate(path) &&
+        TextureCache::ReadInfo(TextureCache::GetCookedPath(path), width, height, channels)) {
+        return true;
+    }
+    return stbi_info(path, &width, &height, &channels) != 0;
+}
+
 void Texture::Bind(unsigned int slot) const {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, mTextureID);
+    GLState::BindTexture(slot, GL_TEXTURE_2D, mTextureID);
 }
 
 void Texture::Unbind() const {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::BindTexture(0, GL_TEXTURE_2D, 0);
 }
\ No newline at end of file
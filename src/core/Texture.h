@@ -8,15 +8,21 @@ public:
     ~Texture();
 
     bool LoadFromFile(const char* path);
+    static bool GetImageInfo(const char* path, int& width, int& height, int& channels);
     void Bind(unsigned int slot = 0) const;
     void Unbind() const;
 
     bool IsValid() const { return mTextureID != 0; }
     unsigned int GetID() const { return mTextureID; }
+    // Tamano pedido a GL, con la cadena de mipmaps
+    size_t GetSizeBytes() const { return mSizeBytes; }
 
 private:
     unsigned int mTextureID;
     int mWidth;
     int mHeight;
     int mChannels;
+    size_t mSizeBytes;
+
+    void Release();
 };
\ No newline at end of file
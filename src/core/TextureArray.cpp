@@ -0,0 +1,150 @@
+#include "TextureArray.h"
+#include "GLState.h"
+#include "MemoryTracker.h"
+#include "TextureCache.h"
+#include <iostream>
+#include <vector>
+
+#include <stb_image.h>
+
+static GLenum FormatFromChannels(int channels) {
+    if (channels == 1) return GL_RED;
+    if (channels == 2) return GL_RG;
+    if (channels == 4) return GL_RGBA;
+    return GL_RGB;
+}
+
+// RGB se guarda como RGBA en la mayoria de drivers
+static size_t LevelBytes(int width, int height, int channels, int layers) {
+    return (size_t)width * height * (channels == 3 ? 4 : channels) * layers;
+}
+
+TextureArray::TextureArray()
+    : mTextureID(0)
+    , mWidth(0)
+    , mHeight(0)
+    , mChannels(0)
+    , mLayers(0)
+    , mSizeBytes(0)
+    , mHasMipmaps(false)
+{
+}
+
+TextureArray::~TextureArray() {
+    Release();
+}
+
+void TextureArray::Release() {
+    if (mTextureID) {
+        GLState::DeleteTextures(1, &mTextureID);
+        mTextureID = 0;
+    }
+    MemoryTracker::Free(MemoryCategory::Texture, mSizeBytes);
+    mSizeBytes = 0;
+    mHasMipmaps = false;
+}
+
+bool TextureArray::Create(int width, int height, int channels, int layers) {
+    if (width <= 0 || height <= 0 || layers <= 0) {
+        std::cerr << "Invalid texture array size\n";
+        return false;
+    }
+
+    Release();
+
+    mWidth = width;
+    mHeight = height;
+    mChannels = channels;
+    mLayers = layers;
+
+    GLenum format = FormatFromChannels(channels);
+
+    glGenTextures(1, &mTextureID);
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, mTextureID);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Gris y gris + alfa se leen como RGB gris (y alfa del segundo canal)
+    if (channels == 1 || channels == 2) {
+        const GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, channels == 2 ? GL_GREEN : GL_ONE };
+        glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    // Reservar todas las capas; el contenido se sube despues capa a capa
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, width, height, layers, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    mSizeBytes = LevelBytes(width, height, channels, layers);
+    MemoryTracker::Allocate(MemoryCategory::Texture, mSizeBytes);
+
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+bool TextureArray::LoadLayerFromFile(int layer, const char* path) {
+    if (!mTextureID || layer < 0 || layer >= mLayers || !path || !*path) {
+        return false;
+    }
+
+    int w = 0, h = 0, channels = 0;
+    unsigned char* data = nullptr;
+
+    // Version cocinada: ya decodificada y volteada, si el formato coincide
+    std::vector<unsigned char> cooked;
+    if (TextureCache::IsUpToDate(path) &&
+        TextureCache::Load(TextureCache::GetCookedPath(path), w, h, channels, cooked) &&
+        channels == mChannels) {
+        data = cooked.data();
+    } else {
+        stbi_set_flip_vertically_on_load(true);
+        data = stbi_load(path, &w, &h, &channels, mChannels);
+    }
+
+    if (!data) {
+        std::cerr << "Failed to load texture: " << path << "\n";
+        std::cerr << "STB Error: " << stbi_failure_reason() << "\n";
+        return false;
+    }
+    ScopedMemory staging(MemoryCategory::Staging, (size_t)w * h * mChannels);
+
+    if (w != mWidth || h != mHeight) {
+        std::cerr << "Texture size mismatch for array layer: " << path << "\n";
+        if (data != cooked.data()) stbi_image_free(data);
+        return false;
+    }
+
+    GLenum format = FormatFromChannels(mChannels);
+
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, mTextureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, mWidth, mHeight, 1, format, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+
+    if (data != cooked.data()) stbi_image_free(data);
+    return true;
+}
+
+void TextureArray::GenerateMipmaps() {
+    if (!mTextureID) return;
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, mTextureID);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+
+    // La cadena de mipmaps suma un tercio del nivel base
+    if (!mHasMipmaps) {
+        size_t mipBytes = LevelBytes(mWidth, mHeight, mChannels, mLayers) / 3;
+        mSizeBytes += mipBytes;
+        MemoryTracker::Allocate(MemoryCategory::Texture, mipBytes);
+        mHasMipmaps = true;
+    }
+}
+
+void TextureArray::Bind(unsigned int slot) const {
+    GLState::BindTexture(slot, GL_TEXTURE_2D_ARRAY, mTextureID);
+}
+
+void TextureArray::Unbind() const {
+    GLState::BindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+
+// GL_TEXTURE_2D_ARRAY: todas las capas comparten tamano y formato, asi que
+// un grupo entero de materiales se dibuja con un unico bind.
+class TextureArray {
+public:
+    TextureArray();
+    ~TextureArray();
+
+    bool Create(int width, int height, int channels, int layers);
+    bool LoadLayerFromFile(int layer, const char* path);
+    void GenerateMipmaps();
+
+    void Bind(unsigned int slot = 0) const;
+    void Unbind() const;
+
+    bool IsValid() const { return mTextureID != 0; }
+    unsigned int GetID() const { return mTextureID; }
+    int GetWidth() const { return mWidth; }
+    int GetHeight() const { return mHeight; }
+    int GetChannels() const { return mChannels; }
+    int GetLayerCount() const { return mLayers; }
+    size_t GetSizeBytes() const { return mSizeBytes; }
+
+private:
+    unsigned int mTextureID;
+    int mWidth;
+    int mHeight;
+    int mChannels;
+    int mLayers;
+    size_t mSizeBytes;
+    bool mHasMipmaps;
+
+    void Release();
+};
@@ -0,0 +1,100 @@
+#include "TextureCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <stb_image.h>
+
+static_assert(sizeof(TextureFileHeader) == 24, "TextureFileHeader layout changed");
+
+bool TextureCache::IsUpToDate(const std::string& sourcePath) {
+    std::error_code ec;
+    std::string cooked = GetCookedPath(sourcePath);
+    if (!std::filesystem::exists(cooked, ec)) return false;
+    auto cookedTime = std::filesystem::last_write_time(cooked, ec);
+    if (ec) return false;
+    auto sourceTime = std::filesystem::last_write_time(sourcePath, ec);
+    return ec || cookedTime >= sourceTime;
+}
+
+bool TextureCache::Cook(const std::string& sourcePath, size_t& outBytes) {
+    outBytes = 0;
+
+    // Por hilo: el cocinado decodifica varias imagenes a la vez
+    stbi_set_flip_vertically_on_load_thread(1);
+    int w = 0, h = 0, channels = 0;
+    unsigned char* data = stbi_load(sourcePath.c_str(), &w, &h, &channels, 0);
+    if (!data) {
+        std::cerr << "TextureCache: cannot decode " << sourcePath << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+
+    TextureFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "MTEX", 4);
+    header.version = kVersion;
+    header.width = (uint32_t)w;
+    header.height = (uint32_t)h;
+    header.channels = (uint32_t)channels;
+    size_t pixelBytes = (size_t)w * h * channels;
+
+    std::string cookedPath = GetCookedPath(sourcePath);
+    std::string tempPath = cookedPath + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (out) {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(data), pixelBytes);
+        out.close();
+    }
+    stbi_image_free(data);
+    if (!out) {
+        std::cerr << "TextureCache: cannot write " << tempPath << "\n";
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cookedPath, ec);
+    if (ec) {
+        std::cerr << "TextureCache: cannot replace " << cookedPath << ": " << ec.message() << "\n";
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    outBytes = sizeof(header) + pixelBytes;
+    return true;
+}
+
+static bool ReadHeader(std::ifstream& in, TextureFileHeader& header) {
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    return in && std::memcmp(header.magic, "MTEX", 4) == 0 && header.version == TextureCache::kVersion &&
+        header.channels >= 1 && header.channels <= 4;
+}
+
+bool TextureCache::ReadInfo(const std::string& cookedPath, int& width, int& height, int& channels) {
+    std::ifstream in(cookedPath, std::ios::binary);
+    TextureFileHeader header;
+    if (!in || !ReadHeader(in, header)) return false;
+    width = (int)header.width;
+    height = (int)header.height;
+    channels = (int)header.channels;
+    return true;
+}
+
+bool TextureCache::Load(const std::string& cookedPath, int& width, int& height, int& channels,
+    std::vector<unsigned char>& pixels) {
+    std::ifstream in(cookedPath, std::ios::binary);
+    TextureFileHeader header;
+    if (!in || !ReadHeader(in, header)) return false;
+
+    pixels.resize((size_t)header.width * header.height * header.channels);
+    in.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+    if (!in) {
+        std::cerr << "TextureCache: truncated file " << cookedPath << "\n";
+        return false;
+    }
+    width = (int)header.width;
+    height = (int)header.height;
+    channels = (int)header.channels;
+    return true;
+}
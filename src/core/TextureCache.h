@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Formato .mtex: la imagen ya decodificada y volteada (primera fila abajo,
+// como la espera GL). Cargarla es leer el fichero, sin pasar por stb_image.
+struct TextureFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t reserved;
+};
+
+class TextureCache {
+public:
+    static const uint32_t kVersion = 1;
+
+    // Junto al fichero de origen, como el .mmodel
+    static std::string GetCookedPath(const std::string& sourcePath) { return sourcePath + ".mtex"; }
+    // Existe y no es mas antiguo que el origen
+    static bool IsUpToDate(const std::string& sourcePath);
+
+    // Decodifica 'sourcePath' y escribe su .mtex; devuelve el tamano escrito
+    static bool Cook(const std::string& sourcePath, size_t& outBytes);
+    // Solo la cabecera
+    static bool ReadInfo(const std::string& cookedPath, int& width, int& height, int& channels);
+    static bool Load(const std::string& cookedPath, int& width, int& height, int& channels,
+        std::vector<unsigned char>& pixels);
+};
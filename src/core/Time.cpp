@@ -1,18 +1,69 @@
 #include "Time.h"
+#include <cmath>
+
+// Limites contra la espiral de la muerte: un frame lento no puede
+// encadenar mas de kMaxStepsPerFrame ticks de simulacion
+static const float kMaxFrameTime = 0.25f;
+static const int kMaxStepsPerFrame = 8;
 
 Uint64 Time::sLastTicks = 0;
 float Time::sDeltaTime = 0.0f;
 float Time::sTime = 0.0f;
 
+float Time::sFixedDeltaTime = 1.0f / 120.0f;
+float Time::sAccumulator = 0.0f;
+int Time::sStepsThisFrame = 0;
+float Time::sDroppedTime = 0.0f;
+
 void Time::Init() {
-    sLastTicks = SDL_GetTicks();
+    sLastTicks = SDL_GetTicksNS();
     sDeltaTime = 0.0f;
     sTime = 0.0f;
+    sAccumulator = 0.0f;
+    sStepsThisFrame = 0;
+    sDroppedTime = 0.0f;
 }
 
 void Time::Update() {
-    Uint64 current = SDL_GetTicks();
-    sDeltaTime = (current - sLastTicks) / 1000.0f;
-    sTime += sDeltaTime;
+    Uint64 current = SDL_GetTicksNS();
+    sDeltaTime = (current - sLastTicks) / 1.0e9f;
     sLastTicks = current;
-}
\ No newline at end of file
+
+    if (sDeltaTime > kMaxFrameTime) {
+        sDroppedTime += sDeltaTime - kMaxFrameTime;
+        sDeltaTime = kMaxFrameTime;
+    }
+
+    sTime += sDeltaTime;
+    sAccumulator += sDeltaTime;
+    sStepsThisFrame = 0;
+}
+
+bool Time::StepFixed() {
+    if (sAccumulator < sFixedDeltaTime) {
+        return false;
+    }
+
+    if (sStepsThisFrame >= kMaxStepsPerFrame) {
+        // Descartar el atraso entero, conservando solo la fraccion
+        float remainder = std::fmod(sAccumulator, sFixedDeltaTime);
+        sDroppedTime += sAccumulator - remainder;
+        sAccumulator = remainder;
+        return false;
+    }
+
+    sAccumulator -= sFixedDeltaTime;
+    sStepsThisFrame++;
+    return true;
+}
+
+void Time::SetFixedDeltaTime(float dt) {
+    if (dt > 0.0f) {
+        sFixedDeltaTime = dt;
+    }
+}
+
+float Time::GetInterpolationAlpha() {
+    float alpha = sAccumulator / sFixedDeltaTime;
+    return alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+}
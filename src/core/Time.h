@@ -8,8 +8,21 @@ public:
     static float GetDeltaTime() { return sDeltaTime; }
     static float GetTime() { return sTime; }
 
+    // Simulacion a paso fijo: while (Time::StepFixed()) { ... }
+    static bool StepFixed();
+    static void SetFixedDeltaTime(float dt);
+    static float GetFixedDeltaTime() { return sFixedDeltaTime; }
+    static float GetInterpolationAlpha();
+    static int GetStepsThisFrame() { return sStepsThisFrame; }
+    static float GetDroppedTime() { return sDroppedTime; }
+
 private:
     static Uint64 sLastTicks;
     static float sDeltaTime;
     static float sTime;
-};
\ No newline at end of file
+
+    static float sFixedDeltaTime;
+    static float sAccumulator;
+    static int sStepsThisFrame;
+    static float sDroppedTime;
+};
@@ -0,0 +1,158 @@
+#include "UniformBuffers.h"
+#include "GLState.h"
+#include "MemoryTracker.h"
+#include "RingBuffer.h"
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// El array de materiales tiene kMaterialWindow elementos
+static const char* kUniformBlocksGLSL = R"(
+layout(std140) uniform FrameData {
+    mat4 uView;
+    mat4 uProj;
+    mat4 uViewProj;
+    vec4 uOverrideColor;    // a > 0: sustituye al color del material
+};
+
+struct MaterialGPU {
+    vec4 color;
+    vec4 params;            // x = capa del texture array, y = 1 con textura
+};
+
+layout(std140) uniform MaterialData {
+    MaterialGPU uMaterials[512];
+};
+
+uniform int uMaterialIndex;
+
+// Color sin textura del material activo (o el de depuracion)
+vec4 MaterialColor() {
+    return uOverrideColor.a > 0.0 ? vec4(uOverrideColor.rgb, 1.0) : uMaterials[uMaterialIndex].color;
+}
+)";
+
+// Misma disposicion que FrameData en std140
+struct FrameBlock {
+    float view[16];
+    float proj[16];
+    float viewProj[16];
+    float overrideColor[4];
+};
+
+static const float kIdentity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+const char* UniformBuffers::GetShaderSource() {
+    return kUniformBlocksGLSL;
+}
+
+void UniformBuffers::BindBlocks(unsigned int program) {
+    GLuint frame = glGetUniformBlockIndex(program, "FrameData");
+    if (frame != GL_INVALID_INDEX) glUniformBlockBinding(program, frame, kFrameBinding);
+    GLuint material = glGetUniformBlockIndex(program, "MaterialData");
+    if (material != GL_INVALID_INDEX) glUniformBlockBinding(program, material, kMaterialBinding);
+}
+
+UniformBuffers::UniformBuffers()
+    : mRing(nullptr), mCameraOffset(0), mHasCamera(false), mMaterialBuffer(0), mMaterialBytes(0),
+      mViewsThisFrame(0), mMaterialCount(0), mBoundWindow(-1), mWindowBinds(0) {
+    mOverride[0] = mOverride[1] = mOverride[2] = mOverride[3] = 0.0f;
+}
+
+bool UniformBuffers::Init(RingBuffer* frameRing) {
+    if (mMaterialBuffer) return true;
+
+    mRing = frameRing;
+    glGenBuffers(1, &mMaterialBuffer);
+    SetMaterials(std::vector<MaterialBlock>());
+
+    float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    BeginFrame(kIdentity, kIdentity, kIdentity, zero);
+    return true;
+}
+
+void UniformBuffers::Shutdown() {
+    if (mMaterialBuffer) GLState::DeleteBuffers(1, &mMaterialBuffer);
+    mMaterialBuffer = 0;
+    mRing = nullptr;
+    mHasCamera = false;
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mMaterialBytes, 0);
+    mMaterialCount = 0;
+    mBoundWindow = -1;
+}
+
+bool UniformBuffers::WriteView(const float view[16], const float proj[16], const float viewProj[16], size_t& offset) {
+    if (!mRing) return false;
+
+    FrameBlock block;
+    std::memcpy(block.view, view, sizeof(block.view));
+    std::memcpy(block.proj, proj, sizeof(block.proj));
+    std::memcpy(block.viewProj, viewProj, sizeof(block.viewProj));
+    std::memcpy(block.overrideColor, mOverride, sizeof(block.overrideColor));
+
+    // Sin sitio en el anillo se queda enlazada la vista anterior
+    if (!mRing->Write(&block, sizeof(block), offset)) return false;
+    GLState::BindBufferRange(GL_UNIFORM_BUFFER, kFrameBinding, mRing->GetBuffer(), offset, sizeof(block));
+    mViewsThisFrame++;
+    return true;
+}
+
+void UniformBuffers::BeginFrame(const float view[16], const float proj[16], const float viewProj[16], const float overrideColor[4]) {
+    std::memcpy(mOverride, overrideColor, sizeof(mOverride));
+    mViewsThisFrame = 0;
+    mHasCamera = WriteView(view, proj, viewProj, mCameraOffset);
+}
+
+void UniformBuffers::PushView(const float viewProj[16]) {
+    size_t offset;
+    WriteView(kIdentity, viewProj, viewProj, offset);
+}
+
+void UniformBuffers::BindCameraView() {
+    if (!mHasCamera) return;
+    GLState::BindBufferRange(GL_UNIFORM_BUFFER, kFrameBinding, mRing->GetBuffer(), mCameraOffset, sizeof(FrameBlock));
+}
+
+void UniformBuffers::SetMaterials(const std::vector<MaterialBlock>& materials) {
+    if (!mMaterialBuffer) return;
+
+    // Ventanas completas: el rango enlazado nunca se sale del buffer
+    size_t total = materials.size() + 1;
+    size_t windows = (total + kMaterialWindow - 1) / kMaterialWindow;
+    std::vector<MaterialBlock> data(windows * kMaterialWindow);
+    std::copy(materials.begin(), materials.end(), data.begin());
+    data[materials.size()] = MaterialBlock();
+
+    size_t bytes = data.size() * sizeof(MaterialBlock);
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, mMaterialBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, bytes, data.data(), GL_STATIC_DRAW);
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+    MemoryTracker::Resize(MemoryCategory::DynamicBuffer, mMaterialBytes, bytes);
+
+    mMaterialCount = materials.size();
+    mBoundWindow = -1;
+    SelectMaterial(-1);
+}
+
+int UniformBuffers::SelectMaterial(int materialIndex) {
+    size_t index = materialIndex >= 0 && (size_t)materialIndex < mMaterialCount
+        ? (size_t)materialIndex : mMaterialCount;
+    int window = (int)(index / kMaterialWindow);
+    if (window != mBoundWindow && mMaterialBuffer) {
+        const size_t windowBytes = kMaterialWindow * sizeof(MaterialBlock);
+        GLState::BindBufferRange(GL_UNIFORM_BUFFER, kMaterialBinding, mMaterialBuffer,
+            window * windowBytes, windowBytes);
+        mBoundWindow = window;
+        mWindowBinds++;
+    }
+    return (int)(index % kMaterialWindow);
+}
+
+void UniformBuffers::PrintStats() const {
+    std::cout << "Uniform buffers: " << mViewsThisFrame << " views this frame, "
+        << mMaterialCount << " materials (+1 default) in "
+        << (mMaterialCount / kMaterialWindow + 1) << " window(s), "
+        << mWindowBinds << " window binds in total" << std::endl;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+class RingBuffer;
+
+// Material tal como lo lee el shader (std140, 32 bytes)
+struct MaterialBlock {
+    float color[4] = { 0.8f, 0.8f, 0.8f, 1.0f };
+    float params[4] = { 0.0f, 0.0f, 0.0f, 0.0f };   // x = capa, y = 1 con textura
+};
+
+// Uniform buffers std140 compartidos por todos los programas del modelo.
+// FrameData (vista, proyeccion y view-projection) se escribe una vez por
+// vista en el RingBuffer del frame: la camara primero y despues cada cascada
+// de sombra. MaterialData es el array de materiales, subido al
+// cargar: cada draw solo elige uMaterialIndex. Si hay mas materiales que
+// kMaterialWindow se enlaza la ventana que contiene el pedido.
+class UniformBuffers {
+public:
+    // Binding points fijos de los bloques
+    static const int kFrameBinding = 0;
+    static const int kMaterialBinding = 1;
+    // Materiales visibles a la vez: 512 * 32 bytes = 16 KB, el minimo de
+    // GL_MAX_UNIFORM_BLOCK_SIZE
+    static const int kMaterialWindow = 512;
+
+    // GLSL con los bloques FrameData y MaterialData; va tras la linea #version
+    static const char* GetShaderSource();
+    // Asocia los bloques del programa a sus binding points (tras enlazarlo)
+    static void BindBlocks(unsigned int program);
+
+    UniformBuffers();
+
+    // Los bloques de vista se escriben en 'frameRing' (alineado para UBOs)
+    bool Init(RingBuffer* frameRing);
+    void Shutdown();
+
+    // Camara del frame. overrideColor sustituye al color de los
+    // materiales sin textura cuando su alpha es > 0 (wireframe, heatmap).
+    void BeginFrame(const float view[16], const float proj[16], const float viewProj[16], const float overrideColor[4]);
+    // Vista adicional (una cascada de sombra): se escribe y se enlaza.
+    // uView queda en identidad y uProj = uViewProj
+    void PushView(const float viewProj[16]);
+    // Vuelve a enlazar la camara tras las vistas adicionales
+    void BindCameraView();
+
+    // Sube todos los materiales mas uno por defecto al final
+    void SetMaterials(const std::vector<MaterialBlock>& materials);
+    // Enlaza la ventana del material (-1 o fuera de rango = el por defecto)
+    // y devuelve su indice dentro de ella, el valor de uMaterialIndex
+    int SelectMaterial(int materialIndex);
+
+    size_t GetMaterialCount() const { return mMaterialCount; }
+    void PrintStats() const;
+
+private:
+    RingBuffer* mRing;
+    size_t mCameraOffset;                   // bloque de la camara en el anillo
+    bool mHasCamera;
+    unsigned int mMaterialBuffer;
+    size_t mMaterialBytes;                  // para MemoryTracker
+    int mViewsThisFrame;
+    size_t mMaterialCount;                  // sin contar el por defecto
+    int mBoundWindow;
+    unsigned long long mWindowBinds;
+    float mOverride[4];
+
+    // Escribe el bloque en el anillo y lo enlaza; devuelve su offset
+    bool WriteView(const float view[16], const float proj[16], const float viewProj[16], size_t& offset);
+};
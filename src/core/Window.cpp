@@ -1,5 +1,6 @@
 ﻿#include "Window.h"
 #include "Renderer.h"
+#include "RenderThread.h"
 #include "Input.h"
 
 #include <SDL3/SDL.h>
@@ -104,14 +105,19 @@ void Window::PollEvents()
                 shouldClose = true;
             break;
 
-        case SDL_EVENT_WINDOW_RESIZED:
-            Renderer::SetViewportSize(e.window.data1, e.window.data2);
+        case SDL_EVENT_WINDOW_RESIZED: {
+            int w = e.window.data1;
+            int h = e.window.data2;
+            RenderThread::Enqueue([w, h] { Renderer::SetViewportSize(w, h); });
             break;
+        }
 
         case SDL_EVENT_DROP_FILE: {
             if (e.drop.data && e.drop.data[0] != '\0') {
                 std::cout << "File dropped: " << e.drop.data << "\n";
-                Renderer::OnFileDropped(e.drop.data);
+                // La carga sube buffers y texturas: en el hilo de render
+                std::string path(e.drop.data);
+                RenderThread::Enqueue([path] { Renderer::OnFileDropped(path.c_str()); });
             }
             break;
         }
@@ -122,12 +128,44 @@ void Window::PollEvents()
     }
 }
 
+void Window::PollMouseMotion()
+{
+    // Solo movimiento de ratón: el resto de eventos sigue en la cola
+    // para el PollEvents del frame siguiente
+    SDL_PumpEvents();
+
+    SDL_Event events[64];
+    int count = 0;
+    while ((count = SDL_PeepEvents(events, 64, SDL_GETEVENT,
+        SDL_EVENT_MOUSE_MOTION, SDL_EVENT_MOUSE_MOTION)) > 0) {
+        for (int i = 0; i < count; ++i) {
+            Input::ProcessEvent(events[i]);
+        }
+    }
+}
+
 void Window::SwapBuffers()
 {
     if (window)
         SDL_GL_SwapWindow(window);
 }
 
+bool Window::MakeContextCurrent()
+{
+    if (!window || !glContext) return false;
+    if (!SDL_GL_MakeCurrent(window, glContext)) {
+        std::cerr << "SDL_GL_MakeCurrent failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    return true;
+}
+
+void Window::ReleaseContext()
+{
+    if (window)
+        SDL_GL_MakeCurrent(window, nullptr);
+}
+
 Window::~Window()
 {
     if (glContext) {
@@ -14,8 +14,13 @@ public:
     // ⬆⬆⬆
 
     void PollEvents();
+    void PollMouseMotion();
     void SwapBuffers();
 
+    // El contexto de GL solo puede estar actual en un hilo (RenderThread)
+    bool MakeContextCurrent();
+    void ReleaseContext();
+
 private:
     SDL_Window* window = nullptr;
     SDL_GLContext glContext = nullptr;
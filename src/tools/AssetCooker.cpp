@@ -0,0 +1,362 @@
+#include "AssetCooker.h"
+#include "core/JobSystem.h"
+#include "core/MeshBuilder.h"
+#include "core/ModelCache.h"
+#include "core/TextureCache.h"
+#include "core/PageFile.h"
+#include "core/MemoryArena.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+static const char* kDatabaseName = ".cookdb";
+static const char* kDatabaseHeader = "# MotorcinCook database v1";
+
+// Lo que quedo de la ultima pasada
+struct CookDatabase {
+    std::map<std::string, uint64_t> hashes;                      // origen -> hash
+    std::map<std::string, std::vector<std::string>> dependencies;  // modelo -> texturas
+};
+
+static double ElapsedMs(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+static uint64_t FileSize(const std::string& path) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(path, ec);
+    return ec ? 0 : (uint64_t)size;
+}
+
+uint64_t AssetCooker::HashFile(const std::string& path, bool& ok) {
+    ok = false;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+
+    uint64_t hash = 1469598103934665603ull;
+    std::vector<char> buffer(1 << 20);
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        std::streamsize count = in.gcount();
+        for (std::streamsize i = 0; i < count; ++i) {
+            hash ^= (unsigned char)buffer[i];
+            hash *= 1099511628211ull;
+        }
+    }
+    ok = in.eof();
+    return hash;
+}
+
+bool AssetCooker::IsModelFile(const std::string& path) {
+    std::string ext = fs::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return ext == ".fbx" || ext == ".obj" || ext == ".gltf" || ext == ".glb" || ext == ".dae" || ext == ".3ds";
+}
+
+static std::string ToHex(uint64_t value) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+    return text;
+}
+
+static bool LoadDatabase(const std::string& path, CookDatabase& db) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != kDatabaseHeader) {
+        std::cerr << "Ignoring cook database with unknown format: " << path << "\n";
+        return false;
+    }
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string kind, a, b;
+        if (!std::getline(fields, kind, '\t') || !std::getline(fields, a, '\t') || !std::getline(fields, b)) continue;
+        if (kind == "asset") {
+            db.hashes[b] = std::strtoull(a.c_str(), nullptr, 16);
+        } else if (kind == "dep") {
+            db.dependencies[a].push_back(b);
+        }
+    }
+    return true;
+}
+
+static bool SaveDatabase(const std::string& path, const std::vector<CookedAsset>& assets) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out) return false;
+        out << kDatabaseHeader << "\n";
+        for (const CookedAsset& asset : assets) {
+            // Los fallidos no se guardan: la siguiente pasada los reintenta
+            if (asset.failed) continue;
+            out << "asset\t" << ToHex(asset.hash) << "\t" << asset.source << "\n";
+            for (const std::string& dep : asset.dependencies) {
+                out << "dep\t" << asset.source << "\t" << dep << "\n";
+            }
+        }
+        if (!out) return false;
+    }
+    std::error_code ec;
+    fs::rename(tempPath, path, ec);
+    return !ec;
+}
+
+// El runtime compara fechas: si el contenido no cambio pero el origen es mas
+// nuevo (checkout, copia), basta con actualizar la fecha del cocinado
+static void TouchIfOlder(const std::string& output, const std::string& source) {
+    std::error_code ec;
+    auto sourceTime = fs::last_write_time(source, ec);
+    if (ec) return;
+    if (fs::last_write_time(output, ec) < sourceTime && !ec) {
+        fs::last_write_time(output, sourceTime, ec);
+    }
+}
+
+static void CookModel(const fs::path& root, CookedAsset& asset) {
+    std::string sourcePath = (root / asset.source).string();
+    asset.dependencies.clear();
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(sourcePath.c_str(), MeshBuilder::kImportFlags);
+    if (!scene || !scene->mRootNode || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)) {
+        std::cerr << "Assimp load failed for " << asset.source << ": " << importer.GetErrorString() << "\n";
+        asset.failed = true;
+        return;
+    }
+
+    // Texturas difusas, relativas a la raiz (las embebidas "*N" no son ficheros)
+    std::vector<MaterialSource> materials;
+    MeshBuilder::ReadMaterials(scene, materials);
+    fs::path directory = fs::path(sourcePath).parent_path();
+    std::set<std::string> textures;
+    for (const MaterialSource& mat : materials) {
+        if (mat.texture.empty() || mat.texture[0] == '*') continue;
+        fs::path texture = (directory / mat.texture).lexically_normal();
+        textures.insert(texture.lexically_relative(root).generic_string());
+    }
+    asset.dependencies.assign(textures.begin(), textures.end());
+
+    size_t totalTriangles = 0;
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i) {
+        totalTriangles += scene->mMeshes[i]->mNumFaces;
+    }
+
+    bool ok = false;
+    std::string stale;
+    if (totalTriangles > ModelCache::kStreamingTriangleThreshold) {
+        asset.output = sourcePath + ".mpages";
+        stale = ModelCache::GetCookedPath(sourcePath);
+        ok = PageFile::Build(scene, asset.output);
+    } else {
+        // Arena propia: varios modelos se cocinan a la vez
+        LinearArena arena(16u << 20, 16u << 20, MemoryCategory::Import);
+        ModelBuildData model;
+        MeshBuilder::BuildModel(scene, arena, model);
+        asset.output = ModelCache::GetCookedPath(sourcePath);
+        stale = sourcePath + ".mpages";
+        ok = ModelCache::Write(asset.output, model);
+    }
+    asset.failed = !ok;
+
+    // La salida del otro formato queda vieja: CookedModelPath y el runtime
+    // miran primero .mpages
+    if (ok) {
+        std::error_code ec;
+        fs::remove(stale, ec);
+    }
+}
+
+static std::string CookedModelPath(const std::string& sourcePath) {
+    // El que exista: grande (.mpages) o normal (.mmodel)
+    std::error_code ec;
+    std::string paged = sourcePath + ".mpages";
+    if (fs::exists(paged, ec)) return paged;
+    std::string cooked = ModelCache::GetCookedPath(sourcePath);
+    if (fs::exists(cooked, ec)) return cooked;
+    return std::string();
+}
+
+int AssetCooker::Run(const CookOptions& options) {
+    auto tStart = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    fs::path root = fs::absolute(options.root, ec).lexically_normal();
+    if (ec || !fs::is_directory(root, ec)) {
+        std::cerr << "Asset directory not found: " << options.root << "\n";
+        return 1;
+    }
+
+    JobSystem::Init(options.workers);
+    unsigned int workers = JobSystem::GetWorkerCount();
+
+    std::string databasePath = (root / kDatabaseName).string();
+    CookDatabase db;
+    LoadDatabase(databasePath, db);
+
+    // Modelos del arbol, en orden estable para el informe
+    std::vector<CookedAsset> models;
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+         it != end; it.increment(ec)) {
+        if (ec) break;
+        if (!it->is_regular_file(ec) || !IsModelFile(it->path().string())) continue;
+        CookedAsset asset;
+        asset.isModel = true;
+        asset.source = it->path().lexically_relative(root).generic_string();
+        models.push_back(asset);
+    }
+    std::sort(models.begin(), models.end(), [](const CookedAsset& a, const CookedAsset& b) {
+        return a.source < b.source;
+    });
+
+    // Hashes en paralelo; un modelo se cocina si su contenido cambio o falta la salida
+    JobSystem::ParallelFor(models.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            CookedAsset& asset = models[i];
+            std::string sourcePath = (root / asset.source).string();
+            bool ok = false;
+            asset.hash = HashFile(sourcePath, ok);
+            asset.sourceBytes = FileSize(sourcePath);
+            asset.output = CookedModelPath(sourcePath);
+            auto known = db.hashes.find(asset.source);
+            if (!ok) {
+                asset.status = "unreadable";
+                asset.failed = true;
+            } else if (options.force || asset.output.empty() || known == db.hashes.end() || known->second != asset.hash) {
+                asset.status = "cooked";
+                asset.rebuilt = true;
+            } else {
+                asset.status = "up to date";
+                auto deps = db.dependencies.find(asset.source);
+                if (deps != db.dependencies.end()) asset.dependencies = deps->second;
+                TouchIfOlder(asset.output, sourcePath);
+            }
+        }
+    });
+
+    std::vector<size_t> dirtyModels;
+    for (size_t i = 0; i < models.size(); ++i) {
+        if (models[i].rebuilt) dirtyModels.push_back(i);
+    }
+
+    // Un modelo por job; dentro, BuildMeshData reparte los meshes en el mismo pool
+    JobSystem::ParallelFor(dirtyModels.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t d = begin; d < end; ++d) {
+            CookedAsset& asset = models[dirtyModels[d]];
+            auto t0 = std::chrono::steady_clock::now();
+            CookModel(root, asset);
+            asset.ms = ElapsedMs(t0, std::chrono::steady_clock::now());
+            if (asset.failed) asset.status = "FAILED";
+        }
+    });
+
+    // Texturas: las que referencia algun modelo (recien cocinado o de la base de datos)
+    std::set<std::string> textureSet;
+    for (const CookedAsset& model : models) {
+        textureSet.insert(model.dependencies.begin(), model.dependencies.end());
+    }
+    std::vector<CookedAsset> textures;
+    for (const std::string& source : textureSet) {
+        CookedAsset asset;
+        asset.source = source;
+        textures.push_back(asset);
+    }
+
+    JobSystem::ParallelFor(textures.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            CookedAsset& asset = textures[i];
+            std::string sourcePath = (root / asset.source).string();
+            bool ok = false;
+            asset.hash = HashFile(sourcePath, ok);
+            if (!ok) {
+                asset.status = "missing";
+                asset.failed = true;
+                continue;
+            }
+            asset.sourceBytes = FileSize(sourcePath);
+            asset.output = TextureCache::GetCookedPath(sourcePath);
+
+            auto known = db.hashes.find(asset.source);
+            bool changed = known == db.hashes.end() || known->second != asset.hash;
+            std::error_code existsError;
+            if (!options.force && !changed && fs::exists(asset.output, existsError)) {
+                asset.status = "up to date";
+                TouchIfOlder(asset.output, sourcePath);
+                continue;
+            }
+
+            auto t0 = std::chrono::steady_clock::now();
+            size_t bytes = 0;
+            asset.rebuilt = true;
+            asset.failed = !TextureCache::Cook(sourcePath, bytes);
+            asset.ms = ElapsedMs(t0, std::chrono::steady_clock::now());
+            asset.status = asset.failed ? "FAILED" : "cooked";
+        }
+    });
+
+    std::vector<CookedAsset> all;
+    all.reserve(models.size() + textures.size());
+    all.insert(all.end(), models.begin(), models.end());
+    all.insert(all.end(), textures.begin(), textures.end());
+
+    for (CookedAsset& asset : all) {
+        if (!asset.output.empty()) asset.outputBytes = FileSize(asset.output);
+    }
+    if (!SaveDatabase(databasePath, all)) {
+        std::cerr << "Cannot write cook database: " << databasePath << "\n";
+    }
+
+    // Informe: un asset por linea, lo mas caro primero
+    std::vector<const CookedAsset*> order;
+    for (const CookedAsset& asset : all) order.push_back(&asset);
+    std::stable_sort(order.begin(), order.end(), [](const CookedAsset* a, const CookedAsset* b) {
+        return a->ms > b->ms;
+    });
+
+    std::cout << "\n=== Cook report: " << root.string() << " ===" << std::endl;
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-10s %-7s %10s %12s %12s  %s", "status", "kind", "ms", "source KB", "output KB", "asset");
+    std::cout << line << std::endl;
+
+    int cookedCount = 0, failedCount = 0;
+    double cookMs = 0.0;
+    uint64_t sourceTotal = 0, outputTotal = 0;
+    for (const CookedAsset* asset : order) {
+        std::snprintf(line, sizeof(line), "%-10s %-7s %10.1f %12.1f %12.1f  %s", asset->status,
+            asset->isModel ? "model" : "texture", asset->ms, asset->sourceBytes / 1024.0,
+            asset->outputBytes / 1024.0, asset->source.c_str());
+        std::cout << line << std::endl;
+
+        if (asset->failed) failedCount++;
+        else if (asset->rebuilt) cookedCount++;
+        cookMs += asset->ms;
+        sourceTotal += asset->sourceBytes;
+        outputTotal += asset->outputBytes;
+    }
+
+    double wallMs = ElapsedMs(tStart, std::chrono::steady_clock::now());
+    std::snprintf(line, sizeof(line),
+        "%zu assets (%zu models, %zu textures): %d cooked, %d failed, %zu up to date",
+        all.size(), models.size(), textures.size(), cookedCount, failedCount,
+        all.size() - cookedCount - failedCount);
+    std::cout << line << std::endl;
+    std::snprintf(line, sizeof(line), "Source %.2f MB, output %.2f MB. Cook time %.1f ms, wall %.1f ms on %u workers",
+        sourceTotal / (1024.0 * 1024.0), outputTotal / (1024.0 * 1024.0), cookMs, wallMs, workers);
+    std::cout << line << std::endl;
+
+    JobSystem::Shutdown();
+    return failedCount > 0 ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CookOptions {
+    std::string root;               // directorio de assets
+    bool force = false;             // recocinar aunque el hash no cambie
+    unsigned int workers = 0;       // 0 = todos los nucleos
+};
+
+// Resultado de un asset para el informe y la base de datos
+struct CookedAsset {
+    std::string source;             // relativa a la raiz, con '/'
+    std::string output;             // fichero cocinado (vacio si no hay)
+    bool isModel = false;
+    uint64_t hash = 0;              // FNV-1a 64 del contenido
+    uint64_t sourceBytes = 0;
+    uint64_t outputBytes = 0;
+    double ms = 0.0;
+    const char* status = "pending";
+    bool rebuilt = false;           // se cocino en esta pasada
+    bool failed = false;
+    std::vector<std::string> dependencies;   // texturas del modelo, relativas a la raiz
+};
+
+// Cocinado offline: recorre 'root', convierte modelos a .mmodel (o .mpages si
+// son muy grandes) y texturas a .mtex en paralelo. Una base de datos en
+// root/.cookdb guarda hashes y dependencias modelo -> textura para rehacer
+// solo lo que ha cambiado.
+class AssetCooker {
+public:
+    // 0 si todo se cocino bien
+    static int Run(const CookOptions& options);
+
+    static uint64_t HashFile(const std::string& path, bool& ok);
+    static bool IsModelFile(const std::string& path);
+};
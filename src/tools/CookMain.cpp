@@ -0,0 +1,38 @@
+#include "AssetCooker.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+static void PrintUsage() {
+    std::cout << "Usage: MotorcinCook <asset directory> [--force] [-j <workers>]\n"
+        << "  Cooks models to .mmodel/.mpages and their textures to .mtex, next to the sources.\n"
+        << "  Only assets whose content changed since the last run are rebuilt.\n";
+}
+
+int main(int argc, char** argv) {
+    CookOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--force") == 0) {
+            options.force = true;
+        } else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            options.workers = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
+            PrintUsage();
+            return 0;
+        } else if (options.root.empty()) {
+            options.root = argv[i];
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (options.root.empty()) {
+        PrintUsage();
+        return 1;
+    }
+    return AssetCooker::Run(options);
+}